@@ -0,0 +1,55 @@
+#ifndef BACNET_SCANNER_H
+#define BACNET_SCANNER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include "bacnetUtil.hpp"
+#include "vToolCommand.hpp"
+
+class BACnetScanner : public vToolCommand<BACnetScanner> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "bacnet";
+    static constexpr const char* COMMAND_TIP = "Find BACnet/IP devices with Who-Is, optionally read vendor and model.\n\tbacnet <ip|cidr> [low-high] [details]\n\t\tlow-high limits the device instance range, details adds ReadPropertyMultiple";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    struct DeviceRecord {
+        std::string address;            // B/IP address that answered, the router for devices behind one
+        bacnetUtil::Route route;        // network and MAC beyond that router, network 0 if local
+        uint32_t max_apdu;
+        uint32_t segmentation;
+        uint32_t vendor_id;
+        std::map<uint32_t, std::string> properties;     // filled by the details pass, keyed by property id
+    };
+
+    std::map<uint32_t, DeviceRecord> Devices;  // keyed by device instance, unique across a BACnet internetwork
+
+private:
+    static constexpr int WINDOW_MS = 1500;
+
+    uint32_t m_first_host;
+    uint32_t m_last_host;
+    uint32_t m_broadcast_address;   // zero when the target is a single host or /31, /32
+    bool m_ranged;
+    uint32_t m_low_instance;
+    uint32_t m_high_instance;
+    bool m_read_details;
+
+    SOCKET openSocket();
+    void collectIAm(SOCKET udp_socket);
+    void readDetails(SOCKET udp_socket);
+    void sendTo(SOCKET udp_socket, uint32_t address, const std::string& packet);
+    bool parseInstanceRange(const std::string& text);
+    void report();
+
+    BACnetScanner();
+    friend class vToolCommand<BACnetScanner>; //needed to allow getInstance to work in parent class
+};
+
+#endif // BACNET_SCANNER_H
@@ -0,0 +1,34 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "vToolCommand.hpp"
+
+class Benchmark : public vToolCommand<Benchmark> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "bench";
+    static constexpr const char* COMMAND_TIP = "Time the per-host hot paths against their library equivalents.\n\tbench ipv4 [count]\n\t\tdotted-quad parse and format, count conversions of each (default 10000000)";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+private:
+    static constexpr size_t DEFAULT_COUNT = 10000000;
+    static constexpr size_t WORKING_SET = 65536;    // addresses cycled through, small enough to stay in cache
+
+    size_t m_count;
+    std::vector<uint32_t> m_addresses;
+    std::vector<char> m_texts;                      // one IPV4_TEXT_MAX + 1 byte slot per address, NUL terminated
+
+    void benchIPv4();
+    void report(const char* name, size_t conversions, long long elapsed_ns, size_t allocations);
+
+    Benchmark();
+    friend class vToolCommand<Benchmark>; //needed to allow getInstance to work in parent class
+};
+
+#endif // BENCHMARK_H
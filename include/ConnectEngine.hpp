@@ -0,0 +1,100 @@
+#ifndef CONNECT_ENGINE_H
+#define CONNECT_ENGINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <winsock2.h>
+#include <mswsock.h>
+#include <windows.h>
+#include "memoryUtil.hpp"
+#include "netUtil.hpp"
+
+// Non-blocking TCP connect backends for TCPScanner::sweep. Both expose the same calls, so the sweep's
+// scheduling loop is a template over them and neither pays for a virtual call per probe:
+//   start(host, port)        false when no socket could be created
+//   inFlight()               connects started and not yet reported
+//   collect(wait, timeout, out)   wait up to wait_ms, append finished and timed-out connects to out
+// Both are sized for the sweep's largest window when built, so steady-state probing never allocates.
+// For IPv6 the sweep hands over its address table (with each host's zone) with useIPv6Hosts before the
+// first start, and every host after that is an index into it, so the scheduling loop stays the same
+// 32-bit bookkeeping.
+
+struct ConnectCompletion {
+    uint32_t host;      // IPv4 address, or index into the IPv6 host table
+    int port;
+    int error;          // 0 when the handshake completed, otherwise the Winsock error
+    bool timed_out;
+};
+
+// One WSAPoll over every pending socket per collect call. Always available.
+class PollConnectEngine {
+public:
+    explicit PollConnectEngine(size_t capacity);
+    ~PollConnectEngine();
+
+    void useIPv6Hosts(const netUtil::IPv6Host* hosts) { m_ipv6_hosts = hosts; }
+    bool start(uint32_t host, int port);
+    size_t inFlight() const { return m_pending.size(); }
+    void collect(int wait_ms, std::chrono::milliseconds connect_timeout, std::vector<ConnectCompletion>& completions);
+
+private:
+    struct PendingConnect {
+        SOCKET tcp_socket;
+        uint32_t host;
+        int port;
+        std::chrono::steady_clock::time_point started_at;
+    };
+
+    const netUtil::IPv6Host* m_ipv6_hosts;     // nullptr for an IPv4 sweep
+    std::vector<PendingConnect> m_pending;
+    std::vector<WSAPOLLFD> m_poll_descriptors;
+};
+
+// Overlapped ConnectEx on an I/O completion port. Completions are reaped in batches with
+// GetQueuedCompletionStatusEx, so one kernel call retires many connects instead of scanning every
+// pending socket each round. Timed-out connects are cancelled by closing the socket; their OVERLAPPED
+// stays owned by the engine until the aborted completion is dequeued.
+class IocpConnectEngine {
+public:
+    IocpConnectEngine(memoryUtil::Arena& arena, size_t capacity);
+    ~IocpConnectEngine();
+
+    void useIPv6Hosts(const netUtil::IPv6Host* hosts) { m_ipv6_hosts = hosts; }  // before open()
+    bool open();    // false when the completion port or ConnectEx is unavailable, use PollConnectEngine instead
+    bool start(uint32_t host, int port);
+    size_t inFlight() const { return m_in_flight; }
+    void collect(int wait_ms, std::chrono::milliseconds connect_timeout, std::vector<ConnectCompletion>& completions);
+
+private:
+    struct Operation {
+        OVERLAPPED overlapped;          // first member, completions are mapped back with CONTAINING_RECORD
+        SOCKET tcp_socket;
+        uint32_t host;
+        int port;
+        uint32_t generation;            // bumped on reuse so stale timeout entries are recognised
+        bool reported;                  // already handed to the sweep (completed or timed out)
+        std::chrono::steady_clock::time_point started_at;
+    };
+
+    struct TimeoutEntry {
+        Operation* operation;
+        uint32_t generation;
+    };
+
+    memoryUtil::Arena& m_arena;                 // operations live here, stable while the kernel holds them
+    const netUtil::IPv6Host* m_ipv6_hosts;      // nullptr for an IPv4 sweep
+    HANDLE m_completion_port;
+    LPFN_CONNECTEX m_connect_ex;
+    std::vector<Operation*> m_free_operations;
+    memoryUtil::RingQueue<TimeoutEntry> m_timeouts;     // start order is deadline order, every connect shares one timeout
+    std::vector<ConnectCompletion> m_immediate; // ConnectEx failures that never reach the port
+    size_t m_in_flight;
+    size_t m_kernel_owned;                      // operations whose completion is still to be dequeued
+
+    Operation* acquire();
+    void release(Operation* operation);
+    void reap(int wait_ms, std::vector<ConnectCompletion>& completions);
+};
+
+#endif // CONNECT_ENGINE_H
@@ -0,0 +1,223 @@
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "netUtil.hpp"
+
+// Per-vendor discovery command sets and output layouts.
+// Every profile is a plain struct of constexpr tables, so the parsers below are instantiated once per
+// vendor and the per-line parsing never goes through a virtual call or a runtime vendor switch.
+namespace deviceProfile {
+
+    enum class Vendor { CiscoIOS, Juniper, ArubaHP, Moxa, Hirschmann, Linux };
+
+    enum class OutputKind { None, MacTable };   // which parser (if any) understands a command's output
+
+    struct DiscoveryCommand {
+        const char* command;
+        OutputKind kind;
+    };
+
+    struct MacTableEntry {
+        uint64_t mac;
+        std::string vlan;
+        std::string port;
+        const char* vendor = nullptr;   // from OuiDatabase, points into its mapping; nullptr when unknown
+    };
+
+    constexpr int NO_COLUMN = -1;
+
+    struct CiscoIOS {
+        static constexpr const char* NAME = "Cisco IOS";
+        // Pipelined discovery follows every command with a marker line that must be harmless and print
+        // nothing on the platform: a comment where the CLI has them, otherwise a filter that never matches.
+        // nullptr means the CLI has neither, and discovery waits for the prompt after each command instead.
+        static constexpr const char* MARKER_PREFIX = "!";   // exec mode comment, echoed but never executed
+        static constexpr const char* MARKER_SPLIT = "";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"terminal length 0", OutputKind::None},          // Return full output without paging dialogue
+            {"show interface status", OutputKind::None},      // Basic interface configurations
+            {"show cdp neighbors", OutputKind::None},         // Connected Cisco devices
+            {"show mac address-table", OutputKind::MacTable}  // Gets L2 address traffic
+        }};
+        // "  10    0011.2233.4455    DYNAMIC     Gi1/0/1"
+        static constexpr int MAC_VLAN_COLUMN = 0;
+        static constexpr int MAC_ADDRESS_COLUMN = 1;
+        static constexpr int MAC_PORT_COLUMN = 3;
+    };
+
+    struct Juniper {
+        static constexpr const char* NAME = "Juniper JunOS";
+        static constexpr const char* MARKER_PREFIX = "show system uptime | match ";    // operational mode has no comments
+        static constexpr const char* MARKER_SPLIT = "";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"set cli screen-length 0", OutputKind::None},
+            {"show interfaces terse", OutputKind::None},
+            {"show lldp neighbors", OutputKind::None},
+            {"show ethernet-switching table", OutputKind::MacTable}
+        }};
+        // "   vlan100   00:11:22:33:44:55   D   -   ge-0/0/1.0"
+        static constexpr int MAC_VLAN_COLUMN = 0;
+        static constexpr int MAC_ADDRESS_COLUMN = 1;
+        static constexpr int MAC_PORT_COLUMN = 4;
+    };
+
+    struct ArubaHP {
+        static constexpr const char* NAME = "HP/Aruba ProCurve";
+        static constexpr const char* MARKER_PREFIX = "show version | include ";
+        static constexpr const char* MARKER_SPLIT = "";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"no page", OutputKind::None},
+            {"show interfaces brief", OutputKind::None},
+            {"show lldp info remote-device", OutputKind::None},
+            {"show mac-address", OutputKind::MacTable}
+        }};
+        // "  001122-334455   1    10"
+        static constexpr int MAC_VLAN_COLUMN = 2;
+        static constexpr int MAC_ADDRESS_COLUMN = 0;
+        static constexpr int MAC_PORT_COLUMN = 1;
+    };
+
+    struct Moxa {
+        static constexpr const char* NAME = "Moxa EDS";
+        static constexpr const char* MARKER_PREFIX = nullptr;   // no comment syntax or output filter to lean on
+        static constexpr const char* MARKER_SPLIT = "";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"terminal length 0", OutputKind::None},
+            {"show interfaces ethernet", OutputKind::None},
+            {"show lldp entry", OutputKind::None},
+            {"show mac-address-table", OutputKind::MacTable}
+        }};
+        // "  00:11:22:33:44:55   Learned   3    1"
+        static constexpr int MAC_VLAN_COLUMN = 3;
+        static constexpr int MAC_ADDRESS_COLUMN = 0;
+        static constexpr int MAC_PORT_COLUMN = 2;
+    };
+
+    struct Hirschmann {
+        static constexpr const char* NAME = "Hirschmann HiOS";
+        static constexpr const char* MARKER_PREFIX = nullptr;
+        static constexpr const char* MARKER_SPLIT = "";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"cli numlines 0", OutputKind::None},
+            {"show port all", OutputKind::None},
+            {"show lldp remote-data", OutputKind::None},
+            {"show mac-addr-table", OutputKind::MacTable}
+        }};
+        // "1        00:11:22:33:44:55  1/1        1        learned"
+        static constexpr int MAC_VLAN_COLUMN = 0;
+        static constexpr int MAC_ADDRESS_COLUMN = 1;
+        static constexpr int MAC_PORT_COLUMN = 2;
+    };
+
+    struct Linux {
+        static constexpr const char* NAME = "Linux";
+        // The tty echoes type-ahead immediately, so the marker has to come from command output.
+        // Quotes split the token in the echoed command line: "echo NETBARD-MARK-''3." prints "NETBARD-MARK-3."
+        static constexpr const char* MARKER_PREFIX = "echo ";
+        static constexpr const char* MARKER_SPLIT = "''";
+        static constexpr std::array<DiscoveryCommand, 4> DISCOVERY_COMMANDS = {{
+            {"uname -a", OutputKind::None},
+            {"ip -brief address", OutputKind::None},
+            {"ip neigh show", OutputKind::None},
+            {"bridge fdb show", OutputKind::MacTable}
+        }};
+        // "00:11:22:33:44:55 dev eth0 vlan 1 master br0"
+        static constexpr int MAC_VLAN_COLUMN = NO_COLUMN;
+        static constexpr int MAC_ADDRESS_COLUMN = 0;
+        static constexpr int MAC_PORT_COLUMN = 2;
+    };
+
+    // Detection signatures, checked in order. Prompt text (which includes any login banner/MOTD) is
+    // more specific than the SSH ident string, since many vendors ship a stock OpenSSH or dropbear.
+    struct DetectionRule {
+        Vendor vendor;
+        bool match_ssh_banner;  // false = match against the first prompt text
+        const char* signature;
+    };
+
+    constexpr std::array<DetectionRule, 12> DETECTION_RULES = {{
+        {Vendor::Hirschmann, false, "Hirschmann"},
+        {Vendor::Hirschmann, false, "HiOS"},
+        {Vendor::Juniper, false, "JUNOS"},
+        {Vendor::Moxa, false, "Moxa"},
+        {Vendor::Moxa, false, "EDS-"},
+        {Vendor::ArubaHP, false, "ProCurve"},
+        {Vendor::ArubaHP, false, "Aruba"},
+        {Vendor::CiscoIOS, true, "Cisco"},
+        {Vendor::Linux, true, "Ubuntu"},
+        {Vendor::Linux, true, "Debian"},
+        {Vendor::Linux, true, "Raspbian"},
+        {Vendor::ArubaHP, true, "Mocana"}
+    }};
+
+    // Pick a vendor from the SSH ident string and the first prompt, falling back to prompt shape
+    inline Vendor detectVendor(const std::string& ssh_banner, const std::string& first_prompt) {
+        for (const DetectionRule& rule : DETECTION_RULES) {
+            const std::string& haystack = rule.match_ssh_banner ? ssh_banner : first_prompt;
+            if (haystack.find(rule.signature) != std::string::npos) {
+                return rule.vendor;
+            }
+        }
+
+        size_t prompt_end = first_prompt.find_last_not_of(" \r\n");
+        if (prompt_end == std::string::npos) return Vendor::CiscoIOS;
+        size_t prompt_start = first_prompt.find_last_of('\n', prompt_end);
+        prompt_start = (prompt_start == std::string::npos) ? 0 : prompt_start + 1;
+        const std::string prompt_line = first_prompt.substr(prompt_start, prompt_end - prompt_start + 1);
+
+        if (prompt_line.find('@') != std::string::npos) {   // user@host> is JunOS, user@host:~$ is a shell
+            return (prompt_line.back() == '>') ? Vendor::Juniper : Vendor::Linux;
+        }
+        return Vendor::CiscoIOS;    // IOS-style CLIs are by far the most common in the field
+    }
+
+    // Pull MAC table rows out of raw command output using the profile's column layout
+    template<typename Profile>
+    void parseMacTable(const std::string& output, std::vector<MacTableEntry>& entries) {
+        constexpr int LAST_COLUMN = std::max({Profile::MAC_VLAN_COLUMN, Profile::MAC_ADDRESS_COLUMN, Profile::MAC_PORT_COLUMN});
+
+        std::istringstream lines(output);
+        std::string line;
+        std::vector<std::string> columns;  // reused for every line
+        while (std::getline(lines, line)) {
+            columns.clear();
+            std::istringstream words(line);
+            std::string word;
+            while (words >> word) {
+                columns.push_back(word);
+            }
+            if (static_cast<int>(columns.size()) <= LAST_COLUMN) continue;  // headers, separators, prompts
+
+            uint64_t mac;
+            if (!netUtil::parseMAC(columns[Profile::MAC_ADDRESS_COLUMN], mac)) continue;
+
+            MacTableEntry entry;
+            entry.mac = mac;
+            entry.port = columns[Profile::MAC_PORT_COLUMN];
+            if constexpr (Profile::MAC_VLAN_COLUMN != NO_COLUMN) {
+                entry.vlan = columns[Profile::MAC_VLAN_COLUMN];
+            }
+            entries.push_back(entry);
+        }
+    }
+
+    template<typename Profile>
+    void parseOutput(OutputKind kind, const std::string& output, std::vector<MacTableEntry>& mac_table) {
+        switch (kind) {
+            case OutputKind::MacTable:
+                parseMacTable<Profile>(output, mac_table);
+                break;
+            case OutputKind::None:
+                break;
+        }
+    }
+
+}
+
+#endif // DEVICE_PROFILE_H
@@ -0,0 +1,39 @@
+#ifndef ENIP_SCANNER_H
+#define ENIP_SCANNER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "enipUtil.hpp"
+#include "vToolCommand.hpp"
+
+class ENIPScanner : public vToolCommand<ENIPScanner> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "enip";
+    static constexpr const char* COMMAND_TIP = "Find EtherNet/IP devices with a ListIdentity burst.\n\tenip <ip> [window ms]\n\tenip <cidr> [window ms]";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    std::map<std::string, enipUtil::IdentityRecord> Devices;   // keyed by the address the reply came from
+
+private:
+    static constexpr int DEFAULT_WINDOW_MS = 750;
+
+    uint32_t m_first_host;
+    uint32_t m_last_host;
+    uint32_t m_broadcast_address;   // zero when the target is a single host or /31, /32
+    int m_window_ms;
+
+    void discover();
+    bool storeReply(const std::string& packet, uint32_t sender, uint64_t sender_context);
+    void report();
+
+    ENIPScanner();
+    friend class vToolCommand<ENIPScanner>; //needed to allow getInstance to work in parent class
+};
+
+#endif // ENIP_SCANNER_H
@@ -0,0 +1,51 @@
+#ifndef ICMP_ENGINE_H
+#define ICMP_ENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include <winsock2.h>
+#include <windows.h>
+#include <winternl.h>   // PIO_APC_ROUTINE, so icmpapi.h declares the typed IcmpSendEcho2
+#include <iphlpapi.h>
+#include <icmpapi.h>
+#include "memoryUtil.hpp"
+
+// Batched ICMP echo for PingScanner::scan. start() hands one request to IcmpSendEcho2, which returns at
+// once and queues an APC when the reply or the timeout arrives; collect() runs every queued APC in one
+// alertable wait. A single thread keeps the whole window in flight, and each reply lands in a slot carved
+// from the scan's arena when the engine is built, so no echo allocates.
+
+struct EchoCompletion {
+    uint32_t host;
+    ULONG status;       // IP_SUCCESS, or the IP_STATUS that ended the attempt
+};
+
+class IcmpEchoEngine {
+public:
+    IcmpEchoEngine(memoryUtil::Arena& arena, size_t capacity);
+    ~IcmpEchoEngine();
+
+    bool open();    // false when no ICMP handle could be created
+    bool start(uint32_t host, DWORD timeout_ms);    // false when all capacity slots are in flight
+    size_t inFlight() const { return m_in_flight; }
+    void collect(DWORD wait_ms, std::vector<EchoCompletion>& completions);
+
+private:
+    struct Slot {
+        IcmpEchoEngine* engine;     // APCs are static, the slot leads back to its engine
+        uint32_t host;
+        char* reply;                // m_slot_size bytes from the arena
+    };
+
+    HANDLE m_icmp_handle;
+    size_t m_slot_size;
+    Slot** m_free_slots;            // stack of capacity entries
+    size_t m_free_count;
+    std::vector<EchoCompletion> m_completed;    // appended by the APCs, reserved to capacity
+    size_t m_in_flight;
+
+    void finish(Slot* slot, ULONG status);
+    static void NTAPI onReply(PVOID context, PIO_STATUS_BLOCK status_block, ULONG reserved);
+};
+
+#endif // ICMP_ENGINE_H
@@ -20,6 +20,7 @@ public:
 protected:
     // Override streambuf methods to write to both destinations
     virtual int overflow(int c) override;
+    virtual std::streamsize xsputn(const char* s, std::streamsize count) override;
     virtual int sync() override;
 
 private:
@@ -0,0 +1,67 @@
+#ifndef MODBUS_SCANNER_H
+#define MODBUS_SCANNER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include "modbusUtil.hpp"
+#include "vToolCommand.hpp"
+
+class ModbusScanner : public vToolCommand<ModbusScanner> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "modbus";
+    static constexpr const char* COMMAND_TIP = "Read Modbus device identification (FC 43/14) over port 502.\n\tmodbus <ip|cidr> [unit ids] [concurrency] [timeout ms]\n\t\tunit ids e.g. 1,255 or 1-16";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    struct UnitIdentity {
+        uint8_t unit_id;
+        uint8_t conformity_level;
+        std::map<uint8_t, std::string> objects;     // object id -> value, 0..2 are vendor, product code, revision
+    };
+
+    std::map<std::string, std::vector<UnitIdentity>> Devices;  // hosts where at least one unit identified itself
+
+private:
+    static constexpr size_t DEFAULT_CONCURRENCY = 128;
+    static constexpr int DEFAULT_TIMEOUT_MS = 1500;
+
+    struct HostProbe {      // one connection per host, every unit id pipelined over it
+        SOCKET tcp_socket;
+        uint32_t host;
+        bool connected;
+        std::chrono::steady_clock::time_point last_activity;
+        uint16_t next_transaction_id;
+        std::string send_buffer;
+        size_t send_offset;
+        std::string receive_buffer;
+        std::map<uint16_t, uint8_t> pending_units;      // transaction id -> unit id
+        std::map<uint8_t, UnitIdentity> units;
+    };
+
+    uint32_t m_first_host;
+    uint32_t m_last_host;
+    std::vector<uint8_t> m_unit_ids;
+    size_t m_concurrency;
+    int m_timeout_ms;
+
+    bool parseUnitIds(const std::string& text);
+    void probe(const std::vector<uint32_t>& hosts);
+    void queueRequest(HostProbe& probe, uint8_t unit_id, uint8_t object_id);
+    bool sendPending(HostProbe& probe);
+    bool receiveReplies(HostProbe& probe);
+    void handleFrame(HostProbe& probe, const modbusUtil::Frame& frame);
+    void finishProbe(HostProbe& probe);
+    void report();
+
+    ModbusScanner();
+    friend class vToolCommand<ModbusScanner>; //needed to allow getInstance to work in parent class
+};
+
+#endif // MODBUS_SCANNER_H
@@ -0,0 +1,65 @@
+#ifndef NAME_RESOLVER_H
+#define NAME_RESOLVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <winsock2.h>
+#include "vToolCommand.hpp"
+
+class NameResolver : public vToolCommand<NameResolver> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "names";
+    static constexpr const char* COMMAND_TIP = "Name hosts by reverse DNS, optionally falling back to NetBIOS and mDNS.\n\tnames <ip|cidr|last> [dns server[:port]] [nbns] [mdns]\n\t\tlast names the hosts the previous ping sweep found; answers are cached for their TTL";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    std::map<std::string, std::string> Host_Names;     // address -> name, from the last run
+
+private:
+    // Tried in this order for each host until one names it
+    enum class Method : uint8_t { Dns, NetBios, Mdns };
+    static constexpr size_t METHOD_COUNT = 3;
+
+    struct CacheEntry {
+        std::string name;           // empty for a negative entry
+        Method source;
+        uint8_t methods_tried;      // negative entries only answer for runs that ask no more than this
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Query {                  // one slot of the in-flight window
+        uint32_t host;
+        Method method;
+        uint8_t attempt;
+        uint16_t id;                // low bits are the slot, the rest change on every reuse
+        bool active;
+    };
+
+    static constexpr int DEFAULT_TIMEOUT_MS = 1000;
+    static constexpr int MAX_ATTEMPTS = 2;
+
+    std::vector<uint32_t> m_targets;
+    uint32_t m_dns_server;
+    uint16_t m_dns_port;
+    uint8_t m_methods;              // bit per Method
+    std::unordered_map<uint32_t, CacheEntry> m_cache;  // kept across runs that ask the same DNS server
+    uint32_t m_cache_server;        // the DNS server and port m_cache was filled from
+    uint16_t m_cache_port;
+
+    bool defaultDnsServer(uint32_t& server);
+    bool lookupCache(uint32_t host, std::chrono::steady_clock::time_point now);
+    void resolve();
+    void report(size_t cached_count, size_t query_count, size_t window_peak, long long elapsed_ms);
+
+    NameResolver();
+    friend class vToolCommand<NameResolver>; //needed to allow getInstance to work in parent class
+};
+
+#endif // NAME_RESOLVER_H
@@ -1,24 +1,175 @@
 #ifndef OPC_EXPLORER_H
 #define OPC_EXPLORER_H
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
 #include "vToolCommand.hpp"
+#include "open62541.h"
 
 class OPCExplorer : public vToolCommand<OPCExplorer>{
 
     public:
         // Static command metadata for CRTP base class
         static constexpr const char* COMMAND_PHRASE = "opc";
-        static constexpr const char* COMMAND_TIP = "Scan OPC node at designated path.\n\t\t\topc <address> <slot> <tagpath>";
+        static constexpr const char* COMMAND_TIP = "Scan OPC node at designated path, or watch its variables for change.\n\t\t\topc <address> <slot> <tagpath>\n\t\t\topc watch <address> <slot> <tagpath> [sampling ms] [publishing ms] [queue size]";
+
+        ~OPCExplorer();
 
         bool validateInput(const std::vector<std::string>& arguments) override;
         void handleCommand(const std::vector<std::string>& arguments) override;
 
+        struct BrowsedNode {
+            UA_NodeId node_id;          // owned, released by clearNodes()
+            std::string browse_name;
+            UA_NodeClass node_class;
+            size_t parent;
+            int depth;
+            std::string value;          // printed Value attribute, variables only
+            uint64_t reference_hash;    // sum of referenceHash over the hierarchical references, rechecked on cache refresh
+        };
+
+        std::vector<BrowsedNode> Nodes;    // address space below the requested tag path, in browse order
+
     private:
+        static constexpr size_t NO_PARENT = SIZE_MAX;
+        static constexpr uint16_t DEFAULT_PORT = 4840;
+        static constexpr uint32_t DEFAULT_MAX_NODES_PER_REQUEST = 1000;   // used when the server reports no limit
+        static constexpr double DEFAULT_SAMPLING_MS = 250.0;
+        static constexpr double DEFAULT_PUBLISHING_MS = 1000.0;
+        static constexpr uint32_t DEFAULT_QUEUE_SIZE = 10;
+        static constexpr size_t SAMPLE_RING_CAPACITY = 64;     // changes kept per tag between flushes, oldest dropped first
+        static constexpr size_t SAMPLE_TEXT_CAPACITY = 32;     // string values are truncated to fit the sample
+        static constexpr const char* CACHE_DIRECTORY = "cache/opc";
+        static constexpr const char* CACHE_MAGIC = "NBOPC2";
+
+        using ReferenceHandler = std::function<void(size_t node, const UA_ReferenceDescription* references, size_t reference_count)>;
+
+        struct TagSample {          // fixed size so a notification never allocates
+            UA_DateTime timestamp;
+            UA_StatusCode status;
+            bool is_text;
+            double number;
+            char text[SAMPLE_TEXT_CAPACITY];
+        };
+
+        struct WatchedTag {         // monitored item context, must not move once the items are created
+            size_t node;            // index into Nodes
+            std::array<TagSample, SAMPLE_RING_CAPACITY> samples;
+            size_t head;
+            size_t count;
+            uint64_t dropped;
+        };
+
         std::string _ip;
         int _slot;
         std::string _path;
+        std::string m_endpoint_url;
+        std::string m_application_uri;  // keys the address-space cache, empty if the server did not say
+        uint32_t m_max_nodes_per_browse;
+        uint32_t m_max_nodes_per_read;
+        uint32_t m_max_monitored_items_per_call;
+        int m_round_trips;
+        bool m_watch;
+        double m_sampling_ms;
+        double m_publishing_ms;
+        uint32_t m_queue_size;
+        std::vector<WatchedTag> m_watched_tags;
+        std::string m_flush_buffer;     // reused for every flush so the log gets one write per batch
+
+        UA_Client* connectClient(const std::string& endpoint_url);
+        UA_NodeId startNode();
+        void readServerInfo(UA_Client* client);
+        void browseTree(UA_Client* client, const UA_NodeId& start_node);
+        void refreshTree(UA_Client* client);
+        void browseLevels(UA_Client* client, std::vector<size_t> level, std::unordered_set<std::string>& visited);
+        void browseBatch(UA_Client* client, const std::vector<size_t>& nodes, size_t offset, size_t count,
+                         UA_UInt32 result_mask, const ReferenceHandler& on_references);
+        void addReferences(const UA_ReferenceDescription* references, size_t reference_count, size_t parent,
+                           std::unordered_set<std::string>& visited, std::vector<size_t>& next_level);
+        static uint64_t referenceHash(const UA_ReferenceDescription& reference);
+        void readValues(UA_Client* client, const std::vector<size_t>& node_indices);
+        std::string cachePath();
+        bool loadCache(const std::string& path);
+        bool saveCache(const std::string& path);
+        static void appendCacheU32(std::string& out, uint32_t value);
+        static void appendCacheBytes(std::string& out, const void* bytes, size_t length);
+        static bool readCacheU32(const std::string& data, size_t& position, uint32_t& value);
+        static bool readCacheBytes(const std::string& data, size_t& position, std::string& bytes);
+        void printTree();
+        void watchTags(UA_Client* client);
+        size_t createMonitoredItems(UA_Client* client, UA_UInt32 subscription_id);
+        void flushSamples();
+        static void onDataChange(UA_Client* client, UA_UInt32 subscription_id, void* subscription_context,
+                                 UA_UInt32 monitor_id, void* monitor_context, UA_DataValue* value);
+        static void storeSample(WatchedTag& tag, const UA_DataValue* value);
+        void clearNodes();
+        std::string nodeIdToString(const UA_NodeId& node_id);
+        const char* nodeClassName(UA_NodeClass node_class);
+
+        OPCExplorer();
         friend class vToolCommand<OPCExplorer>;
 };
 
+class OPCDiscoverer : public vToolCommand<OPCDiscoverer>{
+
+    public:
+        // Static command metadata for CRTP base class
+        static constexpr const char* COMMAND_PHRASE = "opc-discover";
+        static constexpr const char* COMMAND_TIP = "Find OPC UA servers and list their endpoints.\n\t\t\topc-discover <cidr>";
+
+        bool validateInput(const std::vector<std::string>& arguments) override;
+        void handleCommand(const std::vector<std::string>& arguments) override;
+
+        struct EndpointRecord {
+            std::string url;
+            std::string security_policy;
+            std::string security_mode;
+        };
+
+        struct ServerRecord {
+            std::string application_name;
+            std::string application_uri;
+            std::vector<EndpointRecord> endpoints;      // GetEndpoints
+            std::vector<std::string> discovery_urls;    // FindServers, lists servers registered behind an LDS too
+            std::string error;
+        };
+
+        std::map<std::string, ServerRecord> Servers;   // keyed by host address, hosts that answered only
+
+    private:
+        static constexpr uint16_t OPC_UA_PORT = 4840;
+
+        struct DiscoveryTarget {    // per-client context handed to the open62541 callbacks
+            std::string address;
+            std::string endpoint_url;
+            UA_Client* client;
+            bool requests_sent;
+            int pending_responses;
+            bool finished;
+            ServerRecord record;
+        };
+
+        uint32_t m_first_host;
+        uint32_t m_last_host;
+
+        void discover(const std::vector<uint32_t>& hosts);
+        void report();
+        static void onStateChange(UA_Client* client, UA_SecureChannelState channel_state,
+                                  UA_SessionState session_state, UA_StatusCode connect_status);
+        static void onEndpoints(UA_Client* client, void* userdata, UA_UInt32 request_id, void* response);
+        static void onServers(UA_Client* client, void* userdata, UA_UInt32 request_id, void* response);
+        static void finishResponse(DiscoveryTarget* target);
+        static std::string toString(const UA_String& text);
+
+        OPCDiscoverer();
+        friend class vToolCommand<OPCDiscoverer>;
+};
+
 
 #endif
\ No newline at end of file
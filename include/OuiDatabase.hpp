@@ -0,0 +1,58 @@
+#ifndef OUI_DATABASE_H
+#define OUI_DATABASE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include <windows.h>
+
+// MAC address to vendor, from the IEEE MA-L, MA-M and MA-S registries.
+// The registries' CSV exports are compiled once ("oui build") into a compact index file: a sorted array of
+// prefix keys, a parallel array of name offsets and one block of deduplicated names. The index is mapped
+// read-only on the first lookup, and a lookup is a binary search over the few 8 byte keys that share the
+// MAC's leading 12 bits (two more for MA-L blocks the IEEE split into MA-M/MA-S assignments). Returned names point into the mapping, so
+// annotating a table costs a pointer per entry and copies nothing.
+class OuiDatabase {
+public:
+    static constexpr const char* DEFAULT_PATH = "oui.idx";
+
+    static OuiDatabase& shared();      // DEFAULT_PATH, mapped on first use
+
+    ~OuiDatabase();
+    OuiDatabase(const OuiDatabase&) = delete;
+    OuiDatabase& operator=(const OuiDatabase&) = delete;
+
+    // Organization name, or nullptr when the prefix is unassigned or there is no index to look in
+    const char* vendor(uint64_t mac);
+    size_t size();
+
+    // Maps the index file again, after a rebuild. Names handed out earlier stay valid: older mappings are
+    // only released with the database itself.
+    bool reload();
+
+    // Compiles IEEE registry CSV exports (oui.csv, mam.csv, oui36.csv, iab.csv) into an index file
+    static bool build(const std::vector<std::string>& csv_paths, const std::string& output_path, size_t& entry_count, std::string& error);
+
+private:
+    struct Mapping {
+        HANDLE file;
+        HANDLE section;
+        const void* view;
+    };
+
+    std::string m_path;
+    bool m_loaded;                  // a load was attempted, successful or not
+    std::vector<Mapping> m_mappings;
+    const uint64_t* m_keys;         // prefix << 8 | prefix bits, ascending
+    const uint32_t* m_name_offsets; // parallel to m_keys, top bit set on MA-L blocks that were split up
+    const char* m_names;
+    size_t m_entry_count;
+    std::vector<uint32_t> m_bucket_starts;  // built on load, 4097 entries
+
+    explicit OuiDatabase(const std::string& path);
+    const uint32_t* find(uint64_t mac, int prefix_bits) const;
+    const char* name(uint32_t name_offset) const;
+};
+
+#endif // OUI_DATABASE_H
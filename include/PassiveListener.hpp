@@ -0,0 +1,39 @@
+#ifndef PASSIVE_LISTENER_H
+#define PASSIVE_LISTENER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "vToolCommand.hpp"
+#include "passiveUtil.hpp"
+
+// Listen-only discovery: nothing is sent. Hosts, MACs and neighbor links come from the announcements
+// already crossing the wire, replayed from a capture file or read from a live raw socket.
+class PassiveListener : public vToolCommand<PassiveListener> {
+
+public:
+    static constexpr const char* COMMAND_PHRASE = "listen";
+    static constexpr const char* COMMAND_TIP = "Discover hosts passively from ARP, LLDP, CDP, DHCP, mDNS and EtherNet/IP traffic.\n\tlisten <capture.pcap|capture.pcapng>\n\tlisten live <local ip> [seconds]\n\t\tlive capture needs administrator rights and only sees IP traffic (DHCP, mDNS, EtherNet/IP)";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    passiveUtil::Inventory Discovered;     // hosts and neighbor links from the last listen
+
+private:
+    static constexpr int DEFAULT_LIVE_SECONDS = 30;
+
+    bool m_live;
+    std::string m_capture_path;
+    uint32_t m_local_address;
+    int m_live_seconds;
+
+    bool replayFile(const std::string& path, uint64_t& frame_count, uint64_t& byte_count);
+    bool captureLive(uint32_t local_address, int seconds, uint64_t& frame_count, uint64_t& byte_count);
+    void report() const;
+
+    PassiveListener();
+    friend class vToolCommand<PassiveListener>; //needed to allow getInstance to work in parent class
+};
+
+#endif // PASSIVE_LISTENER_H
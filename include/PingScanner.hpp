@@ -5,10 +5,12 @@
 #include <string>
 #include <vector>
 #include <cstdint>
-#include <map>
 #include <winsock2.h>
 #include <windows.h>
 #include "vToolCommand.hpp"
+#include "memoryUtil.hpp"
+#include "neighborUtil.hpp"
+#include "netUtil.hpp"
 
 class PingScanner : public vToolCommand<PingScanner>{
 
@@ -16,7 +18,7 @@ public:
 
     // Static command metadata for CRTP base class
     static constexpr const char* COMMAND_PHRASE = "ping";
-    static constexpr const char* COMMAND_TIP = "Ping sweep subnet for active hosts.\n\tping <cidr>\n\tping <ip address>";
+    static constexpr const char* COMMAND_TIP = "Ping sweep subnet for active hosts.\n\tping <cidr>\n\tping <ip address>\n\tping <ipv6 prefix|ipv6 address>\n\t\tsubnets on a local interface are swept with ARP instead, and report MAC addresses\n\t\tIPv6 prefixes on a local link are discovered by multicast echo and neighbor solicitation";
 
     bool validateInput(const std::vector<std::string>& arguments) override;
     void handleCommand(const std::vector<std::string>& arguments) override;
@@ -24,15 +26,35 @@ public:
     std::string Network_Address;
     std::string Broadcast_Address;
      std::string Network_Mask;
-    std::vector<std::string> Host_Addresses;
-    std::map<std::string, bool> Host_Statuses;
+
+    struct HostStatus {
+        uint32_t address;
+        bool alive;
+        uint64_t mac;       // learned by the ARP sweep of a local subnet, 0 otherwise
+    };
+    std::vector<HostStatus> Host_Statuses;     // one record per scanned address, in address order
+
+    struct Host6Status {
+        netUtil::IPv6Address address;
+        uint64_t mac;       // from the neighbor cache, 0 for this host
+        NET_IFINDEX interface_index;    // where discovery found it, the zone a link-local address needs
+    };
+    std::vector<Host6Status> IPv6_Hosts;       // what the last IPv6 discovery found, in address order
+    std::vector<netUtil::IPv6Host> ipv6Hosts() const;   // addresses and zones, for scanners taking wide IPv6 prefixes
 
 
 private:
     std::vector<std::string> m_cidr_parts;
     std::vector<std::string> hosts;
-    bool pingHost(const std::string& address, HANDLE icmp_handle);
+    bool m_ipv6;
+    netUtil::IPv6Address m_ipv6_network;
+    int m_ipv6_prefix;
+    memoryUtil::Arena m_scan_arena;            // echo slots and per-host counters, reset by every scan
+    bool arpSweep(uint32_t first_host, size_t host_count, const neighborUtil::OnLinkInterface& on_link);
+    bool pingHost(uint32_t host, HANDLE icmp_handle, int& timeouts, bool& rate_limited);
     void scan(uint32_t ip, uint32_t mask);
+    void discover6(const netUtil::IPv6Address& network, int prefix_length);
+    bool pingHost6(const netUtil::IPv6Address& host);
 
     PingScanner();
     friend class vToolCommand<PingScanner>; //needed to allow getInstance to work in parent class
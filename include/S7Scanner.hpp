@@ -0,0 +1,78 @@
+#ifndef S7_SCANNER_H
+#define S7_SCANNER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include "s7Util.hpp"
+#include "vToolCommand.hpp"
+
+class S7Scanner : public vToolCommand<S7Scanner> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "s7";
+    static constexpr const char* COMMAND_TIP = "Identify Siemens S7 CPUs over ISO-on-TCP (port 102).\n\ts7 <ip|cidr> [concurrency] [timeout ms]";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    struct S7Identity {
+        std::string family;             // S7-300 / 400 / 1200 / 1500, from the order number
+        std::string order_number;       // SZL 0x0011
+        std::string hardware;
+        std::string firmware;
+        std::string system_name;        // SZL 0x001C
+        std::string module_name;
+        std::string module_type;
+        std::string serial_number;
+        uint16_t remote_tsap;
+    };
+
+    std::map<std::string, S7Identity> Devices;     // hosts that answered at least the module identification
+
+private:
+    static constexpr size_t DEFAULT_CONCURRENCY = 64;
+    static constexpr int DEFAULT_TIMEOUT_MS = 2000;
+
+    // Each stage sends exactly one request and waits for its reply before the next, so a CPU
+    // never has more than one of our requests to service
+    enum class Stage { Connecting, CotpConnect, SetupCommunication, ReadModuleId, ReadComponentId };
+
+    struct HostProbe {
+        SOCKET tcp_socket;
+        uint32_t host;
+        Stage stage;
+        size_t tsap_attempt;            // index into s7Util::REMOTE_TSAPS
+        std::chrono::steady_clock::time_point last_activity;
+        std::string send_buffer;
+        size_t send_offset;
+        std::string receive_buffer;
+        S7Identity identity;
+        bool identified;
+    };
+
+    uint32_t m_first_host;
+    uint32_t m_last_host;
+    size_t m_concurrency;
+    int m_timeout_ms;
+
+    void probe(const std::vector<uint32_t>& hosts);
+    bool startProbe(HostProbe& probe);
+    void sendRequest(HostProbe& probe, Stage stage, const std::string& request);
+    bool sendPending(HostProbe& probe);
+    bool receiveReplies(HostProbe& probe);
+    bool handleFrame(HostProbe& probe, const std::string& frame);
+    void storeModuleIdentification(S7Identity& identity, const std::vector<s7Util::SZLRecord>& records);
+    void storeComponentIdentification(S7Identity& identity, const std::vector<s7Util::SZLRecord>& records);
+    std::string familyFromOrderNumber(const std::string& order_number);
+    void report();
+
+    S7Scanner();
+    friend class vToolCommand<S7Scanner>; //needed to allow getInstance to work in parent class
+};
+
+#endif // S7_SCANNER_H
@@ -0,0 +1,73 @@
+#ifndef SNMP_COLLECTOR_H
+#define SNMP_COLLECTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "DeviceProfile.hpp"
+#include "snmpUtil.hpp"
+#include "vToolCommand.hpp"
+
+class SNMPCollector : public vToolCommand<SNMPCollector> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "snmp";
+    static constexpr const char* COMMAND_TIP = "Bulk-walk MAC, LLDP and interface tables over SNMPv2c.\n\tsnmp <ip> [community]\n\tsnmp <cidr> [community]";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    struct NeighborEntry {
+        uint32_t local_port;
+        std::string system_name;
+        std::string port_id;
+    };
+
+    struct DeviceTables {
+        std::map<uint32_t, std::string> interfaces;             // ifIndex -> ifDescr
+        std::map<uint32_t, uint32_t> bridge_port_interfaces;    // dot1dBasePort -> ifIndex
+        std::map<uint64_t, uint32_t> fdb_bridge_ports;          // MAC -> dot1dBasePort
+        std::map<std::string, NeighborEntry> neighbors;         // keyed by LLDP remote table index
+        std::vector<deviceProfile::MacTableEntry> mac_table;    // FDB resolved to interface names
+    };
+
+    std::map<std::string, DeviceTables> Device_Tables;     // only devices that answered
+
+private:
+    enum class Table { InterfaceNames, BridgePortInterfaces, ForwardingPorts, NeighborPortIds, NeighborNames };
+
+    struct WalkTable {
+        Table table;
+        snmpUtil::OID base_oid;
+    };
+
+    struct Walk {   // one table being walked on one device, at most one request in flight
+        size_t device;
+        size_t table;
+        snmpUtil::OID next_oid;
+        size_t rows;
+        int retries;
+        std::chrono::steady_clock::time_point sent_at;
+    };
+
+    static const std::vector<WalkTable> WALK_TABLES;
+    static constexpr uint64_t MAX_HOSTS = 4096;         // a /20; every host costs one walk per table
+    static constexpr size_t MAX_ROWS_PER_WALK = 100000; // the largest FDBs hold about 64k MACs
+
+    uint32_t m_first_host;
+    uint32_t m_last_host;
+    std::string m_community;
+
+    void collect(const std::vector<uint32_t>& hosts);
+    void storeVarBind(DeviceTables& tables, Table table, const snmpUtil::OID& base_oid, const snmpUtil::VarBind& varbind);
+    void resolveMacTable(DeviceTables& tables);
+    void report();
+
+    SNMPCollector();
+    friend class vToolCommand<SNMPCollector>; //needed to allow getInstance to work in parent class
+};
+
+#endif // SNMP_COLLECTOR_H
@@ -2,6 +2,7 @@
 #define SECURE_SHELL_H
 
 #include "vToolCommand.hpp"
+#include "DeviceProfile.hpp"
 #include <string>
 #include <vector>
 
@@ -13,26 +14,38 @@ class SecureShell : public vToolCommand<SecureShell> {
 public:
     // Static command metadata for CRTP base class
     static constexpr const char* COMMAND_PHRASE = "ssh";
-    static constexpr const char* COMMAND_TIP = "Autorun ssh commands against a host.\n\tssh <IP> <user> <pw>";
+    static constexpr const char* COMMAND_TIP = "Autorun ssh commands against a host.\n\tssh <IP> <user> <pw>\n\tssh <IP> <user> <pw> pipeline";
 
     ~SecureShell();
 
     bool validateInput(const std::vector<std::string>& arguments) override;
     void handleCommand(const std::vector<std::string>& arguments) override;
 
+    std::vector<deviceProfile::MacTableEntry> Mac_Table;   // parsed from the last discovery run
+
 private:
     LIBSSH2_SESSION* m_session;
     int m_socket;
     bool m_connected;
+    bool m_pipelined;   // write the whole discovery batch at once instead of one command per prompt
 
-    static const std::vector<std::string> DISCOVERY_COMMANDS;
     static const std::vector<char> PROMPT_ENDINGS;
+    static const std::string PIPELINE_MARKER;
+    static const std::string PIPELINE_ARGUMENT;
+    static constexpr int SHELL_BUFFER_SIZE = 4096;
 
     // Simple connect and execute
     bool connect(const std::string& hostname, const std::string& username, const std::string& password, int port = 22);
     std::string execute(const std::string& command);
     void interactShell();
     std::string waitShellPrompt(LIBSSH2_CHANNEL* channel, char* buffer);
+    template<typename Profile>
+    void runDiscovery(LIBSSH2_CHANNEL* channel, char* buffer);
+    std::vector<std::string> pipelineCommands(LIBSSH2_CHANNEL* channel, char* buffer, const std::vector<std::string>& commands,
+                                              const std::string& marker_prefix, const std::string& marker_split);
+    std::vector<std::string> splitPipelineOutput(const std::string& output, size_t command_count);
+    bool endsWithPrompt(const std::string& output);
+    std::string pipelineMarker(size_t index);
     void disconnect();
 
     SecureShell();
@@ -2,23 +2,69 @@
 #define TCP_SCANNER_H
 
 #include "vToolCommand.hpp"
+#include "portUtil.hpp"
+#include "memoryUtil.hpp"
+#include "netUtil.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <winsock2.h>
 
 class TCPScanner : public vToolCommand<TCPScanner>
 {
     public:
         static constexpr const char* COMMAND_PHRASE = "tcp";
-        static constexpr const char* COMMAND_TIP = "Scan TCP ports on target.\n\ttcp <ip> \n\ttcp <cidr> <port>";
+        static constexpr const char* COMMAND_TIP = "Scan TCP ports on target.\n\ttcp <ip|cidr|ipv6|ipv6 prefix> [ports] [port-major|host-major|random] [perhost=N] [banners]\n\t\tports like 1-1024,502,top100 (default: known, the service table)\n\t\tperhost caps half-open connections to any one device (default 8)\n\t\tbanners reads and classifies what each open port says\n\t\tIPv6 prefixes wider than /112 scan the hosts the last IPv6 ping discovered in them";
 
-        static std::map<int, std::string> Ports;
+        static constexpr size_t DEFAULT_PER_HOST_CAP = 8;    // small PLC stacks run out of sockets past a handful
+
+        struct ServiceBanner {
+            std::string service;        // from the matched signature, empty when nothing matched
+            std::string product;
+            std::string banner;         // raw bytes received, Telnet negotiation removed
+        };
+
+        std::map<std::string, std::map<int, ServiceBanner>> Banners;    // host -> port -> banner, filled by grabBanners
 
         bool validateInput(const std::vector<std::string>& arguments) override;
         void handleCommand(const std::vector<std::string>& arguments) override;
 
+        // Connect-scan every port in the set across many hosts at once, returns the open host/port pairs sorted.
+        // With ipv6_hosts, hosts (in and out) are indexes into that table instead of IPv4 addresses.
+        std::vector<std::pair<uint32_t, int>> sweep(const std::vector<uint32_t>& hosts, const portUtil::PortSet& ports,
+                                                    portUtil::ScanOrder order = portUtil::ScanOrder::PortMajor,
+                                                    size_t per_host_cap = DEFAULT_PER_HOST_CAP,
+                                                    const netUtil::IPv6Host* ipv6_hosts = nullptr);
+        // Connect-scan one port across many hosts at once, returns the hosts that accepted
+        std::vector<uint32_t> sweepPort(const std::vector<uint32_t>& hosts, const int port);
+        static std::string serviceName(const int port);
+
+        // Non-blocking connect building blocks, shared with the protocol probes that follow a sweep
+        static SOCKET startConnect(uint32_t host, const int port);
+        static SOCKET startConnect(const netUtil::IPv6Host& host, const int port);
+        static bool connectSucceeded(SOCKET tcp_socket);
+        static int connectError(SOCKET tcp_socket);     // SO_ERROR once the handshake has finished, 0 when connected
+
+        // Reconnect to open host/port pairs, send the port's probe if it has one and classify the reply
+        void grabBanners(const std::vector<std::pair<uint32_t, int>>& targets, const netUtil::IPv6Host* ipv6_hosts = nullptr);
+
     private:
-        bool synHostPort(const std::string& host, const int port);
+        static constexpr size_t MAX_SWEEP_WINDOW = 1024;    // connects in flight at the AIMD window's widest
+
+        bool m_grab_banners;
+        portUtil::PortSet m_ports;
+        portUtil::ScanOrder m_order;
+        size_t m_per_host_cap;
+        std::vector<netUtil::IPv6Host> m_ipv6_hosts;       // the target's addresses and zones, when it is IPv6
+        memoryUtil::Arena m_sweep_arena;    // engine operations and per-host counters, reset by every sweep
+
+        // The sweep loop itself, instantiated for IocpConnectEngine and PollConnectEngine
+        template <typename Engine>
+        std::vector<std::pair<uint32_t, int>> runSweep(Engine& engine, const std::vector<uint32_t>& hosts,
+                                                       const portUtil::PortSet& ports, portUtil::ScanOrder order,
+                                                       size_t per_host_cap);
+        static SOCKET startConnect(const sockaddr_storage& target_address, int target_length);
         TCPScanner();
         friend class vToolCommand<TCPScanner>;
 };
@@ -0,0 +1,60 @@
+#ifndef UDP_SCANNER_H
+#define UDP_SCANNER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include "netUtil.hpp"
+#include "udpProbes.hpp"
+#include "vToolCommand.hpp"
+
+class UDPScanner : public vToolCommand<UDPScanner> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "udp";
+    static constexpr const char* COMMAND_TIP = "Probe UDP services with protocol-specific payloads.\n\tudp <ip|cidr|ipv6|ipv6 prefix> [port,port,...|all] [retries] [timeout ms]\n\t\tports with probes: 161 SNMP, 69 TFTP, 10001 Ubiquiti, 44818 EtherNet/IP, 47808 BACnet\n\t\tIPv6 prefixes wider than /112 probe the hosts the last IPv6 ping discovered in them";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+    struct OpenPort {
+        uint16_t port;
+        std::string service;
+        std::string summary;        // what the validator made of the reply
+    };
+
+    std::map<std::string, std::vector<OpenPort>> OpenPorts;        // hosts that answered a probe
+    std::map<std::string, std::vector<uint16_t>> ClosedPorts;      // ICMP port unreachable came back
+
+private:
+    static constexpr int DEFAULT_RETRIES = 1;
+    static constexpr int DEFAULT_TIMEOUT_MS = 1000;
+    static constexpr size_t MAX_IN_FLIGHT = 512;     // unanswered probes before sending pauses
+
+    // Only Pending probes hold an in-flight slot, so a reply settles one at most once. Anything still
+    // Pending when its retries run out is Filtered (open|filtered), UDP cannot tell them apart
+    enum class PortState : uint8_t { Unsent, Pending, Open, Closed, Filtered };
+
+    uint32_t m_first_host;          // IPv4 addresses, or for an IPv6 target indexes into m_ipv6_hosts
+    uint32_t m_last_host;
+    std::vector<netUtil::IPv6Host> m_ipv6_hosts;       // sorted by address, so replies are matched by binary search
+    std::vector<const udpProbes::Probe*> m_probes;
+    int m_retries;
+    int m_timeout_ms;
+    uint32_t m_cookie_seed;
+
+    void scan();
+    void sendProbe(SOCKET udp_socket, uint32_t host, const udpProbes::Probe& probe);
+    size_t drainSocket(SOCKET udp_socket, size_t slot, std::vector<PortState>& states);
+    uint32_t cookieFor(uint32_t host) const { return m_cookie_seed ^ host; }
+    std::string hostText(uint32_t host) const;
+    void report(size_t filtered_count);
+
+    UDPScanner();
+    friend class vToolCommand<UDPScanner>; //needed to allow getInstance to work in parent class
+};
+
+#endif // UDP_SCANNER_H
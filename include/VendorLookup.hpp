@@ -0,0 +1,28 @@
+#ifndef VENDOR_LOOKUP_H
+#define VENDOR_LOOKUP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "vToolCommand.hpp"
+
+class VendorLookup : public vToolCommand<VendorLookup> {
+
+public:
+    // Static command metadata for CRTP base class
+    static constexpr const char* COMMAND_PHRASE = "oui";
+    static constexpr const char* COMMAND_TIP = "Look up the vendor of MAC addresses in the IEEE registries.\n\toui <mac> [mac ...]\n\toui build <oui.csv> [mam.csv] [oui36.csv]\n\t\tcompiles the CSV exports from standards-oui.ieee.org into oui.idx, used to label every MAC table";
+
+    bool validateInput(const std::vector<std::string>& arguments) override;
+    void handleCommand(const std::vector<std::string>& arguments) override;
+
+private:
+    bool m_build;
+    std::vector<std::string> m_csv_paths;
+    std::vector<uint64_t> m_macs;
+
+    VendorLookup();
+    friend class vToolCommand<VendorLookup>; //needed to allow getInstance to work in parent class
+};
+
+#endif // VENDOR_LOOKUP_H
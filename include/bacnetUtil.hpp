@@ -0,0 +1,318 @@
+#ifndef BACNET_UTIL_H
+#define BACNET_UTIL_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// BACnet/IP framing (BVLC + NPDU) and the APDUs used for discovery: Who-Is, I-Am and
+// ReadPropertyMultiple on the device object. Multi-byte fields are big-endian.
+namespace bacnetUtil {
+
+    constexpr uint16_t BACNET_PORT = 47808;     // 0xBAC0
+
+    constexpr uint8_t BVLC_TYPE = 0x81;
+    constexpr uint8_t BVLC_FORWARDED_NPDU = 0x04;
+    constexpr uint8_t BVLC_ORIGINAL_UNICAST = 0x0A;
+    constexpr uint8_t BVLC_ORIGINAL_BROADCAST = 0x0B;
+    constexpr size_t BVLC_HEADER_SIZE = 4;
+
+    constexpr uint8_t NPDU_VERSION = 0x01;
+    constexpr uint8_t NPDU_NETWORK_MESSAGE = 0x80;
+    constexpr uint8_t NPDU_DESTINATION_PRESENT = 0x20;
+    constexpr uint8_t NPDU_SOURCE_PRESENT = 0x08;
+    constexpr uint8_t NPDU_EXPECTING_REPLY = 0x04;
+    constexpr uint16_t GLOBAL_NETWORK = 0xFFFF;
+    constexpr uint8_t MAX_HOP_COUNT = 0xFF;
+
+    constexpr uint8_t PDU_CONFIRMED_REQUEST = 0x00;
+    constexpr uint8_t PDU_UNCONFIRMED_REQUEST = 0x10;
+    constexpr uint8_t PDU_COMPLEX_ACK = 0x30;
+    constexpr uint8_t PDU_TYPE_MASK = 0xF0;
+    constexpr uint8_t PDU_SEGMENTED = 0x08;
+
+    constexpr uint8_t SERVICE_I_AM = 0x00;
+    constexpr uint8_t SERVICE_WHO_IS = 0x08;
+    constexpr uint8_t SERVICE_READ_PROPERTY_MULTIPLE = 0x0E;
+
+    constexpr uint16_t OBJECT_DEVICE = 8;
+    constexpr uint32_t MAX_INSTANCE = 0x3FFFFF;
+
+    // Device object properties worth an inventory line
+    constexpr uint32_t PROPERTY_APPLICATION_SOFTWARE_VERSION = 12;
+    constexpr uint32_t PROPERTY_FIRMWARE_REVISION = 44;
+    constexpr uint32_t PROPERTY_MODEL_NAME = 70;
+    constexpr uint32_t PROPERTY_OBJECT_NAME = 77;
+    constexpr uint32_t PROPERTY_VENDOR_NAME = 121;
+
+    // Application tag numbers
+    constexpr uint8_t TAG_BOOLEAN = 1;
+    constexpr uint8_t TAG_UNSIGNED = 2;
+    constexpr uint8_t TAG_SIGNED = 3;
+    constexpr uint8_t TAG_CHARACTER_STRING = 7;
+    constexpr uint8_t TAG_ENUMERATED = 9;
+    constexpr uint8_t TAG_OBJECT_IDENTIFIER = 12;
+
+    struct Route {              // where an NPDU came from, or must go to, beyond the IP hop
+        uint16_t network;       // 0 when the device sits on the local BACnet/IP network
+        std::string mac;        // MS/TP or other data-link address behind a router
+    };
+
+    struct IAm {
+        uint32_t device_instance;
+        uint32_t max_apdu;
+        uint32_t segmentation;
+        uint32_t vendor_id;
+    };
+
+    struct TagHeader {
+        uint8_t number;
+        bool context;
+        bool opening;
+        bool closing;
+        uint32_t length;        // value bytes following the header; booleans carry their value here
+    };
+
+    inline void appendU16(std::string& out, uint16_t value) {
+        out += static_cast<char>(value >> 8);
+        out += static_cast<char>(value & 0xFF);
+    }
+
+    inline uint32_t readUnsigned(const std::string& data, size_t position, size_t length) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < length && i < 4; i++) {
+            value = (value << 8) | static_cast<uint8_t>(data[position + i]);
+        }
+        return value;
+    }
+
+    // Context-tagged unsigned in the fewest bytes; tag numbers above 14 never occur in our requests
+    inline void appendContextUnsigned(std::string& out, uint8_t tag_number, uint32_t value) {
+        std::string bytes;
+        do {
+            bytes.insert(bytes.begin(), static_cast<char>(value & 0xFF));
+            value >>= 8;
+        } while (value > 0);
+        const uint8_t CONTEXT_CLASS = 0x08;
+        out += static_cast<char>((tag_number << 4) | CONTEXT_CLASS | bytes.size());
+        out += bytes;
+    }
+
+    inline void appendContextObjectId(std::string& out, uint8_t tag_number, uint16_t object_type, uint32_t instance) {
+        const uint8_t CONTEXT_CLASS = 0x08;
+        const uint32_t object_id = (static_cast<uint32_t>(object_type) << 22) | (instance & MAX_INSTANCE);
+        out += static_cast<char>((tag_number << 4) | CONTEXT_CLASS | 4);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out += static_cast<char>((object_id >> shift) & 0xFF);
+        }
+    }
+
+    inline void appendOpeningTag(std::string& out, uint8_t tag_number) { out += static_cast<char>((tag_number << 4) | 0x0E); }
+    inline void appendClosingTag(std::string& out, uint8_t tag_number) { out += static_cast<char>((tag_number << 4) | 0x0F); }
+
+    inline std::string buildNPDU(uint8_t control, const Route& destination) {
+        std::string npdu;
+        npdu += static_cast<char>(NPDU_VERSION);
+        const bool routed = destination.network != 0;
+        npdu += static_cast<char>(control | (routed ? NPDU_DESTINATION_PRESENT : 0));
+        if (routed) {
+            appendU16(npdu, destination.network);
+            npdu += static_cast<char>(destination.mac.size());
+            npdu += destination.mac;
+            npdu += static_cast<char>(MAX_HOP_COUNT);
+        }
+        return npdu;
+    }
+
+    inline std::string buildBVLC(uint8_t function, const std::string& npdu) {
+        std::string packet;
+        packet += static_cast<char>(BVLC_TYPE);
+        packet += static_cast<char>(function);
+        appendU16(packet, static_cast<uint16_t>(npdu.size() + BVLC_HEADER_SIZE));
+        return packet + npdu;
+    }
+
+    // Broadcast Who-Is goes to every BACnet network (DNET 0xFFFF) so routers repeat it onto MS/TP trunks
+    inline std::string buildWhoIs(bool broadcast, bool ranged, uint32_t low_limit, uint32_t high_limit) {
+        const Route GLOBAL_BROADCAST = {GLOBAL_NETWORK, ""};
+        const Route LOCAL = {0, ""};
+        std::string npdu = buildNPDU(0, broadcast ? GLOBAL_BROADCAST : LOCAL);
+        npdu += static_cast<char>(PDU_UNCONFIRMED_REQUEST);
+        npdu += static_cast<char>(SERVICE_WHO_IS);
+        if (ranged) {
+            appendContextUnsigned(npdu, 0, low_limit);
+            appendContextUnsigned(npdu, 1, high_limit);
+        }
+        return buildBVLC(broadcast ? BVLC_ORIGINAL_BROADCAST : BVLC_ORIGINAL_UNICAST, npdu);
+    }
+
+    // One ReadPropertyMultiple for several properties of one device object
+    inline std::string buildReadPropertyMultiple(uint8_t invoke_id, uint32_t device_instance, const Route& route,
+                                                 const std::vector<uint32_t>& property_ids) {
+        const uint8_t MAX_APDU_1476_NO_SEGMENTS = 0x05;
+        std::string npdu = buildNPDU(NPDU_EXPECTING_REPLY, route);
+        npdu += static_cast<char>(PDU_CONFIRMED_REQUEST);
+        npdu += static_cast<char>(MAX_APDU_1476_NO_SEGMENTS);
+        npdu += static_cast<char>(invoke_id);
+        npdu += static_cast<char>(SERVICE_READ_PROPERTY_MULTIPLE);
+        appendContextObjectId(npdu, 0, OBJECT_DEVICE, device_instance);
+        appendOpeningTag(npdu, 1);
+        for (uint32_t property_id : property_ids) {
+            appendContextUnsigned(npdu, 0, property_id);
+        }
+        appendClosingTag(npdu, 1);
+        return buildBVLC(BVLC_ORIGINAL_UNICAST, npdu);
+    }
+
+    inline bool readTag(const std::string& data, size_t& position, TagHeader& tag) {
+        if (position >= data.size()) return false;
+        const uint8_t first = static_cast<uint8_t>(data[position++]);
+        tag.number = first >> 4;
+        if (tag.number == 0x0F) {   // extended tag number
+            if (position >= data.size()) return false;
+            tag.number = static_cast<uint8_t>(data[position++]);
+        }
+        tag.context = (first & 0x08) != 0;
+        const uint8_t length_value_type = first & 0x07;
+        tag.opening = tag.context && length_value_type == 6;
+        tag.closing = tag.context && length_value_type == 7;
+        tag.length = 0;
+        if (tag.opening || tag.closing) return true;
+        if (!tag.context && tag.number == TAG_BOOLEAN) {
+            tag.length = 0;     // value lives in the header, nothing follows
+            return true;
+        }
+        if (length_value_type < 5) {
+            tag.length = length_value_type;
+        }
+        else {                  // extended length
+            if (position >= data.size()) return false;
+            const uint8_t extended = static_cast<uint8_t>(data[position++]);
+            const size_t length_bytes = (extended == 254) ? 2 : (extended == 255) ? 4 : 0;
+            if (position + length_bytes > data.size()) return false;
+            tag.length = length_bytes ? readUnsigned(data, position, length_bytes) : extended;
+            position += length_bytes;
+        }
+        return position + tag.length <= data.size();
+    }
+
+    // Check BVLC and NPDU, returning the APDU offset. For forwarded broadcasts the original sender's
+    // B/IP address replaces the UDP source; routed replies carry their network and MAC.
+    inline bool parseHeaders(const std::string& packet, size_t& apdu_offset, uint32_t& forwarded_from, Route& source) {
+        if (packet.size() < BVLC_HEADER_SIZE + 2 || static_cast<uint8_t>(packet[0]) != BVLC_TYPE) return false;
+        const uint8_t function = static_cast<uint8_t>(packet[1]);
+        size_t position = BVLC_HEADER_SIZE;
+        forwarded_from = 0;
+        if (function == BVLC_FORWARDED_NPDU) {
+            const size_t BIP_ADDRESS_SIZE = 6;
+            if (packet.size() < position + BIP_ADDRESS_SIZE + 2) return false;
+            forwarded_from = readUnsigned(packet, position, 4);
+            position += BIP_ADDRESS_SIZE;
+        }
+        else if (function != BVLC_ORIGINAL_UNICAST && function != BVLC_ORIGINAL_BROADCAST) {
+            return false;
+        }
+
+        if (static_cast<uint8_t>(packet[position]) != NPDU_VERSION) return false;
+        const uint8_t control = static_cast<uint8_t>(packet[position + 1]);
+        position += 2;
+        if (control & NPDU_NETWORK_MESSAGE) return false;
+        if (control & NPDU_DESTINATION_PRESENT) {
+            if (position + 3 > packet.size()) return false;
+            position += 3 + static_cast<uint8_t>(packet[position + 2]);
+        }
+        source = {0, ""};
+        if (control & NPDU_SOURCE_PRESENT) {
+            if (position + 3 > packet.size()) return false;
+            source.network = static_cast<uint16_t>(readUnsigned(packet, position, 2));
+            const size_t mac_length = static_cast<uint8_t>(packet[position + 2]);
+            if (position + 3 + mac_length > packet.size()) return false;
+            source.mac = packet.substr(position + 3, mac_length);
+            position += 3 + mac_length;
+        }
+        if (control & NPDU_DESTINATION_PRESENT) {
+            position++;     // hop count
+        }
+        apdu_offset = position;
+        return position < packet.size();
+    }
+
+    inline bool parseIAm(const std::string& packet, size_t apdu_offset, IAm& i_am) {
+        if (apdu_offset + 2 > packet.size() || static_cast<uint8_t>(packet[apdu_offset]) != PDU_UNCONFIRMED_REQUEST
+            || static_cast<uint8_t>(packet[apdu_offset + 1]) != SERVICE_I_AM) {
+            return false;
+        }
+        size_t position = apdu_offset + 2;
+        TagHeader tag;
+        uint32_t fields[4];
+        const uint8_t EXPECTED_TAGS[4] = {TAG_OBJECT_IDENTIFIER, TAG_UNSIGNED, TAG_ENUMERATED, TAG_UNSIGNED};
+        for (int i = 0; i < 4; i++) {
+            if (!readTag(packet, position, tag) || tag.context || tag.number != EXPECTED_TAGS[i]) return false;
+            fields[i] = readUnsigned(packet, position, tag.length);
+            position += tag.length;
+        }
+        if ((fields[0] >> 22) != OBJECT_DEVICE) return false;
+        i_am.device_instance = fields[0] & MAX_INSTANCE;
+        i_am.max_apdu = fields[1];
+        i_am.segmentation = fields[2];
+        i_am.vendor_id = fields[3];
+        return true;
+    }
+
+    // Render one application-tagged value; strings lose their character-set byte
+    inline std::string valueToString(const std::string& data, size_t position, const TagHeader& tag) {
+        switch (tag.number) {
+            case TAG_CHARACTER_STRING:
+                return tag.length > 1 ? data.substr(position + 1, tag.length - 1) : "";
+            case TAG_UNSIGNED:
+            case TAG_ENUMERATED:
+                return std::to_string(readUnsigned(data, position, tag.length));
+            default:
+                return "";
+        }
+    }
+
+    // Parse a ReadPropertyMultiple complex ACK for one object into property id -> printable value.
+    // Properties the device answers with an error are left out.
+    inline bool parseReadPropertyMultipleAck(const std::string& packet, size_t apdu_offset, uint8_t& invoke_id,
+                                             std::map<uint32_t, std::string>& values) {
+        const size_t ACK_HEADER_SIZE = 3;   // type, invoke id, service
+        if (apdu_offset + ACK_HEADER_SIZE > packet.size()) return false;
+        const uint8_t pdu_type = static_cast<uint8_t>(packet[apdu_offset]);
+        if ((pdu_type & PDU_TYPE_MASK) != PDU_COMPLEX_ACK || (pdu_type & PDU_SEGMENTED)
+            || static_cast<uint8_t>(packet[apdu_offset + 2]) != SERVICE_READ_PROPERTY_MULTIPLE) {
+            return false;
+        }
+        invoke_id = static_cast<uint8_t>(packet[apdu_offset + 1]);
+
+        size_t position = apdu_offset + ACK_HEADER_SIZE;
+        TagHeader tag;
+        if (!readTag(packet, position, tag) || !tag.context || tag.number != 0) return false;   // object identifier
+        position += tag.length;
+        if (!readTag(packet, position, tag) || !tag.opening || tag.number != 1) return false;
+
+        uint32_t property_id = 0;
+        while (readTag(packet, position, tag)) {
+            if (tag.closing && tag.number == 1) return true;
+            if (tag.context && !tag.opening && !tag.closing) {
+                if (tag.number == 2) property_id = readUnsigned(packet, position, tag.length);  // array index [3] ignored
+                position += tag.length;
+                continue;
+            }
+            if (!tag.opening) return false;
+            const bool is_error = (tag.number == 5);
+            const uint8_t section = tag.number;
+            while (readTag(packet, position, tag) && !(tag.closing && tag.number == section)) {   // value or error body
+                if (!is_error && !tag.context && values.count(property_id) == 0) {
+                    values[property_id] = valueToString(packet, position, tag);
+                }
+                position += tag.length;
+            }
+        }
+        return false;
+    }
+
+}
+
+#endif // BACNET_UTIL_H
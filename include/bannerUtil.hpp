@@ -0,0 +1,253 @@
+#ifndef BANNER_UTIL_H
+#define BANNER_UTIL_H
+
+#include <array>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <vector>
+
+// Service banner probes and signature classification for the TCP scanner's banner stage.
+// Signatures are plain substrings matched case-insensitively by one Aho-Corasick automaton,
+// so a banner is classified in a single pass no matter how many signatures there are.
+namespace bannerUtil {
+
+    struct Signature {
+        const char* pattern;        // lowercase
+        const char* service;
+        const char* product;
+    };
+
+    // Earlier entries win when several match, so specific products come before generic protocol markers
+    inline const std::vector<Signature>& signatures() {
+        static const std::vector<Signature> SIGNATURES = {
+            // Industrial web servers and HMIs
+            {"simatic", "HTTP", "Siemens SIMATIC"},
+            {"server: siemens", "HTTP", "Siemens"},
+            {"allen-bradley", "HTTP", "Rockwell Allen-Bradley"},
+            {"rockwell automation", "HTTP", "Rockwell Automation"},
+            {"schneider-web", "HTTP", "Schneider Electric"},
+            {"modicon", "HTTP", "Schneider Modicon"},
+            {"wago", "HTTP", "WAGO"},
+            {"phoenix contact", "HTTP", "Phoenix Contact"},
+            {"codesys", "HTTP", "CODESYS WebVisu"},
+            {"niagara", "HTTP", "Tridium Niagara"},
+            {"server: hms", "HTTP", "HMS Anybus"},
+            {"moxa", "HTTP", "Moxa"},
+            // Embedded and general web servers
+            {"server: goahead", "HTTP", "GoAhead embedded"},
+            {"server: boa", "HTTP", "Boa embedded"},
+            {"rompager", "HTTP", "Allegro RomPager"},
+            {"server: micro_httpd", "HTTP", "micro_httpd"},
+            {"server: mini_httpd", "HTTP", "mini_httpd"},
+            {"server: lighttpd", "HTTP", "lighttpd"},
+            {"server: nginx", "HTTP", "nginx"},
+            {"server: apache", "HTTP", "Apache httpd"},
+            {"server: microsoft-iis", "HTTP", "Microsoft IIS"},
+            {"server: microsoft-httpapi", "HTTP", "Windows HTTP.sys"},
+            {"server: cisco", "HTTP", "Cisco"},
+            // SSH
+            {"ssh-2.0-openssh", "SSH", "OpenSSH"},
+            {"ssh-2.0-dropbear", "SSH", "Dropbear"},
+            {"ssh-2.0-cisco", "SSH", "Cisco"},
+            {"ssh-2.0-rosssh", "SSH", "MikroTik RouterOS"},
+            // Telnet login prompts
+            {"user access verification", "Telnet", "Cisco IOS"},
+            {"busybox", "Telnet", "BusyBox"},
+            {"mikrotik", "Telnet", "MikroTik RouterOS"},
+            // Mail and file transfer
+            {"filezilla server", "FTP", "FileZilla Server"},
+            {"vsftpd", "FTP", "vsftpd"},
+            {"proftpd", "FTP", "ProFTPD"},
+            {"microsoft ftp service", "FTP", "Microsoft FTP"},
+            {"postfix", "SMTP", "Postfix"},
+            {"exim", "SMTP", "Exim"},
+            {"microsoft esmtp", "SMTP", "Microsoft Exchange"},
+            {"dovecot", "IMAP/POP3", "Dovecot"},
+            // Databases and remote desktop
+            {"mysql_native_password", "MySQL", "MySQL"},
+            {"caching_sha2_password", "MySQL", "MySQL 8"},
+            {"mariadb", "MySQL", "MariaDB"},
+            {"rfb 003.", "VNC", "RFB"},
+            // Generic protocol markers, last resort
+            {"ssh-", "SSH", ""},
+            {"http/1.", "HTTP", ""},
+            {"esmtp", "SMTP", ""},
+            {"ftp", "FTP", ""},
+            {"login:", "Telnet", ""},
+            {"+ok", "POP3", ""},
+            {"* ok", "IMAP", ""},
+        };
+        return SIGNATURES;
+    }
+
+    class SignatureMatcher {
+    public:
+        static constexpr int NO_MATCH = -1;
+
+        explicit SignatureMatcher(const std::vector<Signature>& signatures) {
+            m_next.push_back({});
+            m_best.push_back(NO_MATCH);
+            for (size_t index = 0; index < signatures.size(); index++) {    // trie of all patterns
+                int32_t state = 0;
+                for (const char* c = signatures[index].pattern; *c; c++) {
+                    const uint8_t symbol = static_cast<uint8_t>(*c);
+                    if (m_next[state][symbol] == 0) {
+                        m_next[state][symbol] = static_cast<int32_t>(m_next.size());
+                        m_next.push_back({});
+                        m_best.push_back(NO_MATCH);
+                    }
+                    state = m_next[state][symbol];
+                }
+                if (m_best[state] == NO_MATCH) m_best[state] = static_cast<int>(index);
+            }
+
+            // Breadth-first over the trie, turning failure links into direct transitions so matching
+            // never backtracks; each state inherits the best signature of its failure state
+            std::vector<int32_t> fail(m_next.size(), 0);
+            std::queue<int32_t> pending;
+            for (int symbol = 0; symbol < 256; symbol++) {
+                if (m_next[0][symbol]) pending.push(m_next[0][symbol]);
+            }
+            while (!pending.empty()) {
+                const int32_t state = pending.front();
+                pending.pop();
+                const int inherited = m_best[fail[state]];
+                if (inherited != NO_MATCH && (m_best[state] == NO_MATCH || inherited < m_best[state])) {
+                    m_best[state] = inherited;
+                }
+                for (int symbol = 0; symbol < 256; symbol++) {
+                    const int32_t child = m_next[state][symbol];
+                    if (child) {
+                        fail[child] = m_next[fail[state]][symbol];
+                        pending.push(child);
+                    }
+                    else {
+                        m_next[state][symbol] = m_next[fail[state]][symbol];
+                    }
+                }
+            }
+        }
+
+        // Index of the highest-priority signature found anywhere in text, or NO_MATCH
+        int match(const std::string& text) const {
+            int best = NO_MATCH;
+            int32_t state = 0;
+            for (char c : text) {
+                const uint8_t symbol = static_cast<uint8_t>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+                state = m_next[state][symbol];
+                const int found = m_best[state];
+                if (found != NO_MATCH && (best == NO_MATCH || found < best)) best = found;
+            }
+            return best;
+        }
+
+    private:
+        std::vector<std::array<int32_t, 256>> m_next;     // full transition table, state 0 is the root
+        std::vector<int> m_best;                          // lowest signature index ending at or before each state
+    };
+
+    inline const SignatureMatcher& matcher() {
+        static const SignatureMatcher MATCHER(signatures());
+        return MATCHER;
+    }
+
+    // Request to send right after connecting; empty for services that speak first (SSH, FTP, SMTP, Telnet)
+    inline std::string probeFor(int port) {
+        switch (port) {
+            case 80:
+            case 8000:
+            case 8008:
+            case 8080:
+            case 8081:
+            case 8888:
+                return "HEAD / HTTP/1.0\r\n\r\n";
+            case 22:
+                return "SSH-2.0-NetworkCartographer\r\n";
+            default:
+                return "";
+        }
+    }
+
+    // Strip Telnet option negotiation out of received data, refusing every option offered so the
+    // server moves on to its login prompt. Refusals are appended to reply. A sequence cut off at the
+    // end of data is left in carry and finished off by the next call, so it never leaks into the text.
+    inline std::string stripTelnet(const std::string& data, std::string& carry, std::string& reply) {
+        const uint8_t IAC = 255, DONT = 254, DO = 253, WONT = 252, WILL = 251, SB = 250, SE = 240;
+        const std::string input = carry + data;
+        carry.clear();
+        std::string text;
+        size_t position = 0;
+        while (position < input.size()) {
+            const uint8_t byte = static_cast<uint8_t>(input[position]);
+            if (byte != IAC) {
+                text += input[position++];
+                continue;
+            }
+            if (position + 1 >= input.size()) {     // lone IAC, command still to come
+                carry = input.substr(position);
+                break;
+            }
+            const uint8_t command = static_cast<uint8_t>(input[position + 1]);
+            const bool negotiation = (command == DO || command == WILL || command == DONT || command == WONT);
+            if (negotiation && position + 2 >= input.size()) {     // option byte still to come
+                carry = input.substr(position);
+                break;
+            }
+            if (command == DO || command == WILL) {
+                reply += static_cast<char>(IAC);
+                reply += static_cast<char>(command == DO ? WONT : DONT);
+                reply += input[position + 2];
+                position += 3;
+            }
+            else if (command == DONT || command == WONT) {
+                position += 3;
+            }
+            else if (command == SB) {       // skip subnegotiation up to IAC SE
+                const size_t end = input.find(std::string{static_cast<char>(IAC), static_cast<char>(SE)}, position + 2);
+                if (end == std::string::npos) {     // its body is dropped anyway, only remember a trailing IAC
+                    carry = std::string{static_cast<char>(IAC), static_cast<char>(SB)};
+                    if (input.size() > position + 2 && static_cast<uint8_t>(input.back()) == IAC) carry += static_cast<char>(IAC);
+                    break;
+                }
+                position = end + 2;
+            }
+            else if (command == IAC) {      // escaped 255 data byte
+                text += input[position + 1];
+                position += 2;
+            }
+            else {
+                position += 2;
+            }
+        }
+        return text;
+    }
+
+    // First meaningful line of a banner with control characters dropped, for display
+    inline std::string firstLine(const std::string& banner) {
+        const size_t MAX_DISPLAY_LENGTH = 80;
+        std::string line;
+        for (char c : banner) {
+            if (c == '\n' || c == '\r') {
+                if (!line.empty()) break;
+                continue;
+            }
+            if (c >= 0x20 && c < 0x7F) line += c;
+            if (line.size() == MAX_DISPLAY_LENGTH) break;
+        }
+        return line;
+    }
+
+    // HTTP replies are best described by their Server header, everything else by its first line
+    inline std::string displayLine(const std::string& banner) {
+        std::string lowered(banner);
+        for (char& c : lowered) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+        }
+        const size_t server_header = lowered.find("\nserver:");
+        return firstLine(server_header == std::string::npos ? banner : banner.substr(server_header + 1));
+    }
+
+}
+
+#endif // BANNER_UTIL_H
@@ -0,0 +1,202 @@
+#ifndef CAPTURE_UTIL_H
+#define CAPTURE_UTIL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reader for pcap and pcapng capture files held in memory (normally a mapped view of the file).
+// Frames point straight into that memory, so replaying a capture copies nothing; the caller keeps the
+// mapping alive for as long as it uses the frames.
+namespace captureUtil {
+
+    // LINKTYPE_ values from the tcpdump registry that the dissectors understand
+    constexpr uint32_t LINKTYPE_ETHERNET = 1;
+    constexpr uint32_t LINKTYPE_RAW = 101;          // bare IPv4 or IPv6 packet
+    constexpr uint32_t LINKTYPE_LINUX_SLL = 113;    // "any" interface captures on Linux
+    constexpr uint32_t LINKTYPE_IPV4 = 228;
+
+    struct Frame {
+        const uint8_t* data;
+        uint32_t length;        // captured bytes, may be less than on the wire when a snaplen was set
+        uint32_t link_type;
+    };
+
+    class CaptureReader {
+    public:
+        CaptureReader() : m_data(nullptr), m_size(0), m_position(0), m_pcapng(false), m_swapped(false), m_link_type(0), m_truncated(false) {}
+
+        // Recognises the format from the first block; error says why when it is neither
+        bool open(const uint8_t* data, size_t size, std::string& error) {
+            const uint32_t PCAP_MICROSECONDS = 0xA1B2C3D4;
+            const uint32_t PCAP_NANOSECONDS = 0xA1B23C4D;
+            const uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+            const size_t PCAP_HEADER_SIZE = 24;
+            const size_t PCAP_LINK_TYPE_OFFSET = 20;
+
+            m_data = data;
+            m_size = size;
+            m_position = 0;
+            m_truncated = false;
+            m_interface_link_types.clear();
+            if (size < PCAP_HEADER_SIZE) {
+                error = "file is too short to be a capture";
+                return false;
+            }
+            const uint32_t magic = readNative32(0);
+            if (magic == PCAPNG_SECTION_HEADER) {
+                m_pcapng = true;
+                return true;    // the section header is read like any other block
+            }
+            m_pcapng = false;
+            if (magic == PCAP_MICROSECONDS || magic == PCAP_NANOSECONDS) {
+                m_swapped = false;
+            }
+            else if (swap32(magic) == PCAP_MICROSECONDS || swap32(magic) == PCAP_NANOSECONDS) {
+                m_swapped = true;
+            }
+            else {
+                error = "not a pcap or pcapng file";
+                return false;
+            }
+            m_link_type = read32(PCAP_LINK_TYPE_OFFSET);
+            m_position = PCAP_HEADER_SIZE;
+            return true;
+        }
+
+        // Next packet in file order; false at the end, or at a record cut short (see truncated())
+        bool next(Frame& frame) {
+            return m_pcapng ? nextBlock(frame) : nextRecord(frame);
+        }
+
+        bool truncated() const { return m_truncated; }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_position;
+        bool m_pcapng;
+        bool m_swapped;                 // file byte order differs from ours (per section for pcapng)
+        uint32_t m_link_type;           // pcap: one link type for the whole file
+        std::vector<uint32_t> m_interface_link_types;  // pcapng: per interface, in description block order
+        bool m_truncated;
+
+        static uint32_t swap32(uint32_t value) {
+            return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+        }
+
+        uint32_t readNative32(size_t position) const {
+            uint32_t value = 0;
+            for (int i = 3; i >= 0; i--) value = (value << 8) | m_data[position + i];     // Windows is little-endian
+            return value;
+        }
+
+        uint32_t read32(size_t position) const {
+            const uint32_t value = readNative32(position);
+            return m_swapped ? swap32(value) : value;
+        }
+
+        uint16_t read16(size_t position) const {
+            const uint16_t value = static_cast<uint16_t>(m_data[position] | (m_data[position + 1] << 8));
+            return m_swapped ? static_cast<uint16_t>((value >> 8) | (value << 8)) : value;
+        }
+
+        bool nextRecord(Frame& frame) {
+            const size_t RECORD_HEADER_SIZE = 16;
+            const size_t CAPTURED_LENGTH_OFFSET = 8;
+            if (m_position == m_size) return false;
+            if (m_size - m_position < RECORD_HEADER_SIZE) {
+                m_truncated = true;
+                return false;
+            }
+            const uint32_t captured = read32(m_position + CAPTURED_LENGTH_OFFSET);
+            if (captured > m_size - m_position - RECORD_HEADER_SIZE) {
+                m_truncated = true;
+                return false;
+            }
+            frame = {m_data + m_position + RECORD_HEADER_SIZE, captured, m_link_type};
+            m_position += RECORD_HEADER_SIZE + captured;
+            return true;
+        }
+
+        // Walks blocks until one carries a packet, learning byte order and interfaces on the way
+        bool nextBlock(Frame& frame) {
+            const uint32_t SECTION_HEADER = 0x0A0D0D0A;
+            const uint32_t INTERFACE_DESCRIPTION = 1;
+            const uint32_t OBSOLETE_PACKET = 2;
+            const uint32_t SIMPLE_PACKET = 3;
+            const uint32_t ENHANCED_PACKET = 6;
+            const uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+            const size_t BLOCK_OVERHEAD = 12;       // type, total length, trailing total length
+            const size_t PACKET_FIELDS_SIZE = 20;   // enhanced and obsolete packet fields before the data
+
+            while (m_position < m_size) {
+                if (m_size - m_position < BLOCK_OVERHEAD) {
+                    m_truncated = true;
+                    return false;
+                }
+                const uint32_t type = readNative32(m_position);     // the section magic reads the same either way
+                if (type == SECTION_HEADER) {
+                    if (m_size - m_position < BLOCK_OVERHEAD + 4) {
+                        m_truncated = true;
+                        return false;
+                    }
+                    const uint32_t byte_order = readNative32(m_position + 8);
+                    if (byte_order != BYTE_ORDER_MAGIC && swap32(byte_order) != BYTE_ORDER_MAGIC) {
+                        m_truncated = true;
+                        return false;
+                    }
+                    m_swapped = (byte_order != BYTE_ORDER_MAGIC);
+                    m_interface_link_types.clear();     // interface ids restart in every section
+                }
+                const uint32_t total_length = read32(m_position + 4);
+                if (total_length < BLOCK_OVERHEAD || total_length % 4 != 0 || total_length > m_size - m_position) {
+                    m_truncated = true;
+                    return false;
+                }
+                const size_t body = m_position + 8;
+                const size_t body_length = total_length - BLOCK_OVERHEAD;
+                m_position += total_length;
+
+                switch (swapIfNeeded(type)) {
+                    case INTERFACE_DESCRIPTION:
+                        if (body_length >= 2) m_interface_link_types.push_back(read16(body));
+                        break;
+                    case ENHANCED_PACKET:
+                        if (body_length < PACKET_FIELDS_SIZE) break;
+                        if (packetFrom(body, body_length, read32(body), PACKET_FIELDS_SIZE, read32(body + 12), frame)) return true;
+                        break;
+                    case OBSOLETE_PACKET:
+                        if (body_length < PACKET_FIELDS_SIZE) break;
+                        if (packetFrom(body, body_length, read16(body), PACKET_FIELDS_SIZE, read32(body + 12), frame)) return true;
+                        break;
+                    case SIMPLE_PACKET: {     // no captured length field: whatever the block holds, up to the original
+                        if (body_length < 4) break;
+                        const uint32_t original = read32(body);
+                        const uint32_t captured = static_cast<uint32_t>(std::min<size_t>(original, body_length - 4));
+                        if (packetFrom(body, body_length, 0, 4, captured, frame)) return true;
+                        break;
+                    }
+                    default:
+                        break;      // statistics, name resolution, custom blocks
+                }
+            }
+            return false;
+        }
+
+        uint32_t swapIfNeeded(uint32_t native_type) const {
+            return m_swapped ? swap32(native_type) : native_type;
+        }
+
+        bool packetFrom(size_t body, size_t body_length, uint32_t interface_id, size_t data_offset, uint32_t captured, Frame& frame) const {
+            if (body_length < data_offset || captured > body_length - data_offset) return false;
+            if (interface_id >= m_interface_link_types.size()) return false;   // packet for an undescribed interface
+            frame = {m_data + body + data_offset, captured, m_interface_link_types[interface_id]};
+            return true;
+        }
+    };
+
+}
+
+#endif // CAPTURE_UTIL_H
@@ -0,0 +1,101 @@
+#ifndef CONGESTION_UTIL_H
+#define CONGESTION_UTIL_H
+
+#include <algorithm>
+#include <cstddef>
+
+// Additive-increase / multiplicative-decrease control of how many probes a scan keeps in flight.
+// Not thread-safe: single-threaded engines call it directly, threaded ones hold their own lock.
+namespace congestionUtil {
+
+    enum class Signal {
+        Response,   // the probe got any answer (reply, RST, ICMP unreachable): the path delivered it
+        Timeout,    // nothing came back
+        RateLimit   // an explicit throttle: ICMP source quench, local socket or buffer exhaustion
+    };
+
+    // Slow start doubles the window each round trip until the first loss, then congestion avoidance
+    // adds one probe per window's worth of responses. A sweep always has timeouts from dead hosts and
+    // filtered ports, so a timeout on its own is not loss: each epoch (one window of outcomes) is compared
+    // with the running timeout rate, and only an epoch clearly worse than that baseline halves the window.
+    // Timeouts in an epoch that matched the baseline then count toward growth like responses, otherwise a
+    // sweep through mostly empty address space would never open the window.
+    class AimdWindow {
+    public:
+        AimdWindow(double initial, double minimum, double maximum)
+            : m_window(initial), m_threshold(maximum), m_minimum(minimum), m_maximum(maximum),
+              m_epoch_responses(0), m_epoch_timeouts(0), m_baseline_timeout_rate(-1.0), m_decreased_this_epoch(false),
+              m_peak(initial) {}
+
+        size_t size() const { return static_cast<size_t>(m_window); }
+        size_t peak() const { return static_cast<size_t>(m_peak); }
+
+        void record(Signal signal) {
+            switch (signal) {
+                case Signal::Response:
+                    m_epoch_responses++;
+                    grow(1);
+                    break;
+                case Signal::Timeout:
+                    m_epoch_timeouts++;
+                    break;
+                case Signal::RateLimit:
+                    decrease();
+                    break;
+            }
+            const size_t MIN_EPOCH_SAMPLES = 8;
+            if (m_epoch_responses + m_epoch_timeouts >= std::max(MIN_EPOCH_SAMPLES, size())) {
+                endEpoch();
+            }
+        }
+
+    private:
+        double m_window;
+        double m_threshold;         // slow start below, congestion avoidance above
+        double m_minimum;
+        double m_maximum;
+        size_t m_epoch_responses;
+        size_t m_epoch_timeouts;
+        double m_baseline_timeout_rate;     // negative until the first epoch closes
+        bool m_decreased_this_epoch;        // a burst of signals from one round trip only counts once
+        double m_peak;
+
+        void grow(size_t deliveries) {
+            for (size_t i = 0; i < deliveries && m_window < m_maximum; i++) {
+                m_window += (m_window < m_threshold) ? 1.0 : 1.0 / m_window;
+            }
+            m_window = std::min(m_window, m_maximum);
+            m_peak = std::max(m_peak, m_window);
+        }
+
+        void decrease() {
+            if (m_decreased_this_epoch) return;
+            m_threshold = std::max(m_window / 2.0, m_minimum);
+            m_window = m_threshold;
+            m_decreased_this_epoch = true;
+        }
+
+        void endEpoch() {
+            const double TOLERANCE = 0.10;          // absolute rise in timeout rate that is noise
+            const double CONGESTED_RATIO = 1.5;     // and the relative rise that is not
+            const double BASELINE_WEIGHT = 0.2;
+            const double timeout_rate = static_cast<double>(m_epoch_timeouts) / (m_epoch_responses + m_epoch_timeouts);
+            if (m_baseline_timeout_rate < 0.0) {
+                m_baseline_timeout_rate = timeout_rate;
+            }
+            else if (timeout_rate > m_baseline_timeout_rate + TOLERANCE && timeout_rate > m_baseline_timeout_rate * CONGESTED_RATIO) {
+                decrease();     // the congested epoch stays out of the baseline
+            }
+            else {
+                m_baseline_timeout_rate += BASELINE_WEIGHT * (timeout_rate - m_baseline_timeout_rate);
+                if (!m_decreased_this_epoch) grow(m_epoch_timeouts);
+            }
+            m_epoch_responses = 0;
+            m_epoch_timeouts = 0;
+            m_decreased_this_epoch = false;
+        }
+    };
+
+}
+
+#endif // CONGESTION_UTIL_H
@@ -0,0 +1,243 @@
+#ifndef DNS_UTIL_H
+#define DNS_UTIL_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+
+// DNS message pieces for naming hosts: reverse (PTR) queries, which unicast DNS and mDNS responders both
+// answer, and NetBIOS node status, which Windows hosts answer on UDP 137. Everything reads and writes
+// caller buffers in place.
+namespace dnsUtil {
+
+    constexpr uint16_t DNS_PORT = 53;
+    constexpr uint16_t NBNS_PORT = 137;
+    constexpr uint16_t MDNS_PORT = 5353;
+
+    constexpr size_t HEADER_SIZE = 12;
+    constexpr size_t MAX_NAME_LENGTH = 255;
+    constexpr size_t MAX_QUERY_SIZE = 64;       // longest query built here: a PTR for 255.255.255.255
+
+    constexpr uint8_t RCODE_NO_ERROR = 0;
+    constexpr uint8_t RCODE_NAME_ERROR = 3;     // NXDOMAIN
+    constexpr uint8_t RCODE_REFUSED = 5;
+
+    inline uint16_t readBE16(const uint8_t* data) {
+        return static_cast<uint16_t>((data[0] << 8) | data[1]);
+    }
+
+    inline uint32_t readBE32(const uint8_t* data) {
+        return (static_cast<uint32_t>(readBE16(data)) << 16) | readBE16(data + 2);
+    }
+
+    inline void writeBE16(uint8_t* data, uint16_t value) {
+        data[0] = static_cast<uint8_t>(value >> 8);
+        data[1] = static_cast<uint8_t>(value);
+    }
+
+    // DNS name at position (following compression pointers) into out as dotted text; position moves past
+    // the name as it appears in the record
+    inline bool readDnsName(const uint8_t* message, size_t length, size_t& position, char* out, size_t out_capacity, size_t& out_length) {
+        const int MAX_POINTER_JUMPS = 16;
+        size_t cursor = position;
+        bool jumped = false;
+        int jumps = 0;
+        out_length = 0;
+        while (cursor < length) {
+            const uint8_t label_length = message[cursor];
+            if (label_length == 0) {
+                if (!jumped) position = cursor + 1;
+                return true;
+            }
+            if ((label_length & 0xC0) == 0xC0) {
+                if (cursor + 1 >= length || ++jumps > MAX_POINTER_JUMPS) return false;
+                if (!jumped) position = cursor + 2;
+                jumped = true;
+                cursor = ((label_length & 0x3F) << 8) | message[cursor + 1];
+                continue;
+            }
+            if (cursor + 1 + label_length > length) return false;
+            if (out_length + label_length + 1 < out_capacity) {
+                if (out_length > 0) out[out_length++] = '.';
+                for (size_t i = 0; i < label_length; i++) out[out_length++] = static_cast<char>(message[cursor + 1 + i]);
+            }
+            cursor += 1 + label_length;
+        }
+        return false;
+    }
+
+    // "d.c.b.a.in-addr.arpa" for a.b.c.d (host order in, as everywhere else), returns its length
+    inline size_t reverseName(uint32_t address, char* out) {
+        const char SUFFIX[] = "in-addr.arpa";
+        size_t length = 0;
+        for (int octet = 0; octet < 4; octet++) {
+            const unsigned value = (address >> (octet * 8)) & 0xFF;
+            if (value >= 100) out[length++] = static_cast<char>('0' + value / 100);
+            if (value >= 10) out[length++] = static_cast<char>('0' + value / 10 % 10);
+            out[length++] = static_cast<char>('0' + value % 10);
+            out[length++] = '.';
+        }
+        std::copy(SUFFIX, SUFFIX + sizeof(SUFFIX) - 1, out + length);
+        return length + sizeof(SUFFIX) - 1;
+    }
+
+    // PTR query for address into out (MAX_QUERY_SIZE bytes), returns its length. mDNS responders want
+    // recursion_desired clear.
+    inline size_t buildPtrQuery(uint16_t id, uint32_t address, bool recursion_desired, uint8_t* out) {
+        const uint16_t FLAG_RECURSION_DESIRED = 0x0100;
+        const uint16_t TYPE_PTR = 12;
+        const uint16_t CLASS_IN = 1;
+
+        std::fill(out, out + HEADER_SIZE, 0);
+        writeBE16(out, id);
+        writeBE16(out + 2, recursion_desired ? FLAG_RECURSION_DESIRED : 0);
+        writeBE16(out + 4, 1);      // one question
+
+        char name[MAX_QUERY_SIZE];
+        const size_t name_length = reverseName(address, name);
+        size_t position = HEADER_SIZE;
+        size_t label_start = 0;
+        for (size_t i = 0; i <= name_length; i++) {     // dotted text to length-prefixed labels
+            if (i < name_length && name[i] != '.') continue;
+            out[position++] = static_cast<uint8_t>(i - label_start);
+            std::copy(name + label_start, name + i, out + position);
+            position += i - label_start;
+            label_start = i + 1;
+        }
+        out[position++] = 0;
+        writeBE16(out + position, TYPE_PTR);
+        writeBE16(out + position + 2, CLASS_IN);
+        return position + 4;
+    }
+
+    // NetBIOS node status ("NBSTAT") for the wildcard name, into out (MAX_QUERY_SIZE bytes)
+    inline size_t buildNodeStatusQuery(uint16_t id, uint8_t* out) {
+        const uint8_t ENCODED_NAME_LENGTH = 32;     // 16 name bytes, one nibble per character
+        const uint16_t TYPE_NBSTAT = 0x21;
+        const uint16_t CLASS_IN = 1;
+
+        std::fill(out, out + HEADER_SIZE, 0);
+        writeBE16(out, id);
+        writeBE16(out + 4, 1);
+        size_t position = HEADER_SIZE;
+        out[position++] = ENCODED_NAME_LENGTH;
+        for (int i = 0; i < ENCODED_NAME_LENGTH / 2; i++) {    // "*" then 15 NULs, each nibble + 'A'
+            const uint8_t character = (i == 0) ? '*' : 0;
+            out[position++] = static_cast<uint8_t>('A' + (character >> 4));
+            out[position++] = static_cast<uint8_t>('A' + (character & 0x0F));
+        }
+        out[position++] = 0;
+        writeBE16(out + position, TYPE_NBSTAT);
+        writeBE16(out + position + 2, CLASS_IN);
+        return position + 4;
+    }
+
+    inline bool isResponse(const uint8_t* message, size_t length) {
+        const uint16_t FLAG_RESPONSE = 0x8000;
+        return length >= HEADER_SIZE && (readBE16(message + 2) & FLAG_RESPONSE);
+    }
+
+    struct PtrAnswer {
+        uint8_t rcode;
+        bool named;
+        char name[MAX_NAME_LENGTH + 1];
+        size_t name_length;
+        uint32_t ttl;               // of the PTR record, or how long the negative answer may be cached (0: not said)
+    };
+
+    // Reply to a PTR query for address. False when it is not one (wrong question, truncated, mangled);
+    // otherwise answer holds the name, or for a negative reply the SOA-derived negative TTL (RFC 2308)
+    inline bool parsePtrResponse(const uint8_t* message, size_t length, uint32_t address, PtrAnswer& answer) {
+        const uint16_t TYPE_PTR = 12;
+        const uint16_t TYPE_SOA = 6;
+        const uint8_t RCODE_MASK = 0x0F;
+        const size_t RECORD_FIXED_SIZE = 10;    // type, class, ttl, data length
+        const size_t SOA_TIMERS_SIZE = 20;      // serial, refresh, retry, expire, minimum
+
+        if (!isResponse(message, length)) return false;
+        answer.rcode = message[3] & RCODE_MASK;
+        answer.named = false;
+        answer.name_length = 0;
+        answer.ttl = 0;
+
+        // the question has to be ours: a reply for another address is someone else's (or a stale one)
+        const uint16_t question_count = readBE16(message + 4);
+        const uint16_t answer_count = readBE16(message + 6);
+        const uint16_t authority_count = readBE16(message + 8);
+        char expected[MAX_QUERY_SIZE];
+        const size_t expected_length = reverseName(address, expected);
+        char name[MAX_NAME_LENGTH + 1];
+        size_t name_length;
+        size_t position = HEADER_SIZE;
+        if (question_count != 1 || !readDnsName(message, length, position, name, sizeof(name), name_length)) return false;
+        const bool same_question = name_length == expected_length
+            && std::equal(name, name + name_length, expected, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+        if (!same_question || position + 4 > length) return false;
+        position += 4;
+
+        for (uint32_t record = 0; record < static_cast<uint32_t>(answer_count) + authority_count; record++) {
+            if (!readDnsName(message, length, position, name, sizeof(name), name_length)) return false;
+            if (position + RECORD_FIXED_SIZE > length) return false;
+            const uint16_t type = readBE16(message + position);
+            const uint32_t ttl = readBE32(message + position + 4);
+            const size_t data_length = readBE16(message + position + 8);
+            position += RECORD_FIXED_SIZE;
+            if (position + data_length > length) return false;
+
+            if (record < answer_count && type == TYPE_PTR && !answer.named) {
+                size_t target = position;
+                if (readDnsName(message, length, target, answer.name, sizeof(answer.name), answer.name_length) && answer.name_length > 0) {
+                    answer.name[answer.name_length] = '\0';
+                    answer.named = true;
+                    answer.ttl = ttl;
+                }
+            }
+            else if (record >= answer_count && type == TYPE_SOA && !answer.named) {
+                size_t timers = position;
+                size_t skipped;
+                if (readDnsName(message, length, timers, name, sizeof(name), skipped)              // primary server
+                    && readDnsName(message, length, timers, name, sizeof(name), skipped)           // responsible mailbox
+                    && timers + SOA_TIMERS_SIZE <= position + data_length) {
+                    answer.ttl = std::min(ttl, readBE32(message + timers + SOA_TIMERS_SIZE - 4));
+                }
+            }
+            position += data_length;
+        }
+        return true;
+    }
+
+    // Node status reply: the host's own unique workstation name (suffix 0x00), trailing blanks trimmed.
+    // False when the reply is not one, or lists no such name.
+    inline bool parseNodeStatusResponse(const uint8_t* message, size_t length, char* name, size_t name_capacity, size_t& name_length) {
+        const uint16_t TYPE_NBSTAT = 0x21;
+        const size_t RECORD_FIXED_SIZE = 10;
+        const size_t NETBIOS_NAME_SIZE = 15;
+        const size_t NAME_ENTRY_SIZE = 18;      // name, suffix, flags
+        const uint8_t WORKSTATION_SUFFIX = 0x00;
+        const uint16_t GROUP_NAME_FLAG = 0x8000;
+
+        if (!isResponse(message, length) || readBE16(message + 6) == 0) return false;
+        char record_name[MAX_NAME_LENGTH + 1];
+        size_t record_name_length;
+        size_t position = HEADER_SIZE;
+        if (!readDnsName(message, length, position, record_name, sizeof(record_name), record_name_length)) return false;
+        if (position + RECORD_FIXED_SIZE + 1 > length || readBE16(message + position) != TYPE_NBSTAT) return false;
+        position += RECORD_FIXED_SIZE;
+        const uint8_t name_count = message[position++];
+        for (uint8_t entry = 0; entry < name_count && position + NAME_ENTRY_SIZE <= length; entry++, position += NAME_ENTRY_SIZE) {
+            const uint8_t suffix = message[position + NETBIOS_NAME_SIZE];
+            const uint16_t flags = readBE16(message + position + NETBIOS_NAME_SIZE + 1);
+            if (suffix != WORKSTATION_SUFFIX || (flags & GROUP_NAME_FLAG)) continue;
+            name_length = std::min(NETBIOS_NAME_SIZE, name_capacity - 1);
+            std::copy(message + position, message + position + name_length, name);
+            while (name_length > 0 && name[name_length - 1] == ' ') name_length--;
+            name[name_length] = '\0';
+            return name_length > 0;
+        }
+        return false;
+    }
+
+}
+
+#endif // DNS_UTIL_H
@@ -0,0 +1,127 @@
+#ifndef ENIP_UTIL_H
+#define ENIP_UTIL_H
+
+#include <cstdint>
+#include <string>
+
+// EtherNet/IP encapsulation helpers for the unconnected UDP commands (ListIdentity).
+// Encapsulation fields are little-endian; the socket address item inside a reply is big-endian.
+namespace enipUtil {
+
+    constexpr uint16_t ENIP_PORT = 44818;
+    constexpr uint16_t COMMAND_LIST_IDENTITY = 0x0063;
+    constexpr uint16_t ITEM_IDENTITY = 0x000C;
+    constexpr size_t HEADER_SIZE = 24;
+
+    struct IdentityRecord {
+        uint16_t vendor_id;
+        uint16_t device_type;
+        uint16_t product_code;
+        uint8_t revision_major;
+        uint8_t revision_minor;
+        uint16_t status;
+        uint32_t serial_number;
+        std::string product_name;
+        uint8_t state;
+        uint32_t socket_address;    // address the device reports for itself, may differ from the sender behind NAT
+    };
+
+    inline uint16_t readU16(const std::string& data, size_t position) {
+        return static_cast<uint16_t>(static_cast<uint8_t>(data[position]) | (static_cast<uint8_t>(data[position + 1]) << 8));
+    }
+
+    inline uint32_t readU32(const std::string& data, size_t position) {
+        return static_cast<uint32_t>(readU16(data, position)) | (static_cast<uint32_t>(readU16(data, position + 2)) << 16);
+    }
+
+    // 24-byte header, no session, no payload. sender_context is echoed back by the device.
+    inline std::string buildListIdentity(uint64_t sender_context = 0) {
+        std::string packet(HEADER_SIZE, '\0');
+        packet[0] = static_cast<char>(COMMAND_LIST_IDENTITY & 0xFF);
+        packet[1] = static_cast<char>(COMMAND_LIST_IDENTITY >> 8);
+        const size_t SENDER_CONTEXT_OFFSET = 12;
+        for (int i = 0; i < 8; i++) {
+            packet[SENDER_CONTEXT_OFFSET + i] = static_cast<char>((sender_context >> (i * 8)) & 0xFF);
+        }
+        return packet;
+    }
+
+    // Parse a ListIdentity reply. Only the first CIP identity item is used; devices send one.
+    inline bool parseListIdentity(const std::string& packet, IdentityRecord& record) {
+        const size_t STATUS_OFFSET = 8;
+        if (packet.size() < HEADER_SIZE + 2) return false;
+        if (readU16(packet, 0) != COMMAND_LIST_IDENTITY || readU32(packet, STATUS_OFFSET) != 0) return false;
+
+        size_t position = HEADER_SIZE;
+        const uint16_t item_count = readU16(packet, position);
+        position += 2;
+        for (uint16_t item = 0; item < item_count; item++) {
+            if (position + 4 > packet.size()) return false;
+            const uint16_t item_type = readU16(packet, position);
+            const uint16_t item_length = readU16(packet, position + 2);
+            position += 4;
+            if (position + item_length > packet.size()) return false;
+            if (item_type != ITEM_IDENTITY) {
+                position += item_length;
+                continue;
+            }
+
+            // protocol version(2) socket address(16) vendor(2) type(2) product(2) revision(2) status(2) serial(4) name length(1)
+            const size_t FIXED_PART = 33;
+            if (item_length < FIXED_PART) return false;
+            size_t field = position + 2;
+            const size_t SIN_ADDR_OFFSET = 4;
+            record.socket_address = (static_cast<uint32_t>(static_cast<uint8_t>(packet[field + SIN_ADDR_OFFSET])) << 24)
+                                  | (static_cast<uint32_t>(static_cast<uint8_t>(packet[field + SIN_ADDR_OFFSET + 1])) << 16)
+                                  | (static_cast<uint32_t>(static_cast<uint8_t>(packet[field + SIN_ADDR_OFFSET + 2])) << 8)
+                                  | static_cast<uint32_t>(static_cast<uint8_t>(packet[field + SIN_ADDR_OFFSET + 3]));
+            field += 16;
+            record.vendor_id = readU16(packet, field);
+            record.device_type = readU16(packet, field + 2);
+            record.product_code = readU16(packet, field + 4);
+            record.revision_major = static_cast<uint8_t>(packet[field + 6]);
+            record.revision_minor = static_cast<uint8_t>(packet[field + 7]);
+            record.status = readU16(packet, field + 8);
+            record.serial_number = readU32(packet, field + 10);
+            const size_t name_length = static_cast<uint8_t>(packet[field + 14]);
+            field += 15;
+            if (field + name_length > position + item_length) return false;
+            record.product_name = packet.substr(field, name_length);
+            field += name_length;
+            record.state = (field < position + item_length) ? static_cast<uint8_t>(packet[field]) : 0xFF;
+            return true;
+        }
+        return false;
+    }
+
+    // Vendors most often found on a plant floor; the full ODVA list is much longer
+    inline const char* vendorName(uint16_t vendor_id) {
+        switch (vendor_id) {
+            case 1:     return "Rockwell Automation/Allen-Bradley";
+            case 40:    return "WAGO";
+            case 47:    return "Omron";
+            case 90:    return "HMS Industrial Networks";
+            case 243:   return "Schneider Electric";
+            case 283:   return "Hilscher";
+            case 808:   return "SICK";
+            case 991:   return "Moxa";
+            default:    return "Unknown vendor";
+        }
+    }
+
+    inline const char* deviceTypeName(uint16_t device_type) {
+        switch (device_type) {
+            case 0x00:  return "Generic Device";
+            case 0x02:  return "AC Drive";
+            case 0x07:  return "General Purpose Discrete I/O";
+            case 0x0C:  return "Communications Adapter";
+            case 0x0E:  return "Programmable Logic Controller";
+            case 0x18:  return "Human-Machine Interface";
+            case 0x2B:  return "Generic Device (keyable)";
+            default:    return "Other";
+        }
+    }
+
+}
+
+#endif // ENIP_UTIL_H
@@ -0,0 +1,132 @@
+#ifndef MEMORY_UTIL_H
+#define MEMORY_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Scratch memory for the sweep engines. Each scan owns an Arena for its probe slots, reply buffers and
+// bookkeeping arrays and resets it before the next scan, so the probe loop itself never touches the heap.
+namespace memoryUtil {
+
+    // Bump allocator over a list of blocks. Memory is handed out in order and only reclaimed all at once
+    // by reset(); nothing is destroyed, so only trivially destructible types may live here.
+    class Arena {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : m_block_size(block_size), m_current(0), m_offset(0) {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(size_t bytes, size_t alignment) {
+            while (m_current < m_blocks.size()) {
+                const uintptr_t base = reinterpret_cast<uintptr_t>(m_blocks[m_current].memory.get());
+                const size_t aligned = ((base + m_offset + alignment - 1) & ~(uintptr_t{alignment} - 1)) - base;
+                if (aligned + bytes <= m_blocks[m_current].size) {
+                    m_offset = aligned + bytes;
+                    return m_blocks[m_current].memory.get() + aligned;
+                }
+                m_current++;
+                m_offset = 0;
+            }
+            const size_t size = (bytes + alignment > m_block_size) ? bytes + alignment : m_block_size;
+            m_blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+            m_current = m_blocks.size() - 1;
+            m_offset = 0;
+            return allocate(bytes, alignment);
+        }
+
+        // count value-initialised T, contiguous
+        template <typename T>
+        T* allocateArray(size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without running destructors");
+            T* items = static_cast<T*>(allocate(sizeof(T) * (count ? count : 1), alignof(T)));
+            for (size_t i = 0; i < count; i++) new (items + i) T();
+            return items;
+        }
+
+        // Everything handed out so far becomes invalid. A scan that spilled into several blocks gets them
+        // merged into one, so repeating the same scan afterwards allocates nothing.
+        void reset() {
+            if (m_blocks.size() > 1) {
+                size_t total = 0;
+                for (const Block& block : m_blocks) total += block.size;
+                m_blocks.clear();
+                m_blocks.push_back({std::unique_ptr<char[]>(new char[total]), total});
+            }
+            m_current = 0;
+            m_offset = 0;
+        }
+
+    private:
+        struct Block {
+            std::unique_ptr<char[]> memory;
+            size_t size;
+        };
+
+        size_t m_block_size;
+        std::vector<Block> m_blocks;
+        size_t m_current;       // block being bumped
+        size_t m_offset;        // first free byte in it
+    };
+
+    // First-in first-out queue on a power-of-two ring that only grows. std::deque allocates as it moves
+    // (per element on MSVC for anything over 8 bytes); this reaches its peak size once and then stays put.
+    template <typename T>
+    class RingQueue {
+    public:
+        RingQueue() : m_head(0), m_count(0) {}
+
+        bool empty() const { return m_count == 0; }
+        size_t size() const { return m_count; }
+        T& front() { return m_items[m_head]; }
+
+        void push_back(const T& item) {
+            if (m_count == m_items.size()) grow();
+            m_items[(m_head + m_count) & (m_items.size() - 1)] = item;
+            m_count++;
+        }
+
+        void pop_front() {
+            m_head = (m_head + 1) & (m_items.size() - 1);
+            m_count--;
+        }
+
+        void reserve(size_t capacity) {
+            while (m_items.size() < capacity) grow();
+        }
+
+    private:
+        std::vector<T> m_items;
+        size_t m_head;
+        size_t m_count;
+
+        void grow() {
+            const size_t MIN_CAPACITY = 16;
+            std::vector<T> items(m_items.empty() ? MIN_CAPACITY : m_items.size() * 2);
+            for (size_t i = 0; i < m_count; i++) {
+                items[i] = m_items[(m_head + i) & (m_items.size() - 1)];
+            }
+            m_items.swap(items);
+            m_head = 0;
+        }
+    };
+
+    // Allocation-counting hook for checking the hot paths. Building with COUNT_HEAP_ALLOCATIONS defined
+    // replaces global operator new (AllocationCounter.cpp) and the sweeps report how many allocations
+    // their probe loop made; without it the count is always 0 and the report is skipped.
+#ifdef COUNT_HEAP_ALLOCATIONS
+    constexpr bool COUNTING_ALLOCATIONS = true;
+#else
+    constexpr bool COUNTING_ALLOCATIONS = false;
+#endif
+    size_t heapAllocations();
+
+}
+
+#endif // MEMORY_UTIL_H
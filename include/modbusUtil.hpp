@@ -0,0 +1,135 @@
+#ifndef MODBUS_UTIL_H
+#define MODBUS_UTIL_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Modbus TCP framing (MBAP header, big-endian) and the Read Device Identification
+// function (FC 43 / MEI type 14). Byte buffers are std::string like the other protocol helpers.
+namespace modbusUtil {
+
+    constexpr uint16_t MODBUS_PORT = 502;
+    constexpr size_t MBAP_HEADER_SIZE = 7;     // transaction(2) protocol(2) length(2) unit(1)
+    constexpr uint8_t FUNCTION_ENCAPSULATED = 0x2B;
+    constexpr uint8_t MEI_READ_DEVICE_ID = 0x0E;
+    constexpr uint8_t EXCEPTION_FLAG = 0x80;
+
+    enum ReadDeviceIdCode : uint8_t { ReadBasic = 0x01, ReadRegular = 0x02, ReadExtended = 0x03, ReadSpecific = 0x04 };
+
+    // Basic and regular identification objects
+    constexpr uint8_t OBJECT_VENDOR_NAME = 0x00;
+    constexpr uint8_t OBJECT_PRODUCT_CODE = 0x01;
+    constexpr uint8_t OBJECT_REVISION = 0x02;
+    constexpr uint8_t OBJECT_VENDOR_URL = 0x03;
+    constexpr uint8_t OBJECT_PRODUCT_NAME = 0x04;
+    constexpr uint8_t OBJECT_MODEL_NAME = 0x05;
+
+    struct Frame {
+        uint16_t transaction_id;
+        uint8_t unit_id;
+        std::string pdu;    // function code onwards
+    };
+
+    struct DeviceIdentification {
+        uint8_t conformity_level;
+        bool more_follows;
+        uint8_t next_object_id;
+        std::map<uint8_t, std::string> objects;
+    };
+
+    inline void appendU16(std::string& out, uint16_t value) {
+        out += static_cast<char>(value >> 8);
+        out += static_cast<char>(value & 0xFF);
+    }
+
+    inline uint16_t readU16(const std::string& data, size_t position) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(data[position]) << 8) | static_cast<uint8_t>(data[position + 1]));
+    }
+
+    inline std::string buildADU(uint16_t transaction_id, uint8_t unit_id, const std::string& pdu) {
+        const uint16_t PROTOCOL_MODBUS = 0;
+        std::string adu;
+        appendU16(adu, transaction_id);
+        appendU16(adu, PROTOCOL_MODBUS);
+        appendU16(adu, static_cast<uint16_t>(pdu.size() + 1));  // unit id counts toward the length
+        adu += static_cast<char>(unit_id);
+        adu += pdu;
+        return adu;
+    }
+
+    inline std::string buildReadDeviceId(uint16_t transaction_id, uint8_t unit_id, uint8_t read_code, uint8_t object_id) {
+        std::string pdu;
+        pdu += static_cast<char>(FUNCTION_ENCAPSULATED);
+        pdu += static_cast<char>(MEI_READ_DEVICE_ID);
+        pdu += static_cast<char>(read_code);
+        pdu += static_cast<char>(object_id);
+        return buildADU(transaction_id, unit_id, pdu);
+    }
+
+    // Take one complete ADU off the front of a TCP stream. False when more bytes are needed;
+    // a corrupt header clears the stream since framing cannot be recovered.
+    inline bool popFrame(std::string& stream, Frame& frame) {
+        if (stream.size() < MBAP_HEADER_SIZE) return false;
+        const uint16_t length = readU16(stream, 4);
+        const uint16_t MAX_ADU_LENGTH = 254;    // unit id + 253-byte PDU
+        if (readU16(stream, 2) != 0 || length < 2 || length > MAX_ADU_LENGTH) {
+            stream.clear();
+            return false;
+        }
+        const size_t frame_size = MBAP_HEADER_SIZE - 1 + length;
+        if (stream.size() < frame_size) return false;
+        frame.transaction_id = readU16(stream, 0);
+        frame.unit_id = static_cast<uint8_t>(stream[6]);
+        frame.pdu.assign(stream, MBAP_HEADER_SIZE, frame_size - MBAP_HEADER_SIZE);
+        stream.erase(0, frame_size);
+        return true;
+    }
+
+    // Parse a Read Device Identification response PDU. On a Modbus exception returns false
+    // with exception_code set; on a malformed reply returns false with exception_code 0.
+    inline bool parseDeviceIdentification(const std::string& pdu, DeviceIdentification& identification, uint8_t& exception_code) {
+        exception_code = 0;
+        if (pdu.size() >= 2 && static_cast<uint8_t>(pdu[0]) == (FUNCTION_ENCAPSULATED | EXCEPTION_FLAG)) {
+            exception_code = static_cast<uint8_t>(pdu[1]);
+            return false;
+        }
+        const size_t HEADER_LENGTH = 7;     // function, MEI type, read code, conformity, more follows, next id, count
+        if (pdu.size() < HEADER_LENGTH || static_cast<uint8_t>(pdu[0]) != FUNCTION_ENCAPSULATED
+            || static_cast<uint8_t>(pdu[1]) != MEI_READ_DEVICE_ID) {
+            return false;
+        }
+        identification.conformity_level = static_cast<uint8_t>(pdu[3]);
+        identification.more_follows = static_cast<uint8_t>(pdu[4]) == 0xFF;
+        identification.next_object_id = static_cast<uint8_t>(pdu[5]);
+        const uint8_t object_count = static_cast<uint8_t>(pdu[6]);
+
+        size_t position = HEADER_LENGTH;
+        for (uint8_t i = 0; i < object_count; i++) {
+            if (position + 2 > pdu.size()) return false;
+            const uint8_t object_id = static_cast<uint8_t>(pdu[position]);
+            const size_t object_length = static_cast<uint8_t>(pdu[position + 1]);
+            position += 2;
+            if (position + object_length > pdu.size()) return false;
+            identification.objects[object_id] = pdu.substr(position, object_length);
+            position += object_length;
+        }
+        return true;
+    }
+
+    inline const char* exceptionName(uint8_t exception_code) {
+        switch (exception_code) {
+            case 0x01:  return "Illegal Function";
+            case 0x02:  return "Illegal Data Address";
+            case 0x03:  return "Illegal Data Value";
+            case 0x04:  return "Server Device Failure";
+            case 0x06:  return "Server Device Busy";
+            case 0x0A:  return "Gateway Path Unavailable";
+            case 0x0B:  return "Gateway Target Failed To Respond";
+            default:    return "Exception";
+        }
+    }
+
+}
+
+#endif // MODBUS_UTIL_H
@@ -0,0 +1,188 @@
+#ifndef NEIGHBOR_UTIL_H
+#define NEIGHBOR_UTIL_H
+
+#include <cstdint>
+#include <vector>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <iphlpapi.h>
+#include "netUtil.hpp"
+
+#pragma comment(lib, "iphlpapi.lib")
+
+// Local interfaces and the kernel's neighbor cache (ARP for IPv4, Neighbor Discovery for IPv6), for
+// discovery on directly attached subnets
+namespace neighborUtil {
+
+    struct OnLinkInterface {
+        NET_IFINDEX index;
+        uint32_t address;       // host order, like the rest of the scanners
+        uint32_t mask;
+    };
+
+    // True when network/mask lies entirely inside the subnet of a local IPv4 interface, so every address
+    // in it can be reached (and must answer ARP) without a router. Loopback is never on-link.
+    inline bool findOnLinkInterface(uint32_t network, uint32_t mask, OnLinkInterface& found) {
+        const uint32_t LOOPBACK_NETWORK = 0x7F000000;
+        const uint32_t LOOPBACK_MASK = 0xFF000000;
+
+        ULONG table_size = 0;
+        std::vector<uint8_t> buffer;
+        DWORD result = ERROR_INSUFFICIENT_BUFFER;
+        while (result == ERROR_INSUFFICIENT_BUFFER) {   // the table can grow between the two calls
+            buffer.resize(table_size > 0 ? table_size : sizeof(MIB_IPADDRTABLE));
+            table_size = static_cast<ULONG>(buffer.size());
+            result = GetIpAddrTable(reinterpret_cast<PMIB_IPADDRTABLE>(buffer.data()), &table_size, FALSE);
+        }
+        if (result != NO_ERROR) return false;
+
+        const MIB_IPADDRTABLE* table = reinterpret_cast<const MIB_IPADDRTABLE*>(buffer.data());
+        for (DWORD i = 0; i < table->dwNumEntries; i++) {
+            const MIB_IPADDRROW& row = table->table[i];
+            const uint32_t address = ntohl(row.dwAddr);
+            const uint32_t interface_mask = ntohl(row.dwMask);
+            if (address == 0 || (address & LOOPBACK_MASK) == LOOPBACK_NETWORK) continue;
+            const bool inside = (mask & interface_mask) == interface_mask        // target prefix at least as long
+                                && (network & interface_mask) == (address & interface_mask);
+            if (inside) {
+                found = {row.dwIndex, address, interface_mask};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct Neighbor {
+        uint32_t address;
+        uint64_t mac;
+        bool confirmed;     // reachable right now; otherwise a stale cache entry the kernel is re-probing
+    };
+
+    // Appends the IPv4 neighbors on one interface with first <= address <= last that have a MAC. Entries
+    // still resolving, or that failed to, are left out.
+    inline bool readNeighbors(NET_IFINDEX interface_index, uint32_t first, uint32_t last, std::vector<Neighbor>& neighbors) {
+        const ULONG MAC_LENGTH = 6;
+
+        PMIB_IPNET_TABLE2 table = nullptr;
+        if (GetIpNetTable2(AF_INET, &table) != NO_ERROR) return false;
+        for (ULONG i = 0; i < table->NumEntries; i++) {
+            const MIB_IPNET_ROW2& row = table->Table[i];
+            if (row.InterfaceIndex != interface_index || row.PhysicalAddressLength != MAC_LENGTH) continue;
+            if (row.State == NlnsUnreachable || row.State == NlnsIncomplete) continue;
+            const uint32_t address = ntohl(row.Address.Ipv4.sin_addr.s_addr);
+            if (address < first || address > last) continue;
+
+            uint64_t mac = 0;
+            for (ULONG octet = 0; octet < MAC_LENGTH; octet++) mac = (mac << 8) | row.PhysicalAddress[octet];
+            neighbors.push_back({address, mac, row.State == NlnsReachable || row.State == NlnsPermanent});
+        }
+        FreeMibTable(table);
+        return true;
+    }
+
+    // Drops one IPv4 neighbor cache entry so the next packet to the address sends a fresh who-has. A stale
+    // entry would be used as it is and only re-probed after the Delay state's 5 s (RFC 4861
+    // DELAY_FIRST_PROBE_TIME). Needs administrator rights; an address with no entry counts as flushed.
+    inline bool flushNeighbor(NET_IFINDEX interface_index, uint32_t address) {
+        MIB_IPNET_ROW2 row = {};
+        row.InterfaceIndex = interface_index;
+        row.Address.Ipv4.sin_family = AF_INET;
+        row.Address.Ipv4.sin_addr.s_addr = htonl(address);
+        const DWORD result = DeleteIpNetEntry2(&row);
+        return result == NO_ERROR || result == ERROR_NOT_FOUND;
+    }
+
+
+    struct OnLinkInterface6 {
+        NET_IFINDEX index;
+        netUtil::IPv6Address link_local;    // every interface has one, and every node on the link answers it
+        netUtil::IPv6Address address;       // an address of ours inside the target prefix, when there is one
+        bool has_address;
+    };
+
+    // True when network/prefix_length lies inside the on-link prefix of a local IPv6 address, so its hosts
+    // share a link with us and can be reached by link-scope multicast. Loopback is never on-link, and
+    // addresses still in duplicate address detection are not usable as a source.
+    inline bool findOnLinkInterface6(const netUtil::IPv6Address& network, int prefix_length, OnLinkInterface6& found) {
+        const netUtil::IPv6Address LOOPBACK = {0, 1};
+
+        PMIB_UNICASTIPADDRESS_TABLE table = nullptr;
+        if (GetUnicastIpAddressTable(AF_INET6, &table) != NO_ERROR) return false;
+        bool matched = false;
+        for (ULONG i = 0; i < table->NumEntries && !matched; i++) {
+            const MIB_UNICASTIPADDRESS_ROW& row = table->Table[i];
+            const netUtil::IPv6Address address = netUtil::in6_to_bits(row.Address.Ipv6.sin6_addr);
+            if (address == LOOPBACK || row.DadState != IpDadStatePreferred) continue;
+            const int on_link_prefix = row.OnLinkPrefixLength;
+            if (prefix_length < on_link_prefix || !netUtil::in_prefix6(network, address, on_link_prefix)) continue;
+            found = {row.InterfaceIndex, {0, 0}, address, true};
+            matched = true;
+        }
+        // the same interface's link-local address is the source every neighbor answers
+        for (ULONG i = 0; i < table->NumEntries && matched; i++) {
+            const MIB_UNICASTIPADDRESS_ROW& row = table->Table[i];
+            const netUtil::IPv6Address address = netUtil::in6_to_bits(row.Address.Ipv6.sin6_addr);
+            if (row.InterfaceIndex != found.index || !netUtil::isLinkLocal6(address)) continue;
+            if (row.DadState != IpDadStatePreferred) continue;
+            found.link_local = address;
+            break;
+        }
+        FreeMibTable(table);
+        if (matched && netUtil::isLinkLocal6(found.address)) found.has_address = false;
+        return matched && found.link_local != netUtil::IPv6Address{0, 0};
+    }
+
+    // Gives link-local hosts without a zone the interface IPv6 discovery would use for them, false when no
+    // interface has a link-local address. Hosts that already carry a zone keep it.
+    inline bool assignZones(std::vector<netUtil::IPv6Host>& hosts) {
+        OnLinkInterface6 on_link;
+        bool looked_up = false;
+        for (netUtil::IPv6Host& host : hosts) {
+            if (host.scope_id != 0 || !netUtil::isLinkLocal6(host.address)) continue;
+            if (!looked_up && !findOnLinkInterface6(host.address, netUtil::IPV6_BITS, on_link)) return false;
+            looked_up = true;
+            host.scope_id = on_link.index;
+        }
+        return true;
+    }
+
+    struct Neighbor6 {
+        netUtil::IPv6Address address;
+        uint64_t mac;
+        bool confirmed;
+    };
+
+    // IPv6 counterpart of readNeighbors, for the addresses inside network/prefix_length
+    inline bool readNeighbors6(NET_IFINDEX interface_index, const netUtil::IPv6Address& network, int prefix_length, std::vector<Neighbor6>& neighbors) {
+        const ULONG MAC_LENGTH = 6;
+
+        PMIB_IPNET_TABLE2 table = nullptr;
+        if (GetIpNetTable2(AF_INET6, &table) != NO_ERROR) return false;
+        for (ULONG i = 0; i < table->NumEntries; i++) {
+            const MIB_IPNET_ROW2& row = table->Table[i];
+            if (row.InterfaceIndex != interface_index || row.PhysicalAddressLength != MAC_LENGTH) continue;
+            if (row.State == NlnsUnreachable || row.State == NlnsIncomplete) continue;
+            const netUtil::IPv6Address address = netUtil::in6_to_bits(row.Address.Ipv6.sin6_addr);
+            if (!netUtil::in_prefix6(address, network, prefix_length)) continue;
+
+            uint64_t mac = 0;
+            for (ULONG octet = 0; octet < MAC_LENGTH; octet++) mac = (mac << 8) | row.PhysicalAddress[octet];
+            neighbors.push_back({address, mac, row.State == NlnsReachable || row.State == NlnsPermanent});
+        }
+        FreeMibTable(table);
+        return true;
+    }
+
+    // IPv6 counterpart of flushNeighbor: the next packet sends a fresh Neighbor Solicitation
+    inline bool flushNeighbor6(NET_IFINDEX interface_index, const netUtil::IPv6Address& address) {
+        MIB_IPNET_ROW2 row = {};
+        row.InterfaceIndex = interface_index;
+        row.Address.Ipv6.sin6_family = AF_INET6;
+        row.Address.Ipv6.sin6_addr = netUtil::bits_to_in6(address);
+        const DWORD result = DeleteIpNetEntry2(&row);
+        return result == NO_ERROR || result == ERROR_NOT_FOUND;
+    }
+
+}
+
+#endif // NEIGHBOR_UTIL_H
@@ -5,58 +5,262 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <vector>
 #include <sstream>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+// The vector IPv4 parser needs SSSE3 (pshufb). Every x86 build compiles it, GCC/Clang through a target
+// attribute on that one function so the build flags stay as they are, and parseIPv4 takes it only when
+// the CPU reports SSSE3. Other architectures get the scalar parser.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NET_UTIL_SSSE3
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define NET_UTIL_TARGET_SSSE3
+#else
+#define NET_UTIL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
 
 namespace netUtil {
 
-    // Validate IPv4 address format using inet_pton
-    inline bool isValidIPv4(const std::string& ip) {
-        struct sockaddr_in sa;
-        return inet_pton(AF_INET, ip.c_str(), &sa.sin_addr) == 1;
+    constexpr int IPV4_OCTETS = 4;
+    constexpr int IPV4_BITS = 32;
+    constexpr size_t IPV4_TEXT_MAX = 15;        // "255.255.255.255"
+    constexpr size_t IPV4_PARSE_LOOKAHEAD = 16; // bytes the vector parser reads, whatever the address length
+
+    // True when parseIPv4 takes the SSSE3 path on this machine; the CPU is asked once
+    inline bool ipv4VectorParse() {
+#ifdef NET_UTIL_SSSE3
+        static const bool SUPPORTED = [] {
+#ifdef _MSC_VER
+            int registers[4];
+            __cpuid(registers, 1);
+            return (registers[2] & (1 << 9)) != 0;     // CPUID.1:ECX bit 9
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3") != 0;
+#endif
+        }();
+        return SUPPORTED;
+#else
+        return false;
+#endif
     }
 
-    // Validate port number is in valid range
-    inline bool isValidPort(int port) {
-        return port >= 1 && port <= 65535;
+    inline bool isDigit(char c) {
+        return static_cast<unsigned>(c - '0') < 10;
     }
-    inline bool isValidPort(std::string port){
-        int port_num = stoi(port);
-        return port_num >= 1 && port_num <= 65535;
+
+    // Mask with the top bits set; bits outside 0..32 are the caller's problem
+    inline uint32_t bits_to_mask(int bits) {
+        return bits == 0 ? 0 : UINT32_MAX << (IPV4_BITS - bits);   // a 32 bit shift is undefined
     }
 
-    // Validate CIDR notation (e.g., 192.168.1.0/24)
-    inline bool isValidCIDR(const std::string& cidr) {
-        // Check for exactly one slash
-        size_t slash_count = std::count(cidr.begin(), cidr.end(), '/');
-        size_t backslash_count = std::count(cidr.begin(), cidr.end(), '\\');
+    // Dotted quad at the start of [first, last) into ip (host order), std::from_chars style: returns where
+    // the address ends, or nullptr. Octets are 1-3 digits, no leading zeros, and the address must not run
+    // on into another digit or dot - the same text inet_pton accepts.
+    inline const char* parseIPv4Scalar(const char* first, const char* last, uint32_t& ip) {
+        const int MAX_OCTET_DIGITS = 3;
+        const unsigned MAX_OCTET = 255;
+        uint32_t result = 0;
+        for (int octet = 0; octet < IPV4_OCTETS; octet++) {
+            if (octet > 0) {
+                if (first == last || *first != '.') return nullptr;
+                first++;
+            }
+            const char* start = first;
+            unsigned value = 0;
+            while (first != last && first - start < MAX_OCTET_DIGITS && isDigit(*first)) {
+                value = value * 10 + static_cast<unsigned>(*first - '0');
+                first++;
+            }
+            const ptrdiff_t length = first - start;
+            if (length == 0 || value > MAX_OCTET || (length > 1 && *start == '0')) return nullptr;
+            result = (result << 8) | value;
+        }
+        if (first != last && (*first == '.' || isDigit(*first))) return nullptr;
+        ip = result;
+        return first;
+    }
 
-        if (slash_count + backslash_count != 1) {
-            return false;
+#ifdef NET_UTIL_SSSE3
+    namespace detail {
+        inline unsigned countTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, value);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(value));
+#endif
         }
 
-        // Find delimiter position
-        size_t delimiter_pos = cidr.find('/');
-        if (delimiter_pos == std::string::npos) {
-            delimiter_pos = cidr.find('\\');
+        constexpr size_t OCTET_LENGTH_PATTERNS = 81;    // 1-3 digits in each of 4 octets
+        using ShuffleTable = std::array<std::array<uint8_t, 16>, OCTET_LENGTH_PATTERNS>;
+
+        // For each combination of octet lengths, the pshufb control that right-aligns octet i's digits into
+        // bytes 4i..4i+2 (hundreds, tens, ones) and zeroes everything else
+        constexpr ShuffleTable buildOctetShuffles() {
+            const uint8_t ZERO_FILL = 0x80;
+            ShuffleTable table{};
+            for (size_t pattern = 0; pattern < OCTET_LENGTH_PATTERNS; pattern++) {
+                size_t lengths[IPV4_OCTETS] = { pattern / 27 + 1, pattern / 9 % 3 + 1, pattern / 3 % 3 + 1, pattern % 3 + 1 };
+                size_t start = 0;
+                for (size_t octet = 0; octet < IPV4_OCTETS; octet++) {
+                    for (size_t digit = 0; digit < 4; digit++) {
+                        const size_t from_end = 2 - digit;      // ones digit sits in byte 2 of the lane
+                        table[pattern][octet * 4 + digit] = (digit < 3 && from_end < lengths[octet])
+                            ? static_cast<uint8_t>(start + lengths[octet] - 1 - from_end) : ZERO_FILL;
+                    }
+                    start += lengths[octet] + 1;
+                }
+            }
+            return table;
         }
 
-        // Extract IP and mask parts
-        std::string ip_part = cidr.substr(0, delimiter_pos);
-        std::string mask_part = cidr.substr(delimiter_pos + 1);
+        inline constexpr ShuffleTable OCTET_SHUFFLES = buildOctetShuffles();
+    }
 
-        // Validate IP portion
-        if (!isValidIPv4(ip_part)) {
-            return false;
+    // SSSE3 dotted-quad parser: classifies all 16 bytes at once, finds the octet lengths from the digit mask,
+    // then one shuffle lines the digits up and two multiply-adds turn them into four octet values. Reads
+    // IPV4_PARSE_LOOKAHEAD bytes from first whatever the address length; same contract as parseIPv4Scalar.
+    NET_UTIL_TARGET_SSSE3 inline const char* parseIPv4Vector(const char* first, uint32_t& ip) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const __m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+        const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+        const uint32_t non_digit_mask = ~static_cast<uint32_t>(_mm_movemask_epi8(is_digit));
+        const uint32_t dot_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(input, _mm_set1_epi8('.'))));
+
+        const unsigned MAX_OCTET_DIGITS = 3;
+        unsigned position = 0;
+        unsigned pattern = 0;
+        for (int octet = 0; octet < IPV4_OCTETS; octet++) {
+            if (octet > 0) {
+                if (!((dot_mask >> position) & 1)) return nullptr;
+                position++;
+            }
+            const unsigned length = detail::countTrailingZeros(non_digit_mask >> position);
+            if (length == 0 || length > MAX_OCTET_DIGITS || (length > 1 && first[position] == '0')) return nullptr;
+            pattern = pattern * MAX_OCTET_DIGITS + length - 1;
+            position += length;
         }
+        if ((dot_mask >> position) & 1) return nullptr;     // the digit run already ended, so only a dot can follow
 
-        // Validate mask is a number between 0 and 32
-        try {
-            int mask = std::stoi(mask_part);
-            return mask >= 0 && mask <= 32;
-        } catch (...) {
-            return false;
+        const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(detail::OCTET_SHUFFLES[pattern].data()));
+        const __m128i aligned = _mm_shuffle_epi8(digits, shuffle);
+        const __m128i pairs = _mm_maddubs_epi16(aligned, _mm_setr_epi8(100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0));
+        const __m128i octets = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi32(octets, _mm_set1_epi32(255)))) return nullptr;
+
+        const __m128i packed = _mm_shuffle_epi8(octets, _mm_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+        ip = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+        return first + position;
+    }
+#endif
+
+    // Picks the vector parser when the CPU has SSSE3 and it can read ahead safely, the scalar one otherwise
+    inline const char* parseIPv4(const char* first, const char* last, uint32_t& ip) {
+#ifdef NET_UTIL_SSSE3
+        if (static_cast<size_t>(last - first) >= IPV4_PARSE_LOOKAHEAD && ipv4VectorParse()) return parseIPv4Vector(first, ip);
+#endif
+        return parseIPv4Scalar(first, last, ip);
+    }
+
+    namespace detail {
+        struct OctetText {
+            char text[4];           // digits then '.', so a dotted quad is four fixed-size copies
+            uint8_t length;         // digits only
+        };
+
+        constexpr std::array<OctetText, 256> buildOctetTexts() {
+            std::array<OctetText, 256> table{};
+            for (unsigned value = 0; value < table.size(); value++) {
+                OctetText& entry = table[value];
+                uint8_t length = 0;
+                if (value >= 100) entry.text[length++] = static_cast<char>('0' + value / 100);
+                if (value >= 10) entry.text[length++] = static_cast<char>('0' + value / 10 % 10);
+                entry.text[length++] = static_cast<char>('0' + value % 10);
+                entry.text[length] = '.';
+                entry.length = length;
+            }
+            return table;
+        }
+
+        inline constexpr std::array<OctetText, 256> OCTET_TEXTS = buildOctetTexts();
+    }
+
+    // ip as dotted quad into [first, last), std::to_chars style: returns the end of the text, or nullptr
+    // when it does not fit. Not NUL terminated. Given IPV4_TEXT_MAX + 1 bytes of room it skips the length
+    // checks and copies each octet as one 4 byte block.
+    inline char* formatIPv4(char* first, char* last, uint32_t ip) {
+        const size_t OCTET_BLOCK = sizeof(detail::OctetText::text);
+        const size_t room = static_cast<size_t>(last - first);
+        if (room > IPV4_TEXT_MAX) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                const detail::OctetText& octet = detail::OCTET_TEXTS[(ip >> shift) & 0xFF];
+                std::memcpy(first, octet.text, OCTET_BLOCK);
+                first += octet.length + 1;
+            }
+            return first - 1;       // the last octet's dot is past the end
         }
+
+        size_t length = IPV4_OCTETS - 1;
+        for (int shift = 24; shift >= 0; shift -= 8) length += detail::OCTET_TEXTS[(ip >> shift) & 0xFF].length;
+        if (length > room) return nullptr;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            const detail::OctetText& octet = detail::OCTET_TEXTS[(ip >> shift) & 0xFF];
+            const size_t copied = octet.length + (shift > 0 ? 1 : 0);
+            std::memcpy(first, octet.text, copied);
+            first += copied;
+        }
+        return first;
+    }
+
+    // "<ip>" or "<ip>/<bits>" (or backslash) into address and mask; a bare address gets a /32 mask
+    inline bool parseCIDR4(const std::string& target, uint32_t& ip, uint32_t& mask) {
+        const char* last = target.data() + target.size();
+        const char* position = parseIPv4(target.data(), last, ip);
+        if (position == nullptr) return false;
+        if (position == last) {
+            mask = UINT32_MAX;
+            return true;
+        }
+        if (*position != '/' && *position != '\\') return false;
+        int bits;
+        const std::from_chars_result parsed = std::from_chars(position + 1, last, bits);
+        if (parsed.ec != std::errc() || parsed.ptr != last || bits < 0 || bits > IPV4_BITS) return false;
+        mask = bits_to_mask(bits);
+        return true;
+    }
+
+    // Validate IPv4 address format (the dotted quads inet_pton accepts)
+    inline bool isValidIPv4(const std::string& ip) {
+        uint32_t binary;
+        return parseIPv4(ip.data(), ip.data() + ip.size(), binary) == ip.data() + ip.size();
+    }
+
+    // Validate port number is in valid range
+    inline bool isValidPort(int port) {
+        return port >= 1 && port <= 65535;
+    }
+    inline bool isValidPort(std::string port){
+        int port_num = stoi(port);
+        return port_num >= 1 && port_num <= 65535;
+    }
+
+    // Validate CIDR notation (e.g., 192.168.1.0/24)
+    inline bool isValidCIDR(const std::string& cidr) {
+        uint32_t ip;
+        uint32_t mask;
+        const bool has_mask = cidr.find_first_of("/\\") != std::string::npos;
+        return has_mask && parseCIDR4(cidr, ip, mask);
     }
 
     // Parse CIDR into components (returns empty vector on failure)
@@ -92,21 +296,13 @@ namespace netUtil {
 
     // Convert IP string to binary representation
     inline bool ipToBinary(const std::string& ip, uint32_t& binary) {
-        struct sockaddr_in sa;
-        if (inet_pton(AF_INET, ip.c_str(), &sa.sin_addr) == 1) {
-            binary = ntohl(sa.sin_addr.s_addr);
-            return true;
-        }
-        return false;
+        return parseIPv4(ip.data(), ip.data() + ip.size(), binary) == ip.data() + ip.size();
     }
 
     // Convert binary IP to string representation
     inline std::string binaryToIP(uint32_t ip) {
-        struct in_addr addr;
-        addr.s_addr = htonl(ip);
-        char buffer[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &addr, buffer, INET_ADDRSTRLEN);
-        return std::string(buffer);
+        char buffer[IPV4_TEXT_MAX + 1];
+        return std::string(buffer, formatIPv4(buffer, buffer + sizeof(buffer), ip));
     }
 
     // Check if string contains only digits
@@ -127,54 +323,264 @@ namespace netUtil {
 
 
     inline bool octets_to_bits(const std::vector<std::string>& octets, uint32_t& ip)
-    {    
+    {
         ip = 0;  // Initialize the output parameter
-        try {
-
-            const int IPV4_OCTETS = 4;
-            for (int i = 0; i < IPV4_OCTETS; i++) { //octets in a valid subnet. ignore anything else, like a dangling subnet mask
-                int octet = std::stoi(octets[i]);
-
-                const int MIN_OCTET = 0;
-                const int MAX_OCTET = 255;
-                if (octet < MIN_OCTET || octet > MAX_OCTET) return false;  // Invalid octet range
-
-                const uint8_t BITS_PER_OCTET = 8;
-                const uint8_t offset = (24 - (i * BITS_PER_OCTET));
-                ip |= (octet << offset);
+        if (octets.size() < IPV4_OCTETS) return false;
+
+        for (int i = 0; i < IPV4_OCTETS; i++) { //octets in a valid subnet. ignore anything else, like a dangling subnet mask
+            const std::string& text = octets[i];
+            int octet;
+            const std::from_chars_result parsed = std::from_chars(text.data(), text.data() + text.size(), octet);
+
+            const int MIN_OCTET = 0;
+            const int MAX_OCTET = 255;
+            if (parsed.ec != std::errc() || octet < MIN_OCTET || octet > MAX_OCTET) {  // Conversion failed, or invalid octet range
+                ip = 0;
+                return false;
             }
-            return true;  // Success
 
-        } catch (const std::exception& e) { // Conversion failed
-            ip = 0; 
-            return false;  
+            const uint8_t BITS_PER_OCTET = 8;
+            const uint8_t offset = (24 - (i * BITS_PER_OCTET));
+            ip |= (static_cast<uint32_t>(octet) << offset);
         }
+        return true;  // Success
     }
 
 
     inline std::string bits_to_address(const uint32_t ip)
     {
-        std::stringstream ss; //shift for each octet!
-        ss << ((ip >> 24) & 0xFF) << "."
-        << ((ip >> 16) & 0xFF) << "."
-        << ((ip >> 8) & 0xFF) << "."
-        << (ip & 0xFF);
-        return ss.str();
+        char buffer[IPV4_TEXT_MAX + 1];     // fits the short string buffer, so no allocation either
+        return std::string(buffer, formatIPv4(buffer, buffer + sizeof(buffer), ip));
     }
 
 
     inline bool mask_to_bits(const std::string& subnet_mask, uint32_t& results) {
         int bits;
-        try { bits = std::stoi(subnet_mask);} //perform string to int conversion
-        catch(const  std::exception& e){ return false;}
+        const std::from_chars_result parsed = std::from_chars(subnet_mask.data(), subnet_mask.data() + subnet_mask.size(), bits);
+        if (parsed.ec != std::errc()) return false;
+
+        if (bits < 0 || bits > IPV4_BITS) return false;    // Invalid input
+        results = bits_to_mask(bits);
+        return true;
+    }
+
+
+    // Resolve "<ip>" or "<cidr>" into the inclusive range of host addresses worth probing
+    inline bool target_to_host_range(const std::string& target, uint32_t& first_host, uint32_t& last_host) {
+        uint32_t ip;
+        uint32_t mask;
+        if (!parseCIDR4(target, ip, mask)) return false;
+
+        const uint32_t network_address = ip & mask;
+        const uint32_t broadcast_address = ip | ~mask;
+        const uint32_t POINT_TO_POINT_HOSTS = 1;  // /31 and /32 have no network or broadcast address to skip
+        if (broadcast_address - network_address <= POINT_TO_POINT_HOSTS) {
+            first_host = network_address;
+            last_host = broadcast_address;
+        }
+        else {
+            first_host = network_address + 1;
+            last_host = broadcast_address - 1;
+        }
+        return true;
+    }
+
+
+    // Directed broadcast address of a CIDR target; false for single hosts and /31, /32 which have none
+    inline bool target_to_broadcast(const std::string& target, uint32_t& broadcast_address) {
+        uint32_t ip;
+        uint32_t mask;
+        const uint32_t POINT_TO_POINT_HOSTS = 1;
+        if (!parseCIDR4(target, ip, mask) || ~mask <= POINT_TO_POINT_HOSTS) {
+            return false;
+        }
+        broadcast_address = ip | ~mask;
+        return true;
+    }
+
+    // 128-bit IPv6 address in host order: high holds the first 8 bytes, so comparisons and prefix
+    // arithmetic work the way they do on the uint32_t IPv4 addresses
+    struct IPv6Address {
+        uint64_t high;
+        uint64_t low;
+    };
+
+    inline bool operator==(const IPv6Address& a, const IPv6Address& b) { return a.high == b.high && a.low == b.low; }
+    inline bool operator!=(const IPv6Address& a, const IPv6Address& b) { return !(a == b); }
+    inline bool operator<(const IPv6Address& a, const IPv6Address& b) { return a.high != b.high ? a.high < b.high : a.low < b.low; }
+
+    constexpr int IPV6_BITS = 128;
+    constexpr int IPV6_INTERFACE_ID_BITS = 64;  // SLAAC prefixes are /64, the rest is the host's interface ID
+    constexpr int IPV6_ENUMERABLE_PREFIX = 112; // longest prefix still swept address by address (65,536 of them)
+
+    inline IPv6Address in6_to_bits(const in6_addr& address) {
+        IPv6Address bits = {0, 0};
+        for (int i = 0; i < 8; i++) {
+            bits.high = (bits.high << 8) | address.s6_addr[i];
+            bits.low = (bits.low << 8) | address.s6_addr[i + 8];
+        }
+        return bits;
+    }
+
+    inline in6_addr bits_to_in6(const IPv6Address& bits) {
+        in6_addr address = {};
+        for (int i = 0; i < 8; i++) {
+            address.s6_addr[7 - i] = static_cast<uint8_t>(bits.high >> (i * 8));
+            address.s6_addr[15 - i] = static_cast<uint8_t>(bits.low >> (i * 8));
+        }
+        return address;
+    }
+
+    inline bool isValidIPv6(const std::string& ip) {
+        in6_addr address;
+        return inet_pton(AF_INET6, ip.c_str(), &address) == 1;
+    }
+
+    inline bool ipv6ToBinary(const std::string& ip, IPv6Address& binary) {
+        in6_addr address;
+        if (inet_pton(AF_INET6, ip.c_str(), &address) != 1) return false;
+        binary = in6_to_bits(address);
+        return true;
+    }
+
+    // RFC 5952 text, "::" compressed
+    inline std::string binaryToIPv6(const IPv6Address& ip) {
+        const in6_addr address = bits_to_in6(ip);
+        char buffer[INET6_ADDRSTRLEN];
+        inet_ntop(AF_INET6, &address, buffer, INET6_ADDRSTRLEN);
+        return std::string(buffer);
+    }
 
-        const int MAX_SUBNET_BITS = 32;
-        if (bits < 0 || bits > MAX_SUBNET_BITS) return false;    // Invalid input
-        else results = 0xFFFFFFFF << (MAX_SUBNET_BITS - bits);   // no edge case, perform normal conversion
+    inline IPv6Address mask6(const IPv6Address& ip, int prefix_length) {
+        const uint64_t ALL_ONES = ~uint64_t{0};
+        const int high_bits = std::min(prefix_length, 64);
+        const int low_bits = std::max(prefix_length - 64, 0);
+        return {high_bits == 0 ? 0 : ip.high & (ALL_ONES << (64 - high_bits)),
+                low_bits == 0 ? 0 : ip.low & (ALL_ONES << (64 - low_bits))};
+    }
+
+    inline bool in_prefix6(const IPv6Address& ip, const IPv6Address& network, int prefix_length) {
+        return mask6(ip, prefix_length) == mask6(network, prefix_length);
+    }
+
+    // fe80::/10, only meaningful together with a zone (the interface it was learned on)
+    inline bool isLinkLocal6(const IPv6Address& ip) {
+        const IPv6Address LINK_LOCAL_NETWORK = {0xFE80000000000000, 0};
+        const int LINK_LOCAL_PREFIX = 10;
+        return in_prefix6(ip, LINK_LOCAL_NETWORK, LINK_LOCAL_PREFIX);
+    }
+
+    // An IPv6 scan target and its zone (sin6_scope_id): the interface index for a link-local address, else 0
+    struct IPv6Host {
+        IPv6Address address;
+        uint32_t scope_id;
+    };
+
+    inline bool isIPv6Target(const std::string& target) {
+        return target.find(':') != std::string::npos;
+    }
 
+    // "<ipv6>/<0-128>", or a bare address as a /128; the network comes back with its host bits cleared
+    inline bool parseCIDR6(const std::string& cidr, IPv6Address& network, int& prefix_length) {
+        const size_t delimiter_pos = cidr.find('/');
+        if (!ipv6ToBinary(cidr.substr(0, delimiter_pos), network)) return false;
+        prefix_length = IPV6_BITS;
+        if (delimiter_pos != std::string::npos) {
+            const std::string mask_part = cidr.substr(delimiter_pos + 1);
+            const size_t MAX_MASK_DIGITS = 3;
+            if (!isNumeric(mask_part) || mask_part.length() > MAX_MASK_DIGITS) return false;
+            prefix_length = std::stoi(mask_part);
+            if (prefix_length > IPV6_BITS) return false;
+        }
+        network = mask6(network, prefix_length);
+        return true;
+    }
+
+    // Every address of an IPv6 target that can be probed one by one: the address itself, or each address
+    // of a prefix of IPV6_ENUMERABLE_PREFIX or longer. Wider prefixes are only reachable through the hosts
+    // a discovery sweep found in them, so those are taken from known_hosts instead (and it may be empty).
+    // Enumerated addresses get no zone; known hosts keep the one they were discovered with.
+    inline bool target6_to_hosts(const std::string& target, const std::vector<IPv6Host>& known_hosts, std::vector<IPv6Host>& hosts) {
+        IPv6Address network;
+        int prefix_length;
+        if (!parseCIDR6(target, network, prefix_length)) return false;
+        hosts.clear();
+        if (prefix_length >= IPV6_ENUMERABLE_PREFIX) {
+            const uint64_t host_count = uint64_t{1} << (IPV6_BITS - prefix_length);
+            for (uint64_t offset = 0; offset < host_count; offset++) hosts.push_back({{network.high, network.low + offset}, 0});
+            return true;
+        }
+        for (const IPv6Host& host : known_hosts) {
+            if (in_prefix6(host.address, network, prefix_length)) hosts.push_back(host);
+        }
         return true;
     }
 
+    // Socket address for a host and port, returns its length
+    inline int toSocketAddress(uint32_t host, uint16_t port, sockaddr_storage& storage) {
+        storage = {};
+        sockaddr_in& address = reinterpret_cast<sockaddr_in&>(storage);
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(host);
+        return sizeof(sockaddr_in);
+    }
+    inline int toSocketAddress(const IPv6Address& host, uint16_t port, sockaddr_storage& storage, uint32_t scope_id = 0) {
+        storage = {};
+        sockaddr_in6& address = reinterpret_cast<sockaddr_in6&>(storage);
+        address.sin6_family = AF_INET6;
+        address.sin6_port = htons(port);
+        address.sin6_addr = bits_to_in6(host);
+        address.sin6_scope_id = scope_id;
+        return sizeof(sockaddr_in6);
+    }
+    inline int toSocketAddress(const IPv6Host& host, uint16_t port, sockaddr_storage& storage) {
+        return toSocketAddress(host.address, port, storage, host.scope_id);
+    }
+
+    // sendto on a non-blocking datagram socket, waiting out a full send buffer instead of dropping the packet
+    inline bool sendDatagram(SOCKET udp_socket, const std::string& payload, const sockaddr* address, int address_length) {
+        const int SEND_BLOCKED_WAIT_MS = 5;
+        while (sendto(udp_socket, payload.data(), static_cast<int>(payload.size()), 0, address, address_length) == SOCKET_ERROR) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) return false;
+            WSAPOLLFD poll_descriptor = {};
+            poll_descriptor.fd = udp_socket;
+            poll_descriptor.events = POLLWRNORM;
+            WSAPoll(&poll_descriptor, 1, SEND_BLOCKED_WAIT_MS);
+        }
+        return true;
+    }
+
+    // Parse a MAC in any common vendor notation (0011.2233.4455, 00-11-22-33-44-55, 001122-334455, 00:11:...)
+    inline bool parseMAC(const std::string& text, uint64_t& mac) {
+        const int MAC_HEX_DIGITS = 12;
+        int digit_count = 0;
+        mac = 0;
+        for (char c : text) {
+            if (c == ':' || c == '-' || c == '.') continue;
+            if (!std::isxdigit(static_cast<unsigned char>(c))) return false;
+            if (++digit_count > MAC_HEX_DIGITS) return false;
+            const int nibble = std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (std::tolower(c) - 'a' + 10);
+            mac = (mac << 4) | nibble;
+        }
+        return digit_count == MAC_HEX_DIGITS;
+    }
+
+
+    inline std::string mac_to_string(const uint64_t mac)
+    {
+        const char HEX_DIGITS[] = "0123456789abcdef";
+        const int MAC_OCTETS = 6;
+        std::string text;
+        for (int i = MAC_OCTETS - 1; i >= 0; i--) { //most significant octet first
+            const uint8_t octet = (mac >> (i * 8)) & 0xFF;
+            text += HEX_DIGITS[octet >> 4];
+            text += HEX_DIGITS[octet & 0x0F];
+            if (i > 0) text += ':';
+        }
+        return text;
+    }
+
 
 }
 
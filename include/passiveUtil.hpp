@@ -0,0 +1,422 @@
+#ifndef PASSIVE_UTIL_H
+#define PASSIVE_UTIL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "captureUtil.hpp"
+#include "dnsUtil.hpp"
+#include "enipUtil.hpp"
+#include "netUtil.hpp"
+
+// Passive discovery: dissect captured frames for the protocols devices use to announce themselves
+// (ARP, LLDP, CDP, DHCP, mDNS, EtherNet/IP ListIdentity) and fold what they reveal into an inventory.
+// Every dissector rejects unrelated traffic within its first header checks and reads the frame in place,
+// so a busy capture costs little more than walking its frames; only announcements touch the inventory.
+namespace passiveUtil {
+
+    // Bit flags for the protocols a host was seen in
+    constexpr uint8_t SOURCE_ARP = 0x01;
+    constexpr uint8_t SOURCE_LLDP = 0x02;
+    constexpr uint8_t SOURCE_CDP = 0x04;
+    constexpr uint8_t SOURCE_DHCP = 0x08;
+    constexpr uint8_t SOURCE_MDNS = 0x10;
+    constexpr uint8_t SOURCE_ENIP = 0x20;
+
+    inline std::string sourceNames(uint8_t sources) {
+        const char* NAMES[] = {"ARP", "LLDP", "CDP", "DHCP", "mDNS", "ENIP"};
+        std::string names;
+        for (int bit = 0; bit < 6; bit++) {
+            if (!(sources & (1 << bit))) continue;
+            if (!names.empty()) names += ',';
+            names += NAMES[bit];
+        }
+        return names;
+    }
+
+    struct HostRecord {
+        uint32_t ip;            // 0 when only the MAC is known (LLDP without a management address)
+        uint64_t mac;           // 0 when only the IP is known (live capture has no Ethernet header)
+        std::string name;       // LLDP/CDP system name, DHCP host name, mDNS name or ENIP product name
+        std::string detail;     // platform, system description, DHCP vendor class or ENIP vendor
+        uint8_t sources;
+    };
+
+    // A switch or router announcing itself, and the port it sent the announcement from
+    struct NeighborLink {
+        uint64_t mac;
+        std::string system_name;
+        std::string port_id;
+        uint8_t source;
+    };
+
+    // Hosts merged by IP, or by MAC until an IP turns up for them. First name and detail seen win.
+    class Inventory {
+    public:
+        void observe(uint32_t ip, uint64_t mac, uint8_t source, std::string_view name = {}, std::string_view detail = {}) {
+            const size_t NOT_FOUND = SIZE_MAX;
+            if (ip == 0 && mac == 0) return;
+            size_t index = NOT_FOUND;
+            if (ip != 0) {
+                const auto by_ip = m_by_ip.find(ip);
+                if (by_ip != m_by_ip.end()) index = by_ip->second;
+            }
+            if (index == NOT_FOUND && mac != 0) {     // a MAC-only record takes the first IP seen with it
+                const auto by_mac = m_by_mac.find(mac);
+                if (by_mac != m_by_mac.end() && (ip == 0 || m_hosts[by_mac->second].ip == 0)) index = by_mac->second;
+            }
+            if (index == NOT_FOUND) {
+                index = m_hosts.size();
+                m_hosts.push_back({0, 0, "", "", 0});
+            }
+
+            HostRecord& host = m_hosts[index];
+            if (host.ip == 0 && ip != 0) {
+                host.ip = ip;
+                m_by_ip.emplace(ip, index);
+            }
+            if (host.mac == 0 && mac != 0) {
+                host.mac = mac;
+                m_by_mac.emplace(mac, index);   // keeps the first record when one MAC answers for several IPs
+            }
+            if (host.name.empty() && !name.empty()) host.name.assign(name);
+            if (host.detail.empty() && !detail.empty()) host.detail.assign(detail);
+            host.sources |= source;
+        }
+
+        void link(uint64_t mac, std::string_view system_name, std::string_view port_id, uint8_t source) {
+            for (const NeighborLink& known : m_links) {
+                if (known.mac == mac && known.system_name == system_name && known.port_id == port_id) return;
+            }
+            m_links.push_back({mac, std::string(system_name), std::string(port_id), source});
+        }
+
+        const std::vector<HostRecord>& hosts() const { return m_hosts; }
+        const std::vector<NeighborLink>& links() const { return m_links; }
+
+        void clear() {
+            m_hosts.clear();
+            m_by_ip.clear();
+            m_by_mac.clear();
+            m_links.clear();
+        }
+
+    private:
+        std::vector<HostRecord> m_hosts;
+        std::unordered_map<uint32_t, size_t> m_by_ip;
+        std::unordered_map<uint64_t, size_t> m_by_mac;
+        std::vector<NeighborLink> m_links;
+    };
+
+    inline uint16_t readBE16(const uint8_t* data) {
+        return static_cast<uint16_t>((data[0] << 8) | data[1]);
+    }
+
+    inline uint32_t readBE32(const uint8_t* data) {
+        return (static_cast<uint32_t>(readBE16(data)) << 16) | readBE16(data + 2);
+    }
+
+    inline uint64_t readMAC(const uint8_t* data) {
+        return (static_cast<uint64_t>(readBE16(data)) << 32) | readBE32(data + 2);
+    }
+
+    // Text field as a view into the frame, cut at the first line break and at max_length
+    inline std::string_view textField(const uint8_t* data, size_t length, size_t max_length = 64) {
+        std::string_view text(reinterpret_cast<const char*>(data), length < max_length ? length : max_length);
+        const size_t line_end = text.find_first_of("\r\n");
+        return (line_end == std::string_view::npos) ? text : text.substr(0, line_end);
+    }
+
+    // ARP sender MAC/IP pairs; probes (sender 0.0.0.0) say nothing about addresses
+    inline void dissectARP(const uint8_t* data, size_t length, Inventory& inventory) {
+        const size_t ARP_IPV4_SIZE = 28;
+        const uint16_t HARDWARE_ETHERNET = 1;
+        const uint16_t PROTOCOL_IPV4 = 0x0800;
+        if (length < ARP_IPV4_SIZE || readBE16(data) != HARDWARE_ETHERNET || readBE16(data + 2) != PROTOCOL_IPV4) return;
+        if (data[4] != 6 || data[5] != 4) return;
+        const uint64_t sender_mac = readMAC(data + 8);
+        const uint32_t sender_ip = readBE32(data + 14);
+        if (sender_ip == 0 || sender_mac == 0) return;
+        inventory.observe(sender_ip, sender_mac, SOURCE_ARP);
+    }
+
+    // LLDPDU: 7-bit type / 9-bit length TLVs
+    inline void dissectLLDP(const uint8_t* data, size_t length, uint64_t source_mac, Inventory& inventory) {
+        const uint8_t TLV_END = 0;
+        const uint8_t TLV_CHASSIS_ID = 1;
+        const uint8_t TLV_PORT_ID = 2;
+        const uint8_t TLV_SYSTEM_NAME = 5;
+        const uint8_t TLV_SYSTEM_DESCRIPTION = 6;
+        const uint8_t TLV_MANAGEMENT_ADDRESS = 8;
+        const uint8_t CHASSIS_MAC = 4;
+        const uint8_t CHASSIS_NETWORK_ADDRESS = 5;
+        const uint8_t PORT_MAC = 3;
+        const uint8_t ADDRESS_FAMILY_IPV4 = 1;
+
+        uint64_t chassis_mac = source_mac;
+        uint32_t management_ip = 0;
+        std::string_view system_name;
+        std::string_view description;
+        std::string port_id;
+        size_t position = 0;
+        while (position + 2 <= length) {
+            const uint16_t header = readBE16(data + position);
+            const uint8_t type = static_cast<uint8_t>(header >> 9);
+            const size_t value_length = header & 0x1FF;
+            const uint8_t* value = data + position + 2;
+            position += 2 + value_length;
+            if (type == TLV_END || position > length) break;
+
+            if (type == TLV_CHASSIS_ID && value_length == 7 && value[0] == CHASSIS_MAC) {
+                chassis_mac = readMAC(value + 1);
+            }
+            else if (type == TLV_CHASSIS_ID && value_length == 6 && value[0] == CHASSIS_NETWORK_ADDRESS && value[1] == ADDRESS_FAMILY_IPV4) {
+                management_ip = readBE32(value + 2);
+            }
+            else if (type == TLV_PORT_ID && value_length > 1) {
+                port_id = (value[0] == PORT_MAC && value_length == 7) ? netUtil::mac_to_string(readMAC(value + 1))
+                                                                      : std::string(textField(value + 1, value_length - 1));
+            }
+            else if (type == TLV_SYSTEM_NAME) {
+                system_name = textField(value, value_length);
+            }
+            else if (type == TLV_SYSTEM_DESCRIPTION) {
+                description = textField(value, value_length);
+            }
+            else if (type == TLV_MANAGEMENT_ADDRESS && value_length >= 6 && value[0] == 5 && value[1] == ADDRESS_FAMILY_IPV4) {
+                management_ip = readBE32(value + 2);    // address string length 5 = family byte + IPv4
+            }
+        }
+        inventory.observe(management_ip, chassis_mac, SOURCE_LLDP, system_name, description);
+        inventory.link(chassis_mac, system_name, port_id, SOURCE_LLDP);
+    }
+
+    // CDP after its SNAP header: version, TTL, checksum, then 16-bit type / 16-bit length TLVs
+    inline void dissectCDP(const uint8_t* data, size_t length, uint64_t source_mac, Inventory& inventory) {
+        const size_t CDP_HEADER_SIZE = 4;
+        const uint16_t TLV_DEVICE_ID = 0x0001;
+        const uint16_t TLV_ADDRESSES = 0x0002;
+        const uint16_t TLV_PORT_ID = 0x0003;
+        const uint16_t TLV_PLATFORM = 0x0006;
+        const uint8_t PROTOCOL_TYPE_NLPID = 1;
+        const uint8_t NLPID_IP = 0xCC;
+
+        uint32_t address = 0;
+        std::string_view device_id;
+        std::string_view port_id;
+        std::string_view platform;
+        size_t position = CDP_HEADER_SIZE;
+        while (position + 4 <= length) {
+            const uint16_t type = readBE16(data + position);
+            const size_t tlv_length = readBE16(data + position + 2);    // includes the 4-byte header
+            if (tlv_length < 4 || position + tlv_length > length) break;
+            const uint8_t* value = data + position + 4;
+            const size_t value_length = tlv_length - 4;
+            position += tlv_length;
+
+            if (type == TLV_DEVICE_ID) device_id = textField(value, value_length);
+            else if (type == TLV_PORT_ID) port_id = textField(value, value_length);
+            else if (type == TLV_PLATFORM) platform = textField(value, value_length);
+            else if (type == TLV_ADDRESSES && value_length >= 4 && address == 0) {
+                // count, then (protocol type, protocol length, protocol, address length, address) entries
+                const uint32_t count = readBE32(value);
+                size_t entry = 4;
+                for (uint32_t i = 0; i < count && entry + 2 <= value_length; i++) {
+                    const uint8_t protocol_type = value[entry];
+                    const size_t protocol_length = value[entry + 1];
+                    if (entry + 2 + protocol_length + 2 > value_length) break;
+                    const size_t address_length = readBE16(value + entry + 2 + protocol_length);
+                    const size_t address_at = entry + 4 + protocol_length;
+                    if (address_at + address_length > value_length) break;
+                    if (protocol_type == PROTOCOL_TYPE_NLPID && protocol_length == 1 && value[entry + 2] == NLPID_IP && address_length == 4) {
+                        address = readBE32(value + address_at);
+                        break;
+                    }
+                    entry = address_at + address_length;
+                }
+            }
+        }
+        inventory.observe(address, source_mac, SOURCE_CDP, device_id, platform);
+        inventory.link(source_mac, device_id, port_id, SOURCE_CDP);
+    }
+
+    // BOOTP/DHCP: the client MAC with the address it was acknowledged (or already holds), its host name
+    // and vendor class. Discover and request carry no confirmed address; they still name the MAC.
+    inline void dissectDHCP(const uint8_t* data, size_t length, Inventory& inventory) {
+        const size_t OPTIONS_OFFSET = 240;
+        const uint32_t MAGIC_COOKIE = 0x63825363;
+        const uint8_t OPTION_PAD = 0;
+        const uint8_t OPTION_HOST_NAME = 12;
+        const uint8_t OPTION_MESSAGE_TYPE = 53;
+        const uint8_t OPTION_VENDOR_CLASS = 60;
+        const uint8_t OPTION_END = 255;
+        const uint8_t MESSAGE_ACK = 5;
+        if (length < OPTIONS_OFFSET || data[1] != 1 || data[2] != 6 || readBE32(data + 236) != MAGIC_COOKIE) return;
+
+        const uint32_t client_ip = readBE32(data + 12);
+        const uint32_t your_ip = readBE32(data + 16);
+        const uint64_t client_mac = readMAC(data + 28);
+        uint8_t message_type = 0;
+        std::string_view host_name;
+        std::string_view vendor_class;
+        size_t position = OPTIONS_OFFSET;
+        while (position < length && data[position] != OPTION_END) {
+            const uint8_t option = data[position];
+            if (option == OPTION_PAD) {
+                position++;
+                continue;
+            }
+            if (position + 2 > length || position + 2 + data[position + 1] > length) break;
+            const uint8_t* value = data + position + 2;
+            const size_t value_length = data[position + 1];
+            position += 2 + value_length;
+            if (option == OPTION_MESSAGE_TYPE && value_length == 1) message_type = value[0];
+            else if (option == OPTION_HOST_NAME) host_name = textField(value, value_length);
+            else if (option == OPTION_VENDOR_CLASS) vendor_class = textField(value, value_length);
+        }
+        const uint32_t address = (message_type == MESSAGE_ACK && your_ip != 0) ? your_ip : client_ip;
+        inventory.observe(address, client_mac, SOURCE_DHCP, host_name, vendor_class);
+    }
+
+    // mDNS responses: every A record names an address on the link
+    inline void dissectMDNS(const uint8_t* data, size_t length, uint32_t source_ip, uint64_t source_mac, Inventory& inventory) {
+        const size_t DNS_HEADER_SIZE = 12;
+        const uint16_t FLAG_RESPONSE = 0x8000;
+        const uint16_t TYPE_A = 1;
+        const size_t MAX_NAME_LENGTH = 255;
+        if (length < DNS_HEADER_SIZE || !(readBE16(data + 2) & FLAG_RESPONSE)) return;
+
+        const uint16_t question_count = readBE16(data + 4);
+        const uint32_t record_count = static_cast<uint32_t>(readBE16(data + 6)) + readBE16(data + 8) + readBE16(data + 10);
+        char name[MAX_NAME_LENGTH + 1];
+        size_t name_length;
+        size_t position = DNS_HEADER_SIZE;
+        for (uint16_t i = 0; i < question_count; i++) {
+            if (!dnsUtil::readDnsName(data, length, position, name, sizeof(name), name_length) || position + 4 > length) return;
+            position += 4;
+        }
+        for (uint32_t i = 0; i < record_count; i++) {
+            if (!dnsUtil::readDnsName(data, length, position, name, sizeof(name), name_length) || position + 10 > length) return;
+            const uint16_t type = readBE16(data + position);
+            const size_t data_length = readBE16(data + position + 8);
+            position += 10;
+            if (position + data_length > length) return;
+            if (type == TYPE_A && data_length == 4) {
+                const uint32_t address = readBE32(data + position);
+                inventory.observe(address, (address == source_ip) ? source_mac : 0, SOURCE_MDNS, std::string_view(name, name_length));
+            }
+            position += data_length;
+        }
+    }
+
+    // ListIdentity replies, whether answering us, another scanner or an engineering workstation
+    inline void dissectENIP(const uint8_t* data, size_t length, uint32_t source_ip, uint64_t source_mac, Inventory& inventory) {
+        if (length < enipUtil::HEADER_SIZE) return;
+        if (data[0] != (enipUtil::COMMAND_LIST_IDENTITY & 0xFF) || data[1] != (enipUtil::COMMAND_LIST_IDENTITY >> 8)) return;
+        enipUtil::IdentityRecord record;
+        if (!enipUtil::parseListIdentity(std::string(reinterpret_cast<const char*>(data), length), record)) return;
+        inventory.observe(source_ip, source_mac, SOURCE_ENIP, record.product_name, enipUtil::vendorName(record.vendor_id));
+    }
+
+    // IPv4 header onward; source_mac is 0 when the frame had no Ethernet header
+    inline void dissectIPv4(const uint8_t* data, size_t length, uint64_t source_mac, Inventory& inventory) {
+        const uint8_t PROTOCOL_TCP = 6;
+        const uint8_t PROTOCOL_UDP = 17;
+        const uint16_t DHCP_SERVER_PORT = 67;
+        const uint16_t DHCP_CLIENT_PORT = 68;
+        const uint16_t MDNS_PORT = 5353;
+        if (length < 20 || (data[0] >> 4) != 4) return;
+        const size_t header_length = (data[0] & 0x0F) * 4;
+        const size_t total_length = readBE16(data + 2);
+        if (header_length < 20 || total_length < header_length) return;
+        if (readBE16(data + 6) & 0x1FFF) return;    // later fragments have no transport header
+        if (total_length < length) length = total_length;      // drop Ethernet padding
+        if (length < header_length + 8) return;
+
+        const uint8_t protocol = data[9];
+        const uint32_t source_ip = readBE32(data + 12);
+        const uint8_t* transport = data + header_length;
+        const size_t transport_length = length - header_length;
+        const uint16_t source_port = readBE16(transport);
+        const uint16_t destination_port = readBE16(transport + 2);
+
+        if (protocol == PROTOCOL_UDP) {
+            const uint8_t* payload = transport + 8;
+            const size_t payload_length = transport_length - 8;
+            if ((source_port == DHCP_SERVER_PORT || source_port == DHCP_CLIENT_PORT)
+                && (destination_port == DHCP_SERVER_PORT || destination_port == DHCP_CLIENT_PORT)) {
+                dissectDHCP(payload, payload_length, inventory);
+            }
+            else if (source_port == MDNS_PORT || destination_port == MDNS_PORT) {
+                dissectMDNS(payload, payload_length, source_ip, source_mac, inventory);
+            }
+            else if (source_port == enipUtil::ENIP_PORT) {
+                dissectENIP(payload, payload_length, source_ip, source_mac, inventory);
+            }
+        }
+        else if (protocol == PROTOCOL_TCP && source_port == enipUtil::ENIP_PORT && transport_length >= 20) {
+            const size_t tcp_header_length = (transport[12] >> 4) * 4;
+            if (tcp_header_length < 20 || tcp_header_length > transport_length) return;
+            dissectENIP(transport + tcp_header_length, transport_length - tcp_header_length, source_ip, source_mac, inventory);
+        }
+    }
+
+    // Ethernet II with any number of VLAN tags, or 802.3 + SNAP for CDP
+    inline void dissectEthernet(const uint8_t* data, size_t length, Inventory& inventory) {
+        const size_t ETHERNET_HEADER_SIZE = 14;
+        const uint16_t ETHERTYPE_IPV4 = 0x0800;
+        const uint16_t ETHERTYPE_ARP = 0x0806;
+        const uint16_t ETHERTYPE_VLAN = 0x8100;
+        const uint16_t ETHERTYPE_QINQ = 0x88A8;
+        const uint16_t ETHERTYPE_LLDP = 0x88CC;
+        const uint16_t MAX_802_3_LENGTH = 1500;
+        const uint8_t CDP_SNAP_HEADER[] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x0C, 0x20, 0x00};
+        if (length < ETHERNET_HEADER_SIZE) return;
+
+        const uint64_t source_mac = readMAC(data + 6);
+        size_t position = 12;
+        uint16_t ether_type = readBE16(data + position);
+        while ((ether_type == ETHERTYPE_VLAN || ether_type == ETHERTYPE_QINQ) && position + 6 <= length) {
+            position += 4;
+            ether_type = readBE16(data + position);
+        }
+        position += 2;
+        const uint8_t* payload = data + position;
+        const size_t payload_length = length - position;
+
+        if (ether_type == ETHERTYPE_IPV4) dissectIPv4(payload, payload_length, source_mac, inventory);
+        else if (ether_type == ETHERTYPE_ARP) dissectARP(payload, payload_length, inventory);
+        else if (ether_type == ETHERTYPE_LLDP) dissectLLDP(payload, payload_length, source_mac, inventory);
+        else if (ether_type <= MAX_802_3_LENGTH && payload_length > sizeof(CDP_SNAP_HEADER)
+                 && std::equal(CDP_SNAP_HEADER, CDP_SNAP_HEADER + sizeof(CDP_SNAP_HEADER), payload)) {
+            dissectCDP(payload + sizeof(CDP_SNAP_HEADER), payload_length - sizeof(CDP_SNAP_HEADER), source_mac, inventory);
+        }
+    }
+
+    inline void dissectFrame(const captureUtil::Frame& frame, Inventory& inventory) {
+        const size_t SLL_HEADER_SIZE = 16;
+        const uint16_t SLL_PROTOCOL_IPV4 = 0x0800;
+        switch (frame.link_type) {
+            case captureUtil::LINKTYPE_ETHERNET:
+                dissectEthernet(frame.data, frame.length, inventory);
+                break;
+            case captureUtil::LINKTYPE_RAW:
+            case captureUtil::LINKTYPE_IPV4:
+                dissectIPv4(frame.data, frame.length, 0, inventory);
+                break;
+            case captureUtil::LINKTYPE_LINUX_SLL:
+                if (frame.length > SLL_HEADER_SIZE && readBE16(frame.data + 14) == SLL_PROTOCOL_IPV4) {
+                    dissectIPv4(frame.data + SLL_HEADER_SIZE, frame.length - SLL_HEADER_SIZE, 0, inventory);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+}
+
+#endif // PASSIVE_UTIL_H
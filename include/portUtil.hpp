@@ -0,0 +1,254 @@
+#ifndef PORT_UTIL_H
+#define PORT_UTIL_H
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Port sets and the known-service table for the TCP scanner.
+// A port spec such as "1-1024,502,44818,top100" compiles into a 65,536-bit set; service names come
+// from a compile-time table sorted by port, indexed once so each lookup is a single array read.
+namespace portUtil {
+
+    using PortSet = std::bitset<65536>;
+
+    struct Service {
+        uint16_t port;
+        const char* name;
+    };
+
+    constexpr std::array<Service, 44> SERVICES = {{
+        {20, "FTP Data"},
+        {21, "FTP Control"},
+        {22, "SSH Secure Shell"},
+        {23, "Telnet"},
+        {25, "SMTP Mail"},
+        {69, "TFTP"},
+        {80, "HTTP Web Server"},
+        {102, "Siemens S7 / IEC 61850"},
+        {110, "POP3 Mail"},
+        {143, "IMAP Mail"},
+        {161, "SNMP"},
+        {162, "SNMP Trap"},
+        {443, "HTTPS Secure Web Server"},
+        {502, "Modbus TCP"},
+        {587, "SMTP Submission"},
+        {789, "Red Lion Crimson v3"},
+        {993, "IMAP Secure"},
+        {995, "POP3 Secure"},
+        {1433, "Microsoft SQL Server"},
+        {1883, "MQTT"},
+        {1911, "Niagara Fox Protocol"},
+        {1962, "Phoenix Contact PCWorx"},
+        {2222, "EtherNet/IP I/O Data"},
+        {2404, "IEC 60870-5-104"},
+        {2455, "WAGO CoDeSys"},
+        {3306, "MySQL Database"},
+        {3389, "Windows RDP"},
+        {4840, "OPC UA"},
+        {4843, "OPC UA with TLS"},
+        {5000, "Siemens S7 (alternate)"},
+        {5001, "Siemens S7 (alternate)"},
+        {5432, "PostgreSQL Database"},
+        {5900, "VNC Remote Desktop"},
+        {8080, "HTTP Alternate"},
+        {8443, "HTTPS Alternate"},
+        {8883, "MQTT with TLS"},
+        {9600, "OMRON FINS"},
+        {10001, "Ubiquiti Discovery"},
+        {20000, "DNP3"},
+        {34962, "Profinet RT"},
+        {34963, "Profinet RT"},
+        {34964, "Profinet RT"},
+        {44818, "EtherNet/IP Explicit Messaging"},
+        {47808, "BACnet/IP"},
+    }};
+
+    constexpr bool isStrictlySorted() {
+        for (size_t i = 1; i < SERVICES.size(); i++) {
+            if (SERVICES[i - 1].port >= SERVICES[i].port) return false;
+        }
+        return true;
+    }
+    static_assert(isStrictlySorted(), "SERVICES must be sorted by port with no duplicates");
+
+    // Most commonly open TCP ports on the internet, most common first, so "topN" takes a prefix
+    constexpr std::array<uint16_t, 100> TOP_PORTS = {{
+        80, 23, 443, 21, 22, 25, 3389, 110, 445, 139, 143, 53, 135, 3306, 8080, 1723, 111, 995, 993, 5900,
+        1025, 587, 8888, 199, 1720, 465, 548, 113, 81, 6001, 10000, 514, 5060, 179, 1026, 2000, 8443, 8000, 32768, 554,
+        26, 1433, 49152, 2001, 515, 8008, 49154, 1027, 5666, 646, 5000, 5631, 631, 49153, 8081, 2049, 88, 79, 5800, 106,
+        2121, 1110, 49155, 6000, 513, 990, 5357, 427, 49156, 543, 544, 5101, 144, 7, 389, 8009, 3128, 444, 9999, 5009,
+        7070, 5190, 3000, 5432, 1900, 3986, 13, 1029, 9, 5051, 6646, 49157, 1028, 873, 1755, 2717, 4899, 9100, 119, 37,
+    }};
+
+    constexpr uint8_t NO_SERVICE = 0xFF;
+    static_assert(SERVICES.size() < NO_SERVICE, "service index must fit in a byte");
+
+    // 64 KB port -> SERVICES index, built from the table on first use
+    inline const std::array<uint8_t, 65536>& serviceIndex() {
+        static const std::array<uint8_t, 65536> INDEX = [] {
+            std::array<uint8_t, 65536> index;
+            index.fill(NO_SERVICE);
+            for (size_t i = 0; i < SERVICES.size(); i++) {
+                index[SERVICES[i].port] = static_cast<uint8_t>(i);
+            }
+            return index;
+        }();
+        return INDEX;
+    }
+
+    inline const char* serviceName(uint16_t port) {
+        const uint8_t entry = serviceIndex()[port];
+        return (entry == NO_SERVICE) ? "Unknown Service" : SERVICES[entry].name;
+    }
+
+    inline bool parsePort(const std::string& text, uint16_t& port) {
+        const size_t MAX_PORT_DIGITS = 5;
+        if (text.empty() || text.size() > MAX_PORT_DIGITS || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        const unsigned long value = std::stoul(text);
+        if (value == 0 || value > 65535) return false;
+        port = static_cast<uint16_t>(value);
+        return true;
+    }
+
+    // Comma-separated list of ports, low-high ranges, "topN" (N up to 100) and "known" for every
+    // port in SERVICES. Sets bits in ports; on failure error names the offending token.
+    inline bool parsePortSpec(const std::string& spec, PortSet& ports, std::string& error) {
+        ports.reset();
+        std::stringstream tokens(spec);
+        std::string token;
+        while (std::getline(tokens, token, ',')) {
+            if (token == "known") {
+                for (const Service& service : SERVICES) ports.set(service.port);
+                continue;
+            }
+            if (token.compare(0, 3, "top") == 0) {
+                uint16_t count;
+                if (!parsePort(token.substr(3), count) || count > TOP_PORTS.size()) {
+                    error = "top list goes up to top" + std::to_string(TOP_PORTS.size()) + ": " + token;
+                    return false;
+                }
+                for (size_t i = 0; i < count; i++) ports.set(TOP_PORTS[i]);
+                continue;
+            }
+            const size_t dash = token.find('-');
+            uint16_t low;
+            uint16_t high;
+            if (dash == std::string::npos) {
+                if (!parsePort(token, low)) {
+                    error = "invalid port: " + token;
+                    return false;
+                }
+                ports.set(low);
+                continue;
+            }
+            if (!parsePort(token.substr(0, dash), low) || !parsePort(token.substr(dash + 1), high) || low > high) {
+                error = "invalid port range: " + token;
+                return false;
+            }
+            for (uint32_t port = low; port <= high; port++) ports.set(port);
+        }
+        if (ports.none()) {
+            error = "no ports in: " + spec;
+            return false;
+        }
+        return true;
+    }
+
+    // Order in which a sweep visits host x port pairs. PortMajor spreads load by trying one port across
+    // every host before the next port; HostMajor finishes each stripe of hosts before the next; Random is
+    // a full permutation.
+    enum class ScanOrder { PortMajor, HostMajor, Random };
+
+    inline bool parseScanOrder(const std::string& text, ScanOrder& order) {
+        if (text == "port-major") order = ScanOrder::PortMajor;
+        else if (text == "host-major") order = ScanOrder::HostMajor;
+        else if (text == "random") order = ScanOrder::Random;
+        else return false;
+        return true;
+    }
+
+    // Walks every (host index, port index) pair exactly once in the chosen order without storing them.
+    // Random runs a counter through a keyed bijection on the next power of two above the pair count and
+    // drops outputs past the end, so at most half the steps are discarded and memory stays constant.
+    // HostMajor takes hosts host_stripe at a time and rotates through a stripe's hosts port by port, so a
+    // caller capping connects per host can still fill its window from the stripe (1 = strictly one host).
+    class TargetSequence {
+    public:
+        TargetSequence(uint64_t host_count, uint64_t port_count, ScanOrder order, uint64_t seed, uint64_t host_stripe = 1)
+            : m_host_count(host_count), m_port_count(port_count), m_total(host_count * port_count),
+              m_order(order), m_stripe(std::max<uint64_t>(host_stripe, 1)), m_counter(0), m_bits(1), m_multiplier(0), m_offset(0) {
+            while ((uint64_t{1} << m_bits) < m_total) m_bits++;
+            m_multiplier = ((seed * 0x9E3779B97F4A7C15ULL) | 1) & mask();   // odd, so multiplication is invertible
+            m_offset = (seed >> 17) & mask();
+        }
+
+        uint64_t total() const { return m_total; }
+
+        bool next(uint64_t& host_index, uint64_t& port_index) {
+            uint64_t position;
+            do {
+                if (m_order != ScanOrder::Random ? m_counter >= m_total : m_counter > mask()) return false;
+                position = (m_order == ScanOrder::Random) ? permute(m_counter) : m_counter;
+                m_counter++;
+            } while (position >= m_total);
+
+            if (m_order == ScanOrder::HostMajor) {
+                const uint64_t stripe = position / (m_stripe * m_port_count);
+                const uint64_t first_host = stripe * m_stripe;
+                const uint64_t stripe_hosts = std::min(m_stripe, m_host_count - first_host);     // the last stripe may be short
+                const uint64_t offset = position - first_host * m_port_count;
+                host_index = first_host + offset % stripe_hosts;
+                port_index = offset / stripe_hosts;
+            }
+            else {
+                host_index = position % m_host_count;
+                port_index = position / m_host_count;
+            }
+            return true;
+        }
+
+    private:
+        uint64_t m_host_count;
+        uint64_t m_port_count;
+        uint64_t m_total;
+        ScanOrder m_order;
+        uint64_t m_stripe;          // hosts walked together in HostMajor order
+        uint64_t m_counter;
+        int m_bits;
+        uint64_t m_multiplier;
+        uint64_t m_offset;
+
+        uint64_t mask() const { return (m_bits >= 64) ? ~uint64_t{0} : (uint64_t{1} << m_bits) - 1; }
+
+        // Each step is a bijection on m_bits-wide values: add, odd multiply, and xor with a right shift
+        uint64_t permute(uint64_t value) const {
+            const int shift = (m_bits + 1) / 2;
+            for (int round = 0; round < 3; round++) {
+                value = (value + m_offset) & mask();
+                value = (value * m_multiplier) & mask();
+                value ^= value >> shift;
+            }
+            return value;
+        }
+    };
+
+    // Set bits in ascending order
+    inline std::vector<uint16_t> toList(const PortSet& ports) {
+        std::vector<uint16_t> list;
+        list.reserve(ports.count());
+        for (uint32_t port = 1; port < ports.size(); port++) {
+            if (ports.test(port)) list.push_back(static_cast<uint16_t>(port));
+        }
+        return list;
+    }
+
+}
+
+#endif // PORT_UTIL_H
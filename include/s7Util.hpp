@@ -0,0 +1,190 @@
+#ifndef S7_UTIL_H
+#define S7_UTIL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ISO-on-TCP (TPKT + COTP) and the few S7comm PDUs needed to identify a CPU:
+// setup communication and SZL reads. All multi-byte fields are big-endian.
+namespace s7Util {
+
+    constexpr uint16_t S7_PORT = 102;
+    constexpr uint8_t TPKT_VERSION = 0x03;
+    constexpr size_t TPKT_HEADER_SIZE = 4;
+    constexpr uint8_t COTP_CONNECT_REQUEST = 0xE0;
+    constexpr uint8_t COTP_CONNECT_CONFIRM = 0xD0;
+    constexpr uint8_t COTP_DATA = 0xF0;
+    constexpr uint8_t S7_PROTOCOL_ID = 0x32;
+    constexpr uint8_t ROSCTR_JOB = 0x01;
+    constexpr uint8_t ROSCTR_ACK_DATA = 0x03;
+    constexpr uint8_t ROSCTR_USERDATA = 0x07;
+    constexpr uint8_t RETURN_CODE_SUCCESS = 0xFF;
+
+    // Remote TSAPs worth trying: rack 0 slot 2 (S7-300/400), then the generic one S7-1200/1500 accept
+    constexpr uint16_t REMOTE_TSAPS[] = {0x0102, 0x0200};
+    constexpr uint16_t LOCAL_TSAP = 0x0100;
+
+    constexpr uint16_t SZL_MODULE_IDENTIFICATION = 0x0011;
+    constexpr uint16_t SZL_COMPONENT_IDENTIFICATION = 0x001C;
+
+    struct SZLRecord {
+        uint16_t index;
+        std::string data;   // raw record, layout depends on the SZL id
+    };
+
+    inline void appendU16(std::string& out, uint16_t value) {
+        out += static_cast<char>(value >> 8);
+        out += static_cast<char>(value & 0xFF);
+    }
+
+    inline uint16_t readU16(const std::string& data, size_t position) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(data[position]) << 8) | static_cast<uint8_t>(data[position + 1]));
+    }
+
+    inline std::string wrapTPKT(const std::string& payload) {
+        std::string packet;
+        packet += static_cast<char>(TPKT_VERSION);
+        packet += '\0';
+        appendU16(packet, static_cast<uint16_t>(payload.size() + TPKT_HEADER_SIZE));
+        return packet + payload;
+    }
+
+    // COTP data TPDU header: length 2, DT, last-data-unit flag
+    inline std::string wrapCOTPData(const std::string& s7_pdu) {
+        const std::string DATA_HEADER = {0x02, static_cast<char>(COTP_DATA), static_cast<char>(0x80)};
+        return wrapTPKT(DATA_HEADER + s7_pdu);
+    }
+
+    inline std::string buildConnectRequest(uint16_t remote_tsap) {
+        const uint8_t PARAM_CALLING_TSAP = 0xC1;
+        const uint8_t PARAM_CALLED_TSAP = 0xC2;
+        const uint8_t PARAM_TPDU_SIZE = 0xC0;
+        const uint8_t TPDU_SIZE_1024 = 0x0A;
+        std::string cotp;
+        cotp += static_cast<char>(COTP_CONNECT_REQUEST);
+        appendU16(cotp, 0x0000);    // destination reference
+        appendU16(cotp, 0x0001);    // source reference
+        cotp += '\0';               // class 0
+        cotp += static_cast<char>(PARAM_CALLING_TSAP);
+        cotp += static_cast<char>(2);
+        appendU16(cotp, LOCAL_TSAP);
+        cotp += static_cast<char>(PARAM_CALLED_TSAP);
+        cotp += static_cast<char>(2);
+        appendU16(cotp, remote_tsap);
+        cotp += static_cast<char>(PARAM_TPDU_SIZE);
+        cotp += static_cast<char>(1);
+        cotp += static_cast<char>(TPDU_SIZE_1024);
+        return wrapTPKT(static_cast<char>(cotp.size()) + cotp);   // length indicator excludes itself
+    }
+
+    inline std::string buildS7Header(uint8_t rosctr, uint16_t pdu_reference, uint16_t parameter_length, uint16_t data_length) {
+        std::string header;
+        header += static_cast<char>(S7_PROTOCOL_ID);
+        header += static_cast<char>(rosctr);
+        appendU16(header, 0x0000);  // reserved
+        appendU16(header, pdu_reference);
+        appendU16(header, parameter_length);
+        appendU16(header, data_length);
+        return header;
+    }
+
+    // Ask for one job at a time each way; a CPU should never see more than one request from us
+    inline std::string buildSetupCommunication(uint16_t pdu_reference) {
+        const uint8_t FUNCTION_SETUP_COMMUNICATION = 0xF0;
+        const uint16_t MAX_AMQ = 1;
+        const uint16_t PDU_LENGTH = 480;
+        std::string parameters;
+        parameters += static_cast<char>(FUNCTION_SETUP_COMMUNICATION);
+        parameters += '\0';
+        appendU16(parameters, MAX_AMQ);     // calling
+        appendU16(parameters, MAX_AMQ);     // called
+        appendU16(parameters, PDU_LENGTH);
+        return wrapCOTPData(buildS7Header(ROSCTR_JOB, pdu_reference, static_cast<uint16_t>(parameters.size()), 0) + parameters);
+    }
+
+    inline std::string buildReadSZL(uint16_t pdu_reference, uint16_t szl_id, uint16_t szl_index) {
+        const std::string PARAMETERS = {
+            0x00, 0x01, 0x12,           // parameter head
+            0x04,                       // parameter length
+            0x11,                       // request, type userdata
+            0x44,                       // function group: CPU functions
+            0x01,                       // subfunction: read SZL
+            0x00                        // sequence number
+        };
+        const uint8_t TRANSPORT_SIZE_OCTETS = 0x09;
+        std::string data;
+        data += static_cast<char>(RETURN_CODE_SUCCESS);
+        data += static_cast<char>(TRANSPORT_SIZE_OCTETS);
+        appendU16(data, 4);
+        appendU16(data, szl_id);
+        appendU16(data, szl_index);
+        return wrapCOTPData(buildS7Header(ROSCTR_USERDATA, pdu_reference, static_cast<uint16_t>(PARAMETERS.size()),
+                                          static_cast<uint16_t>(data.size())) + PARAMETERS + data);
+    }
+
+    // Take one TPKT off the front of a TCP stream. False when more bytes are needed;
+    // a corrupt header clears the stream since framing cannot be recovered.
+    inline bool popTPKT(std::string& stream, std::string& frame) {
+        if (stream.size() < TPKT_HEADER_SIZE) return false;
+        const uint16_t length = readU16(stream, 2);
+        if (static_cast<uint8_t>(stream[0]) != TPKT_VERSION || length < TPKT_HEADER_SIZE + 2) {
+            stream.clear();
+            return false;
+        }
+        if (stream.size() < length) return false;
+        frame.assign(stream, 0, length);
+        stream.erase(0, length);
+        return true;
+    }
+
+    inline bool isConnectConfirm(const std::string& frame) {
+        return frame.size() > TPKT_HEADER_SIZE + 1 && static_cast<uint8_t>(frame[TPKT_HEADER_SIZE + 1]) == COTP_CONNECT_CONFIRM;
+    }
+
+    // Locate the S7 PDU inside a COTP data frame, returns its offset or 0 if this is not one
+    inline size_t s7Offset(const std::string& frame) {
+        const size_t COTP_DATA_HEADER_SIZE = 3;
+        const size_t offset = TPKT_HEADER_SIZE + COTP_DATA_HEADER_SIZE;
+        if (frame.size() < offset + 10 || static_cast<uint8_t>(frame[TPKT_HEADER_SIZE + 1]) != COTP_DATA) return 0;
+        return static_cast<uint8_t>(frame[offset]) == S7_PROTOCOL_ID ? offset : 0;
+    }
+
+    // Ack-data header carries error class and code after the lengths
+    inline bool isSetupAcknowledged(const std::string& frame) {
+        const size_t offset = s7Offset(frame);
+        const size_t ACK_HEADER_SIZE = 12;
+        if (offset == 0 || frame.size() < offset + ACK_HEADER_SIZE) return false;
+        return static_cast<uint8_t>(frame[offset + 1]) == ROSCTR_ACK_DATA && readU16(frame, offset + 10) == 0;
+    }
+
+    inline bool parseSZLResponse(const std::string& frame, uint16_t szl_id, std::vector<SZLRecord>& records) {
+        records.clear();
+        const size_t offset = s7Offset(frame);
+        const size_t USERDATA_HEADER_SIZE = 10;
+        if (offset == 0 || static_cast<uint8_t>(frame[offset + 1]) != ROSCTR_USERDATA) return false;
+        const size_t data_offset = offset + USERDATA_HEADER_SIZE + readU16(frame, offset + 6);
+        const size_t SZL_HEADER_SIZE = 12;  // return code, transport size, length, SZL id, index, record length, count
+        if (frame.size() < data_offset + SZL_HEADER_SIZE) return false;
+        if (static_cast<uint8_t>(frame[data_offset]) != RETURN_CODE_SUCCESS || readU16(frame, data_offset + 4) != szl_id) return false;
+
+        const size_t record_length = readU16(frame, data_offset + 8);
+        const size_t record_count = readU16(frame, data_offset + 10);
+        size_t position = data_offset + SZL_HEADER_SIZE;
+        for (size_t i = 0; i < record_count && record_length >= 2 && position + record_length <= frame.size(); i++) {
+            records.push_back({readU16(frame, position), frame.substr(position + 2, record_length - 2)});
+            position += record_length;
+        }
+        return !records.empty();
+    }
+
+    // Text fields in SZL records are space or NUL padded
+    inline std::string trimText(const std::string& text) {
+        const size_t end = text.find_last_not_of(std::string(" \0", 2));
+        const std::string trimmed = (end == std::string::npos) ? "" : text.substr(0, end + 1);
+        return trimmed.substr(0, trimmed.find('\0'));
+    }
+
+}
+
+#endif // S7_UTIL_H
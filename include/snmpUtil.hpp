@@ -0,0 +1,263 @@
+#ifndef SNMP_UTIL_H
+#define SNMP_UTIL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal BER encoder/decoder for SNMPv2c GET / GETBULK and their responses.
+// Byte buffers are std::string, matching how the rest of the tool passes wire data around.
+namespace snmpUtil {
+
+    using OID = std::vector<uint32_t>;
+
+    constexpr uint16_t SNMP_PORT = 161;
+    constexpr int SNMP_VERSION_2C = 1;  // version field is zero-based on the wire
+
+    // Universal and SNMP application tags
+    constexpr uint8_t TAG_INTEGER = 0x02;
+    constexpr uint8_t TAG_OCTET_STRING = 0x04;
+    constexpr uint8_t TAG_NULL = 0x05;
+    constexpr uint8_t TAG_OID = 0x06;
+    constexpr uint8_t TAG_SEQUENCE = 0x30;
+    constexpr uint8_t TAG_IP_ADDRESS = 0x40;
+    constexpr uint8_t TAG_COUNTER32 = 0x41;
+    constexpr uint8_t TAG_GAUGE32 = 0x42;
+    constexpr uint8_t TAG_TIMETICKS = 0x43;
+    constexpr uint8_t TAG_COUNTER64 = 0x46;
+    constexpr uint8_t TAG_NO_SUCH_OBJECT = 0x80;
+    constexpr uint8_t TAG_NO_SUCH_INSTANCE = 0x81;
+    constexpr uint8_t TAG_END_OF_MIB_VIEW = 0x82;
+
+    // PDU tags
+    constexpr uint8_t PDU_GET = 0xA0;
+    constexpr uint8_t PDU_RESPONSE = 0xA2;
+    constexpr uint8_t PDU_GET_BULK = 0xA5;
+
+    struct VarBind {
+        OID oid;
+        uint8_t type;
+        std::string value;  // raw content octets, interpret with decodeInteger / as text by type
+    };
+
+    struct Response {
+        int32_t request_id;
+        int32_t error_status;
+        std::vector<VarBind> varbinds;
+    };
+
+    inline void appendLength(std::string& out, size_t length) {
+        if (length < 0x80) {    // short form
+            out += static_cast<char>(length);
+            return;
+        }
+        std::string length_bytes;
+        while (length > 0) {
+            length_bytes.insert(length_bytes.begin(), static_cast<char>(length & 0xFF));
+            length >>= 8;
+        }
+        out += static_cast<char>(0x80 | length_bytes.size());
+        out += length_bytes;
+    }
+
+    inline void appendTLV(std::string& out, uint8_t tag, const std::string& value) {
+        out += static_cast<char>(tag);
+        appendLength(out, value.size());
+        out += value;
+    }
+
+    inline std::string encodeInteger(int64_t value) {
+        std::string bytes;
+        do {    // two's complement, big endian, minimal length
+            bytes.insert(bytes.begin(), static_cast<char>(value & 0xFF));
+            value >>= 8;
+        } while (!((value == 0 && !(bytes.front() & 0x80)) || (value == -1 && (bytes.front() & 0x80))));
+        return bytes;
+    }
+
+    inline int64_t decodeInteger(const std::string& bytes) {
+        if (bytes.empty()) return 0;
+        int64_t value = (bytes[0] & 0x80) ? -1 : 0;   // sign extend
+        for (char byte : bytes) {
+            value = (value << 8) | static_cast<uint8_t>(byte);
+        }
+        return value;
+    }
+
+    // Application types (Counter32, Gauge32, TimeTicks, Counter64) are unsigned
+    inline uint64_t decodeUnsigned(const std::string& bytes) {
+        uint64_t value = 0;
+        for (char byte : bytes) {
+            value = (value << 8) | static_cast<uint8_t>(byte);
+        }
+        return value;
+    }
+
+    inline std::string encodeOID(const OID& oid) {
+        std::string bytes;
+        if (oid.size() < 2) return bytes;
+        const uint32_t FIRST_ARC_MULTIPLIER = 40;
+        std::vector<uint32_t> sub_ids;
+        sub_ids.push_back(oid[0] * FIRST_ARC_MULTIPLIER + oid[1]);
+        sub_ids.insert(sub_ids.end(), oid.begin() + 2, oid.end());
+        for (uint32_t sub_id : sub_ids) {   // base 128, high bit marks continuation
+            std::string encoded(1, static_cast<char>(sub_id & 0x7F));
+            sub_id >>= 7;
+            while (sub_id > 0) {
+                encoded.insert(encoded.begin(), static_cast<char>(0x80 | (sub_id & 0x7F)));
+                sub_id >>= 7;
+            }
+            bytes += encoded;
+        }
+        return bytes;
+    }
+
+    inline bool decodeOID(const std::string& bytes, OID& oid) {
+        oid.clear();
+        uint32_t sub_id = 0;
+        for (size_t i = 0; i < bytes.size(); i++) {
+            const uint8_t byte = static_cast<uint8_t>(bytes[i]);
+            sub_id = (sub_id << 7) | (byte & 0x7F);
+            if (byte & 0x80) continue;
+            if (oid.empty()) {  // first encoded value carries two arcs
+                const uint32_t first_arc = (sub_id < 40) ? 0 : (sub_id < 80) ? 1 : 2;
+                oid.push_back(first_arc);
+                oid.push_back(sub_id - first_arc * 40);
+            }
+            else {
+                oid.push_back(sub_id);
+            }
+            sub_id = 0;
+        }
+        return !oid.empty() && !(static_cast<uint8_t>(bytes.back()) & 0x80);
+    }
+
+    inline OID parseOID(const std::string& text) {
+        OID oid;
+        uint32_t sub_id = 0;
+        bool have_digit = false;
+        for (char c : text) {
+            if (c == '.') {
+                if (have_digit) oid.push_back(sub_id);
+                sub_id = 0;
+                have_digit = false;
+                continue;
+            }
+            sub_id = sub_id * 10 + (c - '0');
+            have_digit = true;
+        }
+        if (have_digit) oid.push_back(sub_id);
+        return oid;
+    }
+
+    inline std::string oidToString(const OID& oid) {
+        std::string text;
+        for (size_t i = 0; i < oid.size(); i++) {
+            if (i > 0) text += '.';
+            text += std::to_string(oid[i]);
+        }
+        return text;
+    }
+
+    // True when oid lies strictly inside the subtree rooted at base
+    inline bool isUnder(const OID& oid, const OID& base) {
+        return oid.size() > base.size() && std::equal(base.begin(), base.end(), oid.begin());
+    }
+
+    inline std::string buildRequest(uint8_t pdu_type, const std::string& community, int32_t request_id,
+                                    int32_t second_field, int32_t third_field, const std::vector<OID>& oids) {
+        std::string varbind_list;
+        for (const OID& oid : oids) {
+            std::string varbind;
+            appendTLV(varbind, TAG_OID, encodeOID(oid));
+            appendTLV(varbind, TAG_NULL, "");
+            appendTLV(varbind_list, TAG_SEQUENCE, varbind);
+        }
+
+        std::string pdu;
+        appendTLV(pdu, TAG_INTEGER, encodeInteger(request_id));
+        appendTLV(pdu, TAG_INTEGER, encodeInteger(second_field));  // error-status / non-repeaters
+        appendTLV(pdu, TAG_INTEGER, encodeInteger(third_field));   // error-index / max-repetitions
+        appendTLV(pdu, TAG_SEQUENCE, varbind_list);
+
+        std::string message;
+        appendTLV(message, TAG_INTEGER, encodeInteger(SNMP_VERSION_2C));
+        appendTLV(message, TAG_OCTET_STRING, community);
+        appendTLV(message, pdu_type, pdu);
+
+        std::string packet;
+        appendTLV(packet, TAG_SEQUENCE, message);
+        return packet;
+    }
+
+    inline std::string buildGet(const std::string& community, int32_t request_id, const std::vector<OID>& oids) {
+        return buildRequest(PDU_GET, community, request_id, 0, 0, oids);
+    }
+
+    inline std::string buildGetBulk(const std::string& community, int32_t request_id, int32_t max_repetitions,
+                                    const std::vector<OID>& oids) {
+        const int32_t NON_REPEATERS = 0;
+        return buildRequest(PDU_GET_BULK, community, request_id, NON_REPEATERS, max_repetitions, oids);
+    }
+
+    // Read one TLV at position, advancing position past it
+    inline bool readTLV(const std::string& data, size_t& position, uint8_t& tag, std::string& value) {
+        if (position + 2 > data.size()) return false;
+        tag = static_cast<uint8_t>(data[position++]);
+        size_t length = static_cast<uint8_t>(data[position++]);
+        if (length & 0x80) {    // long form
+            const size_t length_bytes = length & 0x7F;
+            if (length_bytes == 0 || length_bytes > 4 || position + length_bytes > data.size()) return false;
+            length = 0;
+            for (size_t i = 0; i < length_bytes; i++) {
+                length = (length << 8) | static_cast<uint8_t>(data[position++]);
+            }
+        }
+        if (position + length > data.size()) return false;
+        value = data.substr(position, length);
+        position += length;
+        return true;
+    }
+
+    inline bool parseResponse(const std::string& packet, Response& response) {
+        uint8_t tag;
+        std::string message;
+        size_t position = 0;
+        if (!readTLV(packet, position, tag, message) || tag != TAG_SEQUENCE) return false;
+
+        std::string field;
+        position = 0;
+        if (!readTLV(message, position, tag, field) || tag != TAG_INTEGER) return false;  // version
+        if (!readTLV(message, position, tag, field) || tag != TAG_OCTET_STRING) return false;  // community
+        std::string pdu;
+        if (!readTLV(message, position, tag, pdu) || tag != PDU_RESPONSE) return false;
+
+        position = 0;
+        if (!readTLV(pdu, position, tag, field) || tag != TAG_INTEGER) return false;
+        response.request_id = static_cast<int32_t>(decodeInteger(field));
+        if (!readTLV(pdu, position, tag, field) || tag != TAG_INTEGER) return false;
+        response.error_status = static_cast<int32_t>(decodeInteger(field));
+        if (!readTLV(pdu, position, tag, field) || tag != TAG_INTEGER) return false;  // error-index
+        std::string varbind_list;
+        if (!readTLV(pdu, position, tag, varbind_list) || tag != TAG_SEQUENCE) return false;
+
+        response.varbinds.clear();
+        position = 0;
+        std::string varbind;
+        while (position < varbind_list.size()) {
+            if (!readTLV(varbind_list, position, tag, varbind) || tag != TAG_SEQUENCE) return false;
+            size_t varbind_position = 0;
+            VarBind entry;
+            std::string oid_bytes;
+            if (!readTLV(varbind, varbind_position, tag, oid_bytes) || tag != TAG_OID) return false;
+            if (!decodeOID(oid_bytes, entry.oid)) return false;
+            if (!readTLV(varbind, varbind_position, entry.type, entry.value)) return false;
+            response.varbinds.push_back(entry);
+        }
+        return true;
+    }
+
+}
+
+#endif // SNMP_UTIL_H
@@ -0,0 +1,152 @@
+#ifndef UDP_PROBES_H
+#define UDP_PROBES_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "bacnetUtil.hpp"
+#include "enipUtil.hpp"
+#include "snmpUtil.hpp"
+
+// Per-port UDP probe payloads and reply validators for the UDP scan engine.
+// A UDP service only answers a request it understands, so every port needs its own payload;
+// the cookie is mixed into the request where the protocol echoes it, tying replies to this scan.
+namespace udpProbes {
+
+    // Stale = the protocol echoed a cookie that is not this scan's, so the reply answers some earlier request
+    enum class Verdict { Recognized, Unrecognized, Stale };
+
+    struct Probe {
+        uint16_t port;
+        const char* name;
+        std::string (*build)(uint32_t cookie);
+        // Recognized fills summary with a one-line description of the responder
+        Verdict (*validate)(const std::string& reply, uint32_t cookie, std::string& summary);
+    };
+
+    inline std::string buildSNMP(uint32_t cookie) {
+        const snmpUtil::OID SYS_DESCR = {1, 3, 6, 1, 2, 1, 1, 1, 0};
+        return snmpUtil::buildGet("public", static_cast<int32_t>(cookie & 0x7FFFFFFF), {SYS_DESCR});
+    }
+
+    inline Verdict validateSNMP(const std::string& reply, uint32_t cookie, std::string& summary) {
+        snmpUtil::Response response;
+        if (!snmpUtil::parseResponse(reply, response)) return Verdict::Unrecognized;
+        if (response.request_id != static_cast<int32_t>(cookie & 0x7FFFFFFF)) return Verdict::Stale;
+        summary = "SNMPv2c public";
+        if (!response.varbinds.empty() && response.varbinds[0].type == snmpUtil::TAG_OCTET_STRING) {
+            summary += ": " + response.varbinds[0].value.substr(0, response.varbinds[0].value.find_first_of("\r\n"));
+        }
+        return Verdict::Recognized;
+    }
+
+    inline std::string buildBACnet(uint32_t) {
+        return bacnetUtil::buildWhoIs(false, false, 0, 0);
+    }
+
+    // Devices that answer a unicast Who-Is with a broadcast I-Am to 47808 are missed here, the bacnet command catches those
+    inline Verdict validateBACnet(const std::string& reply, uint32_t, std::string& summary) {
+        size_t apdu_offset;
+        uint32_t forwarded_from;
+        bacnetUtil::Route source;
+        if (!bacnetUtil::parseHeaders(reply, apdu_offset, forwarded_from, source)) return Verdict::Unrecognized;
+        bacnetUtil::IAm i_am;
+        summary = bacnetUtil::parseIAm(reply, apdu_offset, i_am)
+            ? "BACnet device " + std::to_string(i_am.device_instance) + " vendor " + std::to_string(i_am.vendor_id)
+            : "BACnet/IP";
+        return Verdict::Recognized;
+    }
+
+    inline std::string buildENIP(uint32_t cookie) {
+        return enipUtil::buildListIdentity(cookie);
+    }
+
+    inline Verdict validateENIP(const std::string& reply, uint32_t cookie, std::string& summary) {
+        const size_t SENDER_CONTEXT_OFFSET = 12;
+        enipUtil::IdentityRecord record;
+        if (!enipUtil::parseListIdentity(reply, record)) return Verdict::Unrecognized;
+        if (enipUtil::readU32(reply, SENDER_CONTEXT_OFFSET) != cookie) return Verdict::Stale;
+        summary = std::string(enipUtil::vendorName(record.vendor_id)) + " " + record.product_name;
+        return Verdict::Recognized;
+    }
+
+    // Read request for a file that cannot exist; any TFTP server answers with an error packet
+    inline std::string buildTFTP(uint32_t cookie) {
+        const char HEX_DIGITS[] = "0123456789abcdef";
+        std::string request("\x00\x01", 2);
+        request += "nc-";
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            request += HEX_DIGITS[(cookie >> shift) & 0x0F];
+        }
+        request += std::string("\0octet\0", 7);
+        return request;
+    }
+
+    // Replies come from a fresh server port (the transfer ID), so only the payload is checked
+    inline Verdict validateTFTP(const std::string& reply, uint32_t, std::string& summary) {
+        const uint8_t OPCODE_DATA = 3;
+        const uint8_t OPCODE_ERROR = 5;
+        const size_t HEADER_SIZE = 4;
+        if (reply.size() < HEADER_SIZE || reply[0] != 0) return Verdict::Unrecognized;
+        const uint8_t opcode = static_cast<uint8_t>(reply[1]);
+        if (opcode == OPCODE_DATA) {
+            summary = "TFTP (served the probe file)";
+            return Verdict::Recognized;
+        }
+        if (opcode != OPCODE_ERROR) return Verdict::Unrecognized;
+        summary = "TFTP: " + std::string(reply.c_str() + HEADER_SIZE, strnlen(reply.c_str() + HEADER_SIZE, reply.size() - HEADER_SIZE));
+        return Verdict::Recognized;
+    }
+
+    inline std::string buildUbiquiti(uint32_t) {
+        return std::string("\x01\x00\x00\x00", 4);     // version 1 discovery, no TLVs
+    }
+
+    // Version 1 reply: version, command, u16 length, then type / u16 length / value records
+    inline Verdict validateUbiquiti(const std::string& reply, uint32_t, std::string& summary) {
+        const uint8_t FIELD_FIRMWARE = 0x03;
+        const uint8_t FIELD_HOSTNAME = 0x0B;
+        const uint8_t FIELD_MODEL = 0x0C;
+        const size_t HEADER_SIZE = 4;
+        if (reply.size() < HEADER_SIZE || reply[0] != 0x01) return Verdict::Unrecognized;
+        const size_t declared = (static_cast<uint8_t>(reply[2]) << 8) | static_cast<uint8_t>(reply[3]);
+        if (HEADER_SIZE + declared > reply.size()) return Verdict::Unrecognized;
+
+        std::string hostname, model, firmware;
+        size_t position = HEADER_SIZE;
+        while (position + 3 <= HEADER_SIZE + declared) {
+            const uint8_t type = static_cast<uint8_t>(reply[position]);
+            const size_t length = (static_cast<uint8_t>(reply[position + 1]) << 8) | static_cast<uint8_t>(reply[position + 2]);
+            position += 3;
+            if (position + length > reply.size()) return Verdict::Unrecognized;
+            if (type == FIELD_HOSTNAME) hostname = reply.substr(position, length);
+            if (type == FIELD_MODEL) model = reply.substr(position, length);
+            if (type == FIELD_FIRMWARE) firmware = reply.substr(position, length);
+            position += length;
+        }
+        summary = "Ubiquiti " + model + " " + hostname + (firmware.empty() ? "" : " (" + firmware + ")");
+        return Verdict::Recognized;
+    }
+
+    inline const std::vector<Probe>& registry() {
+        static const std::vector<Probe> PROBES = {
+            {snmpUtil::SNMP_PORT, "SNMP", buildSNMP, validateSNMP},
+            {69, "TFTP", buildTFTP, validateTFTP},
+            {10001, "Ubiquiti Discovery", buildUbiquiti, validateUbiquiti},
+            {enipUtil::ENIP_PORT, "EtherNet/IP", buildENIP, validateENIP},
+            {bacnetUtil::BACNET_PORT, "BACnet/IP", buildBACnet, validateBACnet},
+        };
+        return PROBES;
+    }
+
+    inline const Probe* findProbe(uint16_t port) {
+        for (const Probe& probe : registry()) {
+            if (probe.port == port) return &probe;
+        }
+        return nullptr;
+    }
+
+}
+
+#endif // UDP_PROBES_H
@@ -9,6 +9,17 @@
 #include "SecureShell.hpp"
 #include "PingScanner.hpp"
 #include "TCPScanner.hpp"
+#include "SNMPCollector.hpp"
+#include "OPCScanner.hpp"
+#include "ENIPScanner.hpp"
+#include "ModbusScanner.hpp"
+#include "S7Scanner.hpp"
+#include "BACnetScanner.hpp"
+#include "UDPScanner.hpp"
+#include "PassiveListener.hpp"
+#include "VendorLookup.hpp"
+#include "NameResolver.hpp"
+#include "Benchmark.hpp"
 
 const int MAIN_LOOP_DELAY_MS = 10;
 
@@ -35,6 +46,18 @@ int main() {
     SecureShell& secureShell = SecureShell::getInstance();
     PingScanner& pingScanner = PingScanner::getInstance();
     TCPScanner& tcpScanner = TCPScanner::getInstance();
+    SNMPCollector& snmpCollector = SNMPCollector::getInstance();
+    OPCExplorer& opcExplorer = OPCExplorer::getInstance();
+    OPCDiscoverer& opcDiscoverer = OPCDiscoverer::getInstance();
+    ENIPScanner& enipScanner = ENIPScanner::getInstance();
+    ModbusScanner& modbusScanner = ModbusScanner::getInstance();
+    S7Scanner& s7Scanner = S7Scanner::getInstance();
+    BACnetScanner& bacnetScanner = BACnetScanner::getInstance();
+    UDPScanner& udpScanner = UDPScanner::getInstance();
+    PassiveListener& passiveListener = PassiveListener::getInstance();
+    VendorLookup& vendorLookup = VendorLookup::getInstance();
+    NameResolver& nameResolver = NameResolver::getInstance();
+    Benchmark& benchmark = Benchmark::getInstance();
 
     while (CommandDispatcher::s_running) {    // Main loop
 
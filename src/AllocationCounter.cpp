@@ -0,0 +1,36 @@
+#include "memoryUtil.hpp"
+#include <atomic>
+#include <cstdlib>
+
+#ifdef COUNT_HEAP_ALLOCATIONS
+
+namespace {
+    std::atomic<size_t> heap_allocations(0);
+}
+
+// Array, nothrow and sized forms all forward to these two by default
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+size_t memoryUtil::heapAllocations() {
+    return heap_allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+size_t memoryUtil::heapAllocations() {
+    return 0;
+}
+
+#endif
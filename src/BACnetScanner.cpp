@@ -0,0 +1,282 @@
+#include "BACnetScanner.hpp"
+#include <chrono>
+#include <iostream>
+#include <ws2tcpip.h>
+#include "netUtil.hpp"
+
+BACnetScanner::BACnetScanner() : m_first_host(0), m_last_host(0), m_broadcast_address(0), m_ranged(false),
+                                 m_low_instance(0), m_high_instance(bacnetUtil::MAX_INSTANCE), m_read_details(false) {}
+
+bool BACnetScanner::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 3) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+    if (!netUtil::target_to_broadcast(arguments[0], m_broadcast_address)) {
+        m_broadcast_address = 0;
+    }
+
+    m_ranged = false;
+    m_read_details = false;
+    for (size_t i = 1; i < arguments.size(); i++) {
+        if (arguments[i] == "details") {
+            m_read_details = true;
+        }
+        else if (!parseInstanceRange(arguments[i])) {
+            std::cout << "Invalid instance range, use e.g. 1000-1999" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BACnetScanner::parseInstanceRange(const std::string& text) {
+    const size_t dash = text.find('-');
+    if (dash == std::string::npos) return false;
+    const std::string low = text.substr(0, dash);
+    const std::string high = text.substr(dash + 1);
+    const size_t MAX_INSTANCE_DIGITS = 7;
+    if (!netUtil::isNumeric(low) || !netUtil::isNumeric(high) || low.length() > MAX_INSTANCE_DIGITS
+        || high.length() > MAX_INSTANCE_DIGITS) {
+        return false;
+    }
+    m_low_instance = static_cast<uint32_t>(std::stoul(low));
+    m_high_instance = static_cast<uint32_t>(std::stoul(high));
+    m_ranged = true;
+    return m_low_instance <= m_high_instance && m_high_instance <= bacnetUtil::MAX_INSTANCE;
+}
+
+void BACnetScanner::handleCommand(const std::vector<std::string>& arguments) {
+
+    SOCKET udp_socket = openSocket();
+    if (udp_socket == INVALID_SOCKET) return;
+
+    const uint64_t host_count = static_cast<uint64_t>(m_last_host) - m_first_host + 1;
+    std::cout << "Sending Who-Is to " << host_count << " hosts"
+              << (m_broadcast_address ? " and " + netUtil::bits_to_address(m_broadcast_address) : "") << "..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    collectIAm(udp_socket);
+    if (m_read_details && !Devices.empty()) {
+        readDetails(udp_socket);
+    }
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+    closesocket(udp_socket);
+
+    report();
+    std::cout << "BACnet discovery complete. " << Devices.size() << " devices in " << elapsed_ms << " ms." << std::endl;
+}
+
+// Devices commonly broadcast their I-Am back to port 47808 rather than answering the sender,
+// so listen there when nothing else on this machine holds it
+SOCKET BACnetScanner::openSocket() {
+    SOCKET udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket == INVALID_SOCKET) {
+        std::cout << "Failed to create UDP socket" << std::endl;
+        return INVALID_SOCKET;
+    }
+    BOOL enable = TRUE;
+    setsockopt(udp_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+    setsockopt(udp_socket, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+    sockaddr_in local_address = {};
+    local_address.sin_family = AF_INET;
+    local_address.sin_port = htons(bacnetUtil::BACNET_PORT);
+    local_address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(udp_socket, reinterpret_cast<sockaddr*>(&local_address), sizeof(local_address)) == SOCKET_ERROR) {
+        std::cout << "Port " << bacnetUtil::BACNET_PORT << " is in use, only unicast I-Am replies will be seen" << std::endl;
+        local_address.sin_port = 0;
+        bind(udp_socket, reinterpret_cast<sockaddr*>(&local_address), sizeof(local_address));
+    }
+
+    u_long non_blocking_mode = 1;
+    ioctlsocket(udp_socket, FIONBIO, &non_blocking_mode);
+    BOOL report_port_unreachable = FALSE;   // otherwise one closed host makes recvfrom fail with WSAECONNRESET
+    DWORD bytes_returned = 0;
+    WSAIoctl(udp_socket, SIO_UDP_CONNRESET, &report_port_unreachable, sizeof(report_port_unreachable),
+             nullptr, 0, &bytes_returned, nullptr, nullptr);
+    return udp_socket;
+}
+
+void BACnetScanner::sendTo(SOCKET udp_socket, uint32_t address, const std::string& packet) {
+    sockaddr_storage target_address;
+    const int target_length = netUtil::toSocketAddress(address, bacnetUtil::BACNET_PORT, target_address);
+    netUtil::sendDatagram(udp_socket, packet, reinterpret_cast<sockaddr*>(&target_address), target_length);
+}
+
+// One global-broadcast Who-Is reaches the local network and, through routers, every MS/TP trunk
+// behind them; the unicast sweep covers IP subnets the broadcast cannot reach. Every I-Am that
+// arrives within the window is kept, whichever request drew it.
+void BACnetScanner::collectIAm(SOCKET udp_socket) {
+
+    Devices.clear();
+    const uint64_t DRAIN_EVERY_SENDS = 64;
+    const int MAX_DATAGRAM_SIZE = 1500;
+    std::string receive_buffer(MAX_DATAGRAM_SIZE, '\0');
+    std::string packet;
+
+    auto drain_replies = [&]() {
+        while (true) {
+            sockaddr_in sender_address = {};
+            socklen_t sender_length = sizeof(sender_address);
+            int bytes_received = recvfrom(udp_socket, &receive_buffer[0], MAX_DATAGRAM_SIZE, 0,
+                                          reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+            if (bytes_received <= 0) break;
+            packet.assign(receive_buffer.data(), bytes_received);
+
+            size_t apdu_offset;
+            uint32_t forwarded_from;
+            bacnetUtil::Route source;
+            bacnetUtil::IAm i_am;
+            if (!bacnetUtil::parseHeaders(packet, apdu_offset, forwarded_from, source)) continue;
+            if (!bacnetUtil::parseIAm(packet, apdu_offset, i_am)) continue;     // includes our own Who-Is echoing back
+            if (m_ranged && (i_am.device_instance < m_low_instance || i_am.device_instance > m_high_instance)) continue;
+
+            DeviceRecord& device = Devices[i_am.device_instance];
+            device.address = netUtil::bits_to_address(forwarded_from ? forwarded_from : ntohl(sender_address.sin_addr.s_addr));
+            device.route = source;
+            device.max_apdu = i_am.max_apdu;
+            device.segmentation = i_am.segmentation;
+            device.vendor_id = i_am.vendor_id;
+        }
+    };
+
+    if (m_broadcast_address) {
+        sendTo(udp_socket, m_broadcast_address, bacnetUtil::buildWhoIs(true, m_ranged, m_low_instance, m_high_instance));
+    }
+    const std::string unicast_who_is = bacnetUtil::buildWhoIs(false, m_ranged, m_low_instance, m_high_instance);
+    uint64_t sent = 0;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        sendTo(udp_socket, static_cast<uint32_t>(host), unicast_who_is);
+        if (++sent % DRAIN_EVERY_SENDS == 0) drain_replies();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WINDOW_MS);
+    while (true) {
+        const auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining_ms <= 0) break;
+        WSAPOLLFD poll_descriptor = {};
+        poll_descriptor.fd = udp_socket;
+        poll_descriptor.events = POLLRDNORM;
+        WSAPoll(&poll_descriptor, 1, static_cast<int>(remaining_ms));
+        drain_replies();
+    }
+}
+
+// One ReadPropertyMultiple per device for vendor, model, name and versions, with up to
+// MAX_OUTSTANDING requests in flight, matched back by invoke id
+void BACnetScanner::readDetails(SOCKET udp_socket) {
+
+    const size_t MAX_OUTSTANDING = 32;      // well inside the 256 invoke ids, gentle on small controllers
+    const int MAX_RETRIES = 1;
+    const auto REQUEST_TIMEOUT = std::chrono::milliseconds(1000);
+    const int POLL_INTERVAL_MS = 10;
+    const int MAX_DATAGRAM_SIZE = 1500;
+    const std::vector<uint32_t> PROPERTIES = {
+        bacnetUtil::PROPERTY_VENDOR_NAME, bacnetUtil::PROPERTY_MODEL_NAME, bacnetUtil::PROPERTY_OBJECT_NAME,
+        bacnetUtil::PROPERTY_FIRMWARE_REVISION, bacnetUtil::PROPERTY_APPLICATION_SOFTWARE_VERSION
+    };
+
+    struct PendingRead {
+        uint32_t device_instance;
+        int retries;
+        std::chrono::steady_clock::time_point sent_at;
+    };
+
+    std::vector<uint32_t> queue;
+    for (const auto& [instance, device] : Devices) {
+        queue.push_back(instance);
+    }
+    std::map<uint8_t, PendingRead> pending;     // invoke id -> request
+    size_t next_device = 0;
+    uint8_t next_invoke_id = 0;
+    std::string receive_buffer(MAX_DATAGRAM_SIZE, '\0');
+    std::string packet;
+
+    auto send_read = [&](uint8_t invoke_id, PendingRead& read) {
+        const DeviceRecord& device = Devices[read.device_instance];
+        uint32_t address = 0;
+        netUtil::ipToBinary(device.address, address);
+        sendTo(udp_socket, address, bacnetUtil::buildReadPropertyMultiple(invoke_id, read.device_instance, device.route, PROPERTIES));
+        read.sent_at = std::chrono::steady_clock::now();
+    };
+
+    while (next_device < queue.size() || !pending.empty()) {
+
+        while (next_device < queue.size() && pending.size() < MAX_OUTSTANDING) {   // fill the window
+            while (pending.count(next_invoke_id)) next_invoke_id++;     // wraps at 256, never full
+            PendingRead& read = pending[next_invoke_id];
+            read = {queue[next_device++], 0, {}};
+            send_read(next_invoke_id++, read);
+        }
+
+        WSAPOLLFD poll_descriptor = {};
+        poll_descriptor.fd = udp_socket;
+        poll_descriptor.events = POLLRDNORM;
+        WSAPoll(&poll_descriptor, 1, POLL_INTERVAL_MS);
+
+        while (true) {
+            sockaddr_in sender_address = {};
+            socklen_t sender_length = sizeof(sender_address);
+            int bytes_received = recvfrom(udp_socket, &receive_buffer[0], MAX_DATAGRAM_SIZE, 0,
+                                          reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+            if (bytes_received <= 0) break;
+            packet.assign(receive_buffer.data(), bytes_received);
+
+            size_t apdu_offset;
+            uint32_t forwarded_from;
+            bacnetUtil::Route source;
+            if (!bacnetUtil::parseHeaders(packet, apdu_offset, forwarded_from, source)) continue;
+            if (apdu_offset + 2 > packet.size()) continue;
+            const uint8_t pdu_type = static_cast<uint8_t>(packet[apdu_offset]) & bacnetUtil::PDU_TYPE_MASK;
+            auto read = pending.find(static_cast<uint8_t>(packet[apdu_offset + 1]));
+            if (pdu_type == bacnetUtil::PDU_UNCONFIRMED_REQUEST || read == pending.end()) continue;
+            DeviceRecord& device = Devices[read->second.device_instance];
+            if (netUtil::bits_to_address(ntohl(sender_address.sin_addr.s_addr)) != device.address) continue;
+
+            uint8_t invoke_id;
+            bacnetUtil::parseReadPropertyMultipleAck(packet, apdu_offset, invoke_id, device.properties);
+            pending.erase(read);    // answered, or Error / Reject / Abort from a device without RPM
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto read = pending.begin(); read != pending.end();) {     // retry or give up on lost requests
+            if (now - read->second.sent_at < REQUEST_TIMEOUT) {
+                ++read;
+                continue;
+            }
+            if (++read->second.retries > MAX_RETRIES) {
+                read = pending.erase(read);
+                continue;
+            }
+            send_read(read->first, read->second);
+            ++read;
+        }
+    }
+}
+
+void BACnetScanner::report() {
+    auto property = [](const DeviceRecord& device, uint32_t property_id) {
+        auto value = device.properties.find(property_id);
+        return (value != device.properties.end()) ? value->second : std::string();
+    };
+    for (const auto& [instance, device] : Devices) {
+        std::cout << "device " << instance << "  " << device.address;
+        if (device.route.network != 0) {
+            std::cout << " -> network " << device.route.network << " mac ";
+            for (char octet : device.route.mac) {
+                std::cout << static_cast<int>(static_cast<uint8_t>(octet)) << ' ';
+            }
+        }
+        std::cout << "  vendor id " << device.vendor_id << std::endl;
+        if (!device.properties.empty()) {
+            std::cout << "  " << property(device, bacnetUtil::PROPERTY_VENDOR_NAME) << " "
+                      << property(device, bacnetUtil::PROPERTY_MODEL_NAME)
+                      << "  \"" << property(device, bacnetUtil::PROPERTY_OBJECT_NAME) << "\""
+                      << "  firmware " << property(device, bacnetUtil::PROPERTY_FIRMWARE_REVISION)
+                      << "  application " << property(device, bacnetUtil::PROPERTY_APPLICATION_SOFTWARE_VERSION) << std::endl;
+        }
+    }
+}
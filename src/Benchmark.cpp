@@ -0,0 +1,136 @@
+#include "Benchmark.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <random>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "netUtil.hpp"
+#include "memoryUtil.hpp"
+
+namespace {
+    constexpr size_t SLOT = netUtil::IPV4_TEXT_MAX + 1;
+    static_assert(SLOT >= netUtil::IPV4_PARSE_LOOKAHEAD, "slots must cover the vector parser's read");
+
+    long long elapsedNs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+Benchmark::Benchmark() : m_count(DEFAULT_COUNT) {}
+
+bool Benchmark::validateInput(const std::vector<std::string>& arguments) {
+    const size_t MAX_COUNT = 1000000000;
+    if (arguments.empty() || arguments.size() > 2 || arguments[0] != "ipv4") {
+        return false;
+    }
+    m_count = DEFAULT_COUNT;
+    if (arguments.size() == 2) {
+        const std::string& text = arguments[1];
+        const std::from_chars_result parsed = std::from_chars(text.data(), text.data() + text.size(), m_count);
+        if (parsed.ec != std::errc() || parsed.ptr != text.data() + text.size() || m_count == 0 || m_count > MAX_COUNT) {
+            std::cout << "Invalid count, expected 1 to " << MAX_COUNT << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void Benchmark::handleCommand(const std::vector<std::string>& arguments) {
+    benchIPv4();
+}
+
+void Benchmark::benchIPv4() {
+    const uint32_t SEED = 0x1CEB00DA;       // fixed, so runs compare like for like
+    const size_t set_size = std::min(m_count, WORKING_SET);
+    const size_t rounds = (m_count + set_size - 1) / set_size;
+    const size_t conversions = rounds * set_size;
+
+    std::mt19937 generator(SEED);
+    m_addresses.resize(set_size);
+    for (uint32_t& address : m_addresses) {
+        address = generator();
+    }
+    m_texts.assign(set_size * SLOT, '\0');
+    std::vector<char> library_texts(set_size * SLOT, '\0');
+
+    std::cout << "IPv4 text, " << conversions << " conversions each over " << set_size << " addresses ("
+              << (netUtil::ipv4VectorParse() ? "SSSE3" : "scalar") << " parseIPv4)" << std::endl;
+
+    // formatting: ours into m_texts, inet_ntop into library_texts, which must come out identical
+    size_t allocations = memoryUtil::heapAllocations();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < set_size; i++) {
+            char* slot = m_texts.data() + i * SLOT;
+            char* end = netUtil::formatIPv4(slot, slot + SLOT, m_addresses[i]);
+            *end = '\0';        // the fast path copies whole 4 byte blocks, so it leaves a dot behind
+        }
+    }
+    report("formatIPv4", conversions, elapsedNs(start), memoryUtil::heapAllocations() - allocations);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < set_size; i++) {
+            struct in_addr address;
+            address.s_addr = htonl(m_addresses[i]);
+            inet_ntop(AF_INET, &address, library_texts.data() + i * SLOT, SLOT);
+        }
+    }
+    report("inet_ntop", conversions, elapsedNs(start), 0);
+    if (m_texts != library_texts) {
+        std::cout << "formatIPv4 disagrees with inet_ntop" << std::endl;
+        return;
+    }
+
+    // parsing: each pass sums what it parsed, which both checks the round trip and keeps the work alive
+    uint64_t expected_sum = 0;
+    for (uint32_t address : m_addresses) expected_sum += address;
+    expected_sum *= rounds;
+
+    struct ParsePass {
+        const char* name;
+        const char* (*parse)(const char*, const char*, uint32_t&);
+    };
+    const ParsePass PASSES[] = {
+        { "parseIPv4", netUtil::parseIPv4 },
+        { "parseIPv4Scalar", netUtil::parseIPv4Scalar },
+    };
+    for (const ParsePass& pass : PASSES) {
+        uint64_t sum = 0;
+        allocations = memoryUtil::heapAllocations();
+        start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; round++) {
+            for (size_t i = 0; i < set_size; i++) {
+                const char* slot = m_texts.data() + i * SLOT;
+                uint32_t ip = 0;
+                if (pass.parse(slot, slot + SLOT, ip) != nullptr) sum += ip;
+            }
+        }
+        report(pass.name, conversions, elapsedNs(start), memoryUtil::heapAllocations() - allocations);
+        if (sum != expected_sum) std::cout << pass.name << " did not round trip" << std::endl;
+    }
+
+    uint64_t sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < set_size; i++) {
+            struct in_addr address;
+            if (inet_pton(AF_INET, m_texts.data() + i * SLOT, &address) == 1) sum += ntohl(address.s_addr);
+        }
+    }
+    report("inet_pton", conversions, elapsedNs(start), 0);
+    if (sum != expected_sum) std::cout << "inet_pton did not round trip" << std::endl;
+}
+
+void Benchmark::report(const char* name, size_t conversions, long long elapsed_ns, size_t allocations) {
+    const double NS_PER_SECOND = 1e9;
+    const double elapsed = elapsed_ns > 0 ? static_cast<double>(elapsed_ns) : 1.0;
+    std::cout << "  " << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << conversions * NS_PER_SECOND / elapsed / 1e6 << " M/s  "
+              << std::setprecision(2) << std::setw(6) << elapsed / conversions << " ns each";
+    if (memoryUtil::COUNTING_ALLOCATIONS && allocations > 0) std::cout << ", " << allocations << " heap allocations";
+    std::cout << std::defaultfloat << std::endl;
+}
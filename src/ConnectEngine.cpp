@@ -0,0 +1,200 @@
+#include "ConnectEngine.hpp"
+#include <ws2tcpip.h>
+#include "TCPScanner.hpp"
+
+#pragma comment(lib, "mswsock.lib")
+
+PollConnectEngine::PollConnectEngine(size_t capacity) : m_ipv6_hosts(nullptr) {
+    m_pending.reserve(capacity);
+    m_poll_descriptors.reserve(capacity);
+}
+
+PollConnectEngine::~PollConnectEngine() {
+    for (const PendingConnect& pending : m_pending) {
+        closesocket(pending.tcp_socket);
+    }
+}
+
+bool PollConnectEngine::start(uint32_t host, int port) {
+    SOCKET tcp_socket = m_ipv6_hosts ? TCPScanner::startConnect(m_ipv6_hosts[host], port) : TCPScanner::startConnect(host, port);
+    if (tcp_socket == INVALID_SOCKET) return false;
+    m_pending.push_back({tcp_socket, host, port, std::chrono::steady_clock::now()});
+    return true;
+}
+
+void PollConnectEngine::collect(int wait_ms, std::chrono::milliseconds connect_timeout, std::vector<ConnectCompletion>& completions) {
+    m_poll_descriptors.resize(m_pending.size());
+    for (size_t i = 0; i < m_pending.size(); i++) {
+        m_poll_descriptors[i].fd = m_pending[i].tcp_socket;
+        m_poll_descriptors[i].events = POLLWRNORM;    // writable = handshake finished
+        m_poll_descriptors[i].revents = 0;
+    }
+    WSAPoll(m_poll_descriptors.data(), static_cast<ULONG>(m_poll_descriptors.size()), wait_ms);
+
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = m_pending.size(); i-- > 0;) {     // walk backwards so swap-removal never skips an entry
+        const PendingConnect& pending = m_pending[i];
+        const short events = m_poll_descriptors[i].revents;
+        if (events & (POLLWRNORM | POLLERR | POLLHUP)) {
+            completions.push_back({pending.host, pending.port, TCPScanner::connectError(pending.tcp_socket), false});
+        }
+        else if (now - pending.started_at >= connect_timeout) {
+            completions.push_back({pending.host, pending.port, 0, true});
+        }
+        else {
+            continue;
+        }
+        closesocket(pending.tcp_socket);
+        m_pending[i] = m_pending.back();
+        m_pending.pop_back();
+    }
+}
+
+IocpConnectEngine::IocpConnectEngine(memoryUtil::Arena& arena, size_t capacity)
+    : m_arena(arena), m_ipv6_hosts(nullptr), m_completion_port(nullptr), m_connect_ex(nullptr), m_in_flight(0), m_kernel_owned(0) {
+    m_free_operations.reserve(capacity);
+    m_timeouts.reserve(capacity);
+    m_immediate.reserve(capacity);
+}
+
+IocpConnectEngine::~IocpConnectEngine() {
+    for (; !m_timeouts.empty(); m_timeouts.pop_front()) {     // abort whatever is still connecting
+        const TimeoutEntry& entry = m_timeouts.front();
+        if (entry.operation->generation == entry.generation && entry.operation->tcp_socket != INVALID_SOCKET) {
+            closesocket(entry.operation->tcp_socket);
+            entry.operation->tcp_socket = INVALID_SOCKET;
+        }
+    }
+    // the kernel writes to each OVERLAPPED until its completion is dequeued, so drain before freeing
+    const int DRAIN_WAIT_MS = 100;
+    const int MAX_DRAIN_ROUNDS = 50;
+    std::vector<ConnectCompletion> discarded;
+    for (int round = 0; round < MAX_DRAIN_ROUNDS && m_kernel_owned > 0; round++) {
+        reap(DRAIN_WAIT_MS, discarded);
+    }
+    if (m_completion_port) CloseHandle(m_completion_port);
+}
+
+bool IocpConnectEngine::open() {
+    m_completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!m_completion_port) return false;
+
+    // ConnectEx is an extension function, its address comes from the provider through any TCP socket
+    SOCKET probe_socket = socket(m_ipv6_hosts ? AF_INET6 : AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (probe_socket == INVALID_SOCKET) return false;
+    GUID connect_ex_id = WSAID_CONNECTEX;
+    DWORD bytes_returned = 0;
+    const int result = WSAIoctl(probe_socket, SIO_GET_EXTENSION_FUNCTION_POINTER, &connect_ex_id, sizeof(connect_ex_id),
+                                &m_connect_ex, sizeof(m_connect_ex), &bytes_returned, nullptr, nullptr);
+    closesocket(probe_socket);
+    return result == 0 && m_connect_ex != nullptr;
+}
+
+bool IocpConnectEngine::start(uint32_t host, int port) {
+    sockaddr_storage target_address;
+    const int target_length = m_ipv6_hosts ? netUtil::toSocketAddress(m_ipv6_hosts[host], static_cast<uint16_t>(port), target_address)
+                                           : netUtil::toSocketAddress(host, static_cast<uint16_t>(port), target_address);
+    SOCKET tcp_socket = WSASocket(target_address.ss_family, SOCK_STREAM, IPPROTO_TCP, nullptr, 0, WSA_FLAG_OVERLAPPED);
+    if (tcp_socket == INVALID_SOCKET) return false;
+
+    sockaddr_storage local_address = {};    // ConnectEx only accepts bound sockets, the wildcard of the target's family
+    local_address.ss_family = target_address.ss_family;
+    if (bind(tcp_socket, reinterpret_cast<sockaddr*>(&local_address), target_length) == SOCKET_ERROR
+        || !CreateIoCompletionPort(reinterpret_cast<HANDLE>(tcp_socket), m_completion_port, 0, 0)) {
+        closesocket(tcp_socket);
+        return false;
+    }
+
+    Operation* operation = acquire();
+    operation->overlapped = {};
+    operation->tcp_socket = tcp_socket;
+    operation->host = host;
+    operation->port = port;
+    operation->reported = false;
+    operation->started_at = std::chrono::steady_clock::now();
+    m_in_flight++;
+
+    if (!m_connect_ex(tcp_socket, reinterpret_cast<sockaddr*>(&target_address), target_length,
+                      nullptr, 0, nullptr, &operation->overlapped)) {
+        const int error = WSAGetLastError();
+        if (error != ERROR_IO_PENDING) {    // failed before reaching the port, report on the next collect
+            m_immediate.push_back({host, port, error, false});
+            closesocket(tcp_socket);
+            release(operation);
+            return true;
+        }
+    }
+    m_kernel_owned++;
+    m_timeouts.push_back({operation, operation->generation});
+    return true;
+}
+
+void IocpConnectEngine::collect(int wait_ms, std::chrono::milliseconds connect_timeout, std::vector<ConnectCompletion>& completions) {
+    for (const ConnectCompletion& completion : m_immediate) {
+        completions.push_back(completion);
+        m_in_flight--;
+    }
+    m_immediate.clear();
+    // read the clock first: anything that completed before it is in the queue by the time reap drains it,
+    // so a connect finishing in the same pass as its deadline is reported as finished, not timed out
+    const auto now = std::chrono::steady_clock::now();
+    reap(completions.empty() ? wait_ms : 0, completions);
+
+    while (!m_timeouts.empty()) {
+        const TimeoutEntry entry = m_timeouts.front();
+        Operation* operation = entry.operation;
+        if (operation->generation != entry.generation || operation->reported) {    // finished since it was queued
+            m_timeouts.pop_front();
+            continue;
+        }
+        if (now - operation->started_at < connect_timeout) break;
+        m_timeouts.pop_front();
+        operation->reported = true;
+        m_in_flight--;
+        completions.push_back({operation->host, operation->port, 0, true});
+        closesocket(operation->tcp_socket);     // aborts the ConnectEx; its completion still arrives
+        operation->tcp_socket = INVALID_SOCKET;
+    }
+}
+
+void IocpConnectEngine::reap(int wait_ms, std::vector<ConnectCompletion>& completions) {
+    const ULONG MAX_ENTRIES_PER_CALL = 128;
+    OVERLAPPED_ENTRY entries[MAX_ENTRIES_PER_CALL];
+    ULONG entry_count = 0;
+    do {    // drain the whole queue, a full batch means more may be waiting
+        if (!GetQueuedCompletionStatusEx(m_completion_port, entries, MAX_ENTRIES_PER_CALL, &entry_count, wait_ms, FALSE)) {
+            return;     // timed out with nothing ready
+        }
+        wait_ms = 0;
+        for (ULONG i = 0; i < entry_count; i++) {
+            Operation* operation = CONTAINING_RECORD(entries[i].lpOverlapped, Operation, overlapped);
+            m_kernel_owned--;
+            if (!operation->reported) {
+                DWORD bytes_transferred = 0;
+                DWORD flags = 0;
+                const int error = WSAGetOverlappedResult(operation->tcp_socket, &operation->overlapped, &bytes_transferred, FALSE, &flags)
+                    ? 0 : WSAGetLastError();
+                completions.push_back({operation->host, operation->port, error, false});
+                operation->reported = true;
+                m_in_flight--;
+            }
+            if (operation->tcp_socket != INVALID_SOCKET) closesocket(operation->tcp_socket);
+            release(operation);
+        }
+    } while (entry_count == MAX_ENTRIES_PER_CALL);
+}
+
+IocpConnectEngine::Operation* IocpConnectEngine::acquire() {
+    if (m_free_operations.empty()) {     // value-initialised, generation starts at 0
+        return m_arena.allocateArray<Operation>(1);
+    }
+    Operation* operation = m_free_operations.back();
+    m_free_operations.pop_back();
+    return operation;
+}
+
+void IocpConnectEngine::release(Operation* operation) {
+    operation->generation++;
+    operation->tcp_socket = INVALID_SOCKET;
+    m_free_operations.push_back(operation);
+}
@@ -0,0 +1,154 @@
+#include "ENIPScanner.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "netUtil.hpp"
+
+ENIPScanner::ENIPScanner() : m_first_host(0), m_last_host(0), m_broadcast_address(0), m_window_ms(DEFAULT_WINDOW_MS) {}
+
+bool ENIPScanner::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 2) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+
+    if (!netUtil::target_to_broadcast(arguments[0], m_broadcast_address)) {
+        m_broadcast_address = 0;
+    }
+
+    m_window_ms = DEFAULT_WINDOW_MS;
+    if (arguments.size() == 2) {
+        const size_t MAX_WINDOW_DIGITS = 5;
+        if (!netUtil::isNumeric(arguments[1]) || arguments[1].length() > MAX_WINDOW_DIGITS || std::stoi(arguments[1]) == 0) {
+            std::cout << "Invalid window (ms)" << std::endl;
+            return false;
+        }
+        m_window_ms = std::stoi(arguments[1]);
+    }
+    return true;
+}
+
+void ENIPScanner::handleCommand(const std::vector<std::string>& arguments) {
+
+    const uint64_t host_count = static_cast<uint64_t>(m_last_host) - m_first_host + 1;
+    std::cout << "Sending ListIdentity to " << host_count << " hosts"
+              << (m_broadcast_address ? " and " + netUtil::bits_to_address(m_broadcast_address) : "") << "..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    discover();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    std::cout << "ListIdentity complete. " << Devices.size() << " devices answered in " << elapsed_ms << " ms." << std::endl;
+}
+
+// One socket for the whole burst: the directed broadcast reaches on-link devices in one datagram,
+// the unicast sweep reaches routed subnets where broadcasts are dropped. Replies are drained while
+// sending so a large sweep cannot overflow the receive buffer, then for m_window_ms after the last send.
+void ENIPScanner::discover() {
+
+    Devices.clear();
+    SOCKET udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket == INVALID_SOCKET) {
+        std::cout << "Failed to create UDP socket" << std::endl;
+        return;
+    }
+    u_long non_blocking_mode = 1;
+    ioctlsocket(udp_socket, FIONBIO, &non_blocking_mode);
+    BOOL allow_broadcast = TRUE;
+    setsockopt(udp_socket, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&allow_broadcast), sizeof(allow_broadcast));
+    BOOL report_port_unreachable = FALSE;   // otherwise one closed host makes recvfrom fail with WSAECONNRESET
+    DWORD bytes_returned = 0;
+    WSAIoctl(udp_socket, SIO_UDP_CONNRESET, &report_port_unreachable, sizeof(report_port_unreachable),
+             nullptr, 0, &bytes_returned, nullptr, nullptr);
+
+    const int SEND_BLOCKED_WAIT_MS = 5;
+    const uint64_t DRAIN_EVERY_SENDS = 64;
+    const int MAX_DATAGRAM_SIZE = 1500;
+
+    // devices echo the sender context, so replies to someone else's scan are ignored
+    const uint64_t sender_context = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    const std::string request = enipUtil::buildListIdentity(sender_context);
+    std::string receive_buffer(MAX_DATAGRAM_SIZE, '\0');
+    std::string packet;
+
+    auto drain_replies = [&]() {
+        while (true) {
+            sockaddr_in sender_address = {};
+            socklen_t sender_length = sizeof(sender_address);
+            int bytes_received = recvfrom(udp_socket, &receive_buffer[0], MAX_DATAGRAM_SIZE, 0,
+                                          reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+            if (bytes_received <= 0) break;
+            packet.assign(receive_buffer.data(), bytes_received);
+            storeReply(packet, ntohl(sender_address.sin_addr.s_addr), sender_context);
+        }
+    };
+
+    auto send_request = [&](uint32_t address) {
+        sockaddr_in target_address = {};
+        target_address.sin_family = AF_INET;
+        target_address.sin_port = htons(enipUtil::ENIP_PORT);
+        target_address.sin_addr.s_addr = htonl(address);
+        while (sendto(udp_socket, request.data(), static_cast<int>(request.size()), 0,
+                      reinterpret_cast<sockaddr*>(&target_address), sizeof(target_address)) == SOCKET_ERROR) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) return;    // unreachable network etc., nothing to wait for
+            WSAPOLLFD poll_descriptor = {};
+            poll_descriptor.fd = udp_socket;
+            poll_descriptor.events = POLLWRNORM;
+            WSAPoll(&poll_descriptor, 1, SEND_BLOCKED_WAIT_MS);
+            drain_replies();
+        }
+    };
+
+    if (m_broadcast_address) {
+        send_request(m_broadcast_address);
+    }
+    uint64_t sent = 0;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        send_request(static_cast<uint32_t>(host));
+        if (++sent % DRAIN_EVERY_SENDS == 0) drain_replies();
+    }
+
+    const uint64_t host_count = static_cast<uint64_t>(m_last_host) - m_first_host + 1;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_window_ms);
+    while (m_broadcast_address || Devices.size() < host_count) {    // a broadcast can draw replies from anyone
+        const auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining_ms <= 0) break;
+        WSAPOLLFD poll_descriptor = {};
+        poll_descriptor.fd = udp_socket;
+        poll_descriptor.events = POLLRDNORM;
+        WSAPoll(&poll_descriptor, 1, static_cast<int>(remaining_ms));
+        drain_replies();
+    }
+
+    closesocket(udp_socket);
+}
+
+bool ENIPScanner::storeReply(const std::string& packet, uint32_t sender, uint64_t sender_context) {
+    const size_t SENDER_CONTEXT_OFFSET = 12;
+    if (packet.size() < enipUtil::HEADER_SIZE) return false;
+    const uint64_t reply_context = enipUtil::readU32(packet, SENDER_CONTEXT_OFFSET)
+                                 | (static_cast<uint64_t>(enipUtil::readU32(packet, SENDER_CONTEXT_OFFSET + 4)) << 32);
+    if (reply_context != sender_context) return false;
+
+    enipUtil::IdentityRecord record;
+    if (!enipUtil::parseListIdentity(packet, record)) return false;
+    Devices[netUtil::bits_to_address(sender)] = record;     // broadcast and unicast replies collapse to one
+    return true;
+}
+
+void ENIPScanner::report() {
+    for (const auto& [address, record] : Devices) {
+        std::cout << std::left << std::setw(16) << address << record.product_name << std::endl;
+        std::cout << "  " << enipUtil::vendorName(record.vendor_id) << " (" << record.vendor_id << "), "
+                  << enipUtil::deviceTypeName(record.device_type) << " (0x" << std::hex << record.device_type << std::dec << ")"
+                  << ", product " << record.product_code
+                  << ", rev " << static_cast<int>(record.revision_major) << "." << static_cast<int>(record.revision_minor)
+                  << ", serial 0x" << std::hex << std::setw(8) << std::setfill('0') << std::right << record.serial_number
+                  << std::dec << std::setfill(' ') << std::endl;
+    }
+}
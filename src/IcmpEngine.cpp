@@ -0,0 +1,77 @@
+#include "IcmpEngine.hpp"
+
+#pragma comment(lib, "iphlpapi.lib")
+
+namespace {
+    const char ECHO_PAYLOAD[] = "ping";
+}
+
+IcmpEchoEngine::IcmpEchoEngine(memoryUtil::Arena& arena, size_t capacity) : m_icmp_handle(INVALID_HANDLE_VALUE), m_free_count(0), m_in_flight(0) {
+    // IcmpSendEcho2 wants room for one reply, the echoed payload, an 8 byte ICMP error and an IO_STATUS_BLOCK
+    const size_t SLOT_ALIGNMENT = 16;
+    const size_t needed = sizeof(ICMP_ECHO_REPLY) + sizeof(ECHO_PAYLOAD) + 8 + sizeof(IO_STATUS_BLOCK);
+    m_slot_size = (needed + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+
+    char* replies = static_cast<char*>(arena.allocate(capacity * m_slot_size, SLOT_ALIGNMENT));
+    Slot* slots = arena.allocateArray<Slot>(capacity);
+    m_free_slots = arena.allocateArray<Slot*>(capacity);
+    for (size_t i = capacity; i-- > 0;) {   // reversed so the first slots are handed out first
+        slots[i] = {this, 0, replies + i * m_slot_size};
+        m_free_slots[m_free_count++] = &slots[i];
+    }
+    m_completed.reserve(capacity);
+}
+
+IcmpEchoEngine::~IcmpEchoEngine() {
+    // pending APCs write into the arena, so let them run before it is freed
+    const DWORD DRAIN_WAIT_MS = 100;
+    const int MAX_DRAIN_ROUNDS = 50;
+    for (int round = 0; round < MAX_DRAIN_ROUNDS && m_in_flight > 0; round++) {
+        SleepEx(DRAIN_WAIT_MS, TRUE);
+    }
+    if (m_icmp_handle != INVALID_HANDLE_VALUE) IcmpCloseHandle(m_icmp_handle);
+}
+
+bool IcmpEchoEngine::open() {
+    m_icmp_handle = IcmpCreateFile();
+    return m_icmp_handle != INVALID_HANDLE_VALUE;
+}
+
+bool IcmpEchoEngine::start(uint32_t host, DWORD timeout_ms) {
+    if (m_free_count == 0) return false;
+    Slot* slot = m_free_slots[--m_free_count];
+    slot->host = host;
+    m_in_flight++;
+
+    const DWORD result = IcmpSendEcho2(m_icmp_handle, nullptr, onReply, slot, htonl(host),
+                                       const_cast<char*>(ECHO_PAYLOAD), sizeof(ECHO_PAYLOAD), nullptr,
+                                       slot->reply, static_cast<DWORD>(m_slot_size), timeout_ms);
+    if (result == 0) {
+        const DWORD error = GetLastError();
+        if (error != ERROR_IO_PENDING) finish(slot, error);    // never queued, no APC will come
+    }
+    return true;
+}
+
+void IcmpEchoEngine::collect(DWORD wait_ms, std::vector<EchoCompletion>& completions) {
+    if (m_completed.empty() && m_in_flight > 0) {
+        SleepEx(wait_ms, TRUE);     // returns as soon as the queued APCs have run
+    }
+    completions.insert(completions.end(), m_completed.begin(), m_completed.end());
+    m_completed.clear();
+}
+
+void IcmpEchoEngine::finish(Slot* slot, ULONG status) {
+    m_completed.push_back({slot->host, status});
+    m_free_slots[m_free_count++] = slot;
+    m_in_flight--;
+}
+
+// Runs on the scanning thread inside SleepEx. When IcmpParseReplies finds no reply, the Status of the
+// first ICMP_ECHO_REPLY carries the reason (timeout, unreachable, source quench)
+void NTAPI IcmpEchoEngine::onReply(PVOID context, PIO_STATUS_BLOCK, ULONG) {
+    Slot* slot = static_cast<Slot*>(context);
+    IcmpEchoEngine* engine = slot->engine;
+    IcmpParseReplies(slot->reply, static_cast<DWORD>(engine->m_slot_size));
+    engine->finish(slot, reinterpret_cast<PICMP_ECHO_REPLY>(slot->reply)->Status);
+}
@@ -58,6 +58,15 @@ int LogStreambuf::overflow(int c) {
     return c;
 }
 
+std::streamsize LogStreambuf::xsputn(const char* s, std::streamsize count) {
+    std::streamsize written = s_cout_original_buf->sputn(s, count);    // whole block, one flush for the file
+    if (m_log_file && m_log_file->is_open()) {
+        m_log_file->write(s, written);
+        m_log_file->flush();
+    }
+    return written;
+}
+
 int LogStreambuf::sync() {
     if (s_cout_original_buf->pubsync() == -1) {    // Sync console buffer
         return -1;
@@ -0,0 +1,258 @@
+#include "ModbusScanner.hpp"
+#include <iostream>
+#include <sstream>
+#include "netUtil.hpp"
+#include "TCPScanner.hpp"
+
+ModbusScanner::ModbusScanner() : m_first_host(0), m_last_host(0), m_concurrency(DEFAULT_CONCURRENCY),
+                                 m_timeout_ms(DEFAULT_TIMEOUT_MS) {}
+
+bool ModbusScanner::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 4) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+    if (!parseUnitIds(arguments.size() > 1 ? arguments[1] : "1,255")) {   // 255 for native TCP devices, 1 for most gateways
+        std::cout << "Invalid unit ids, use e.g. 1,255 or 1-16" << std::endl;
+        return false;
+    }
+
+    const size_t MAX_OPTION_DIGITS = 5;
+    const size_t MAX_CONCURRENCY = 4096;
+    m_concurrency = DEFAULT_CONCURRENCY;
+    if (arguments.size() > 2) {
+        if (!netUtil::isNumeric(arguments[2]) || arguments[2].length() > MAX_OPTION_DIGITS
+            || std::stoul(arguments[2]) == 0 || std::stoul(arguments[2]) > MAX_CONCURRENCY) {
+            std::cout << "Invalid concurrency (1-" << MAX_CONCURRENCY << ")" << std::endl;
+            return false;
+        }
+        m_concurrency = std::stoul(arguments[2]);
+    }
+    m_timeout_ms = DEFAULT_TIMEOUT_MS;
+    if (arguments.size() > 3) {
+        if (!netUtil::isNumeric(arguments[3]) || arguments[3].length() > MAX_OPTION_DIGITS || std::stoi(arguments[3]) == 0) {
+            std::cout << "Invalid timeout (ms)" << std::endl;
+            return false;
+        }
+        m_timeout_ms = std::stoi(arguments[3]);
+    }
+    return true;
+}
+
+void ModbusScanner::handleCommand(const std::vector<std::string>& arguments) {
+
+    std::vector<uint32_t> hosts;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        hosts.push_back(static_cast<uint32_t>(host));
+    }
+
+    std::cout << "Reading device identification from " << hosts.size() << " hosts, "
+              << m_unit_ids.size() << " unit ids each..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    probe(hosts);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    std::cout << "Modbus identification complete. " << Devices.size() << " of " << hosts.size()
+              << " hosts identified in " << elapsed_ms << " ms." << std::endl;
+}
+
+// Comma separated ids and inclusive ranges, e.g. "0,1,100-110,255"
+bool ModbusScanner::parseUnitIds(const std::string& text) {
+    const int MAX_UNIT_ID = 255;
+    std::vector<bool> selected(MAX_UNIT_ID + 1, false);
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        const size_t dash = item.find('-');
+        const std::string first = item.substr(0, dash);
+        const std::string last = (dash == std::string::npos) ? first : item.substr(dash + 1);
+        if (!netUtil::isNumeric(first) || !netUtil::isNumeric(last) || first.length() > 3 || last.length() > 3) return false;
+        const int range_start = std::stoi(first);
+        const int range_end = std::stoi(last);
+        if (range_start > range_end || range_end > MAX_UNIT_ID) return false;
+        for (int unit_id = range_start; unit_id <= range_end; unit_id++) {
+            selected[unit_id] = true;
+        }
+    }
+
+    m_unit_ids.clear();
+    for (int unit_id = 0; unit_id <= MAX_UNIT_ID; unit_id++) {
+        if (selected[unit_id]) m_unit_ids.push_back(static_cast<uint8_t>(unit_id));
+    }
+    return !m_unit_ids.empty();
+}
+
+// Up to m_concurrency hosts at once. Each gets one connection; every unit id's request goes out in a
+// single write as soon as it connects and replies are matched back by transaction id, so a host costs
+// one handshake and roughly one round trip however many units are asked.
+void ModbusScanner::probe(const std::vector<uint32_t>& hosts) {
+
+    Devices.clear();
+    const auto CONNECT_TIMEOUT = std::chrono::milliseconds(500);
+    const auto REPLY_TIMEOUT = std::chrono::milliseconds(m_timeout_ms);
+    const int POLL_INTERVAL_MS = 10;
+
+    std::vector<HostProbe> active;
+    std::vector<WSAPOLLFD> poll_descriptors;
+    size_t next_host = 0;
+
+    while (next_host < hosts.size() || !active.empty()) {
+
+        while (next_host < hosts.size() && active.size() < m_concurrency) {     // refill the window
+            const uint32_t host = hosts[next_host++];
+            SOCKET tcp_socket = TCPScanner::startConnect(host, modbusUtil::MODBUS_PORT);
+            if (tcp_socket == INVALID_SOCKET) continue;
+            active.emplace_back();
+            HostProbe& probe = active.back();
+            probe.tcp_socket = tcp_socket;
+            probe.host = host;
+            probe.connected = false;
+            probe.last_activity = std::chrono::steady_clock::now();
+            probe.next_transaction_id = 1;
+            probe.send_offset = 0;
+            for (uint8_t unit_id : m_unit_ids) {
+                queueRequest(probe, unit_id, modbusUtil::OBJECT_VENDOR_NAME);
+            }
+        }
+
+        poll_descriptors.resize(active.size());
+        for (size_t i = 0; i < active.size(); i++) {
+            const bool sending = active[i].send_offset < active[i].send_buffer.size();
+            poll_descriptors[i].fd = active[i].tcp_socket;
+            poll_descriptors[i].events = !active[i].connected ? POLLWRNORM : (POLLRDNORM | (sending ? POLLWRNORM : 0));
+            poll_descriptors[i].revents = 0;
+        }
+        WSAPoll(poll_descriptors.data(), static_cast<ULONG>(poll_descriptors.size()), POLL_INTERVAL_MS);
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = active.size(); i-- > 0;) {      // walk backwards so swap-removal never skips an entry
+            HostProbe& probe = active[i];
+            const short events = poll_descriptors[i].revents;
+            bool finished = false;
+            if (!probe.connected) {
+                if (events & (POLLERR | POLLHUP)) {
+                    finished = true;
+                }
+                else if (events & POLLWRNORM) {     // before the timeout: a handshake that finished in this pass counts
+                    probe.connected = TCPScanner::connectSucceeded(probe.tcp_socket);
+                    probe.last_activity = now;
+                    finished = !probe.connected;
+                }
+                else {
+                    finished = now - probe.last_activity >= CONNECT_TIMEOUT;
+                }
+            }
+            if (!finished && probe.connected) {
+                if (!sendPending(probe) || ((events & (POLLRDNORM | POLLHUP | POLLERR)) && !receiveReplies(probe))) {
+                    finished = true;    // connection closed or failed
+                }
+                else if (probe.pending_units.empty() || now - probe.last_activity >= REPLY_TIMEOUT) {
+                    finished = true;    // every unit answered, or the rest never will
+                }
+            }
+            if (!finished) continue;
+
+            finishProbe(probe);
+            if (i != active.size() - 1) active[i] = std::move(active.back());
+            active.pop_back();
+        }
+    }
+}
+
+void ModbusScanner::queueRequest(HostProbe& probe, uint8_t unit_id, uint8_t object_id) {
+    const uint16_t transaction_id = probe.next_transaction_id++;
+    probe.send_buffer += modbusUtil::buildReadDeviceId(transaction_id, unit_id, modbusUtil::ReadBasic, object_id);
+    probe.pending_units[transaction_id] = unit_id;
+}
+
+// Write as much of the queued requests as the socket takes, false if the connection failed
+bool ModbusScanner::sendPending(HostProbe& probe) {
+    while (probe.send_offset < probe.send_buffer.size()) {
+        const int sent = send(probe.tcp_socket, probe.send_buffer.data() + probe.send_offset,
+                              static_cast<int>(probe.send_buffer.size() - probe.send_offset), 0);
+        if (sent == SOCKET_ERROR) {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+        probe.send_offset += sent;
+    }
+    probe.send_buffer.clear();
+    probe.send_offset = 0;
+    return true;
+}
+
+// Drain the socket and handle every complete frame, false once the peer has closed
+bool ModbusScanner::receiveReplies(HostProbe& probe) {
+    const int RECEIVE_CHUNK = 1024;
+    char chunk[RECEIVE_CHUNK];
+    bool open = true;
+    while (true) {
+        const int received = recv(probe.tcp_socket, chunk, RECEIVE_CHUNK, 0);
+        if (received > 0) {
+            probe.receive_buffer.append(chunk, received);
+            continue;
+        }
+        open = (received == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK);
+        break;
+    }
+
+    modbusUtil::Frame frame;
+    bool handled = false;
+    while (modbusUtil::popFrame(probe.receive_buffer, frame)) {
+        handleFrame(probe, frame);
+        handled = true;
+    }
+    if (handled) probe.last_activity = std::chrono::steady_clock::now();
+    return open && sendPending(probe);  // follow-up requests go out in the same pass
+}
+
+void ModbusScanner::handleFrame(HostProbe& probe, const modbusUtil::Frame& frame) {
+    auto pending = probe.pending_units.find(frame.transaction_id);
+    if (pending == probe.pending_units.end() || pending->second != frame.unit_id) return;
+    probe.pending_units.erase(pending);
+
+    modbusUtil::DeviceIdentification identification;
+    uint8_t exception_code = 0;
+    if (!modbusUtil::parseDeviceIdentification(frame.pdu, identification, exception_code)) {
+        return;     // unit absent behind a gateway, or FC 43 unsupported
+    }
+
+    UnitIdentity& unit = probe.units[frame.unit_id];
+    unit.unit_id = frame.unit_id;
+    unit.conformity_level = identification.conformity_level;
+    for (const auto& [object_id, value] : identification.objects) {
+        unit.objects[object_id] = value;
+    }
+    // the basic stream did not fit in one response, ask for the rest where the device left off
+    if (identification.more_follows && unit.objects.count(identification.next_object_id) == 0) {
+        queueRequest(probe, frame.unit_id, identification.next_object_id);
+    }
+}
+
+void ModbusScanner::finishProbe(HostProbe& probe) {
+    closesocket(probe.tcp_socket);
+    if (probe.units.empty()) return;
+    std::vector<UnitIdentity>& units = Devices[netUtil::bits_to_address(probe.host)];
+    for (auto& [unit_id, unit] : probe.units) {
+        units.push_back(std::move(unit));
+    }
+}
+
+void ModbusScanner::report() {
+    auto object_text = [](const UnitIdentity& unit, uint8_t object_id) {
+        auto object = unit.objects.find(object_id);
+        return (object != unit.objects.end()) ? object->second : std::string("?");
+    };
+    for (const auto& [address, units] : Devices) {
+        std::cout << address << std::endl;
+        for (const UnitIdentity& unit : units) {
+            std::cout << "  unit " << static_cast<int>(unit.unit_id) << ": "
+                      << object_text(unit, modbusUtil::OBJECT_VENDOR_NAME) << ", product "
+                      << object_text(unit, modbusUtil::OBJECT_PRODUCT_CODE) << ", revision "
+                      << object_text(unit, modbusUtil::OBJECT_REVISION) << std::endl;
+        }
+    }
+}
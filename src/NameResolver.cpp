@@ -0,0 +1,332 @@
+#include "NameResolver.hpp"
+#include <iostream>
+#include <iphlpapi.h>
+#include "congestionUtil.hpp"
+#include "dnsUtil.hpp"
+#include "memoryUtil.hpp"
+#include "netUtil.hpp"
+#include "PingScanner.hpp"
+
+#pragma comment(lib, "iphlpapi.lib")
+#pragma comment(lib, "ws2_32.lib")
+
+NameResolver::NameResolver() : m_dns_server(0), m_dns_port(dnsUtil::DNS_PORT), m_methods(0), m_cache_server(0), m_cache_port(0) {}
+
+bool NameResolver::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 4) {
+        return false;
+    }
+
+    m_targets.clear();
+    if (arguments[0] == "last") {
+        for (const PingScanner::HostStatus& status : PingScanner::getInstance().Host_Statuses) {
+            if (status.alive) m_targets.push_back(status.address);
+        }
+        if (m_targets.empty()) {
+            std::cout << "The last ping sweep found no hosts to name" << std::endl;
+            return false;
+        }
+    }
+    else {
+        uint32_t first_host;
+        uint32_t last_host;
+        if (!netUtil::target_to_host_range(arguments[0], first_host, last_host)) {
+            std::cout << "Invalid IP Address or CIDR" << std::endl;
+            return false;
+        }
+        m_targets.reserve(static_cast<size_t>(last_host - first_host) + 1);
+        for (uint64_t host = first_host; host <= last_host; host++) {
+            m_targets.push_back(static_cast<uint32_t>(host));
+        }
+    }
+
+    m_methods = 1 << static_cast<int>(Method::Dns);
+    m_dns_server = 0;
+    m_dns_port = dnsUtil::DNS_PORT;
+    for (size_t index = 1; index < arguments.size(); index++) {
+        const std::string& argument = arguments[index];
+        if (argument == "nbns") { m_methods |= 1 << static_cast<int>(Method::NetBios); continue; }
+        if (argument == "mdns") { m_methods |= 1 << static_cast<int>(Method::Mdns); continue; }
+
+        const size_t colon = argument.find(':');
+        const std::string port = (colon == std::string::npos) ? "" : argument.substr(colon + 1);
+        const size_t MAX_PORT_DIGITS = 5;
+        if (!netUtil::ipToBinary(argument.substr(0, colon), m_dns_server)
+            || (colon != std::string::npos && (!netUtil::isNumeric(port) || port.length() > MAX_PORT_DIGITS || !netUtil::isValidPort(port)))) {
+            std::cout << "Invalid DNS server, use <ip> or <ip:port>" << std::endl;
+            return false;
+        }
+        if (colon != std::string::npos) m_dns_port = static_cast<uint16_t>(std::stoi(port));
+    }
+    if (m_dns_server == 0 && !defaultDnsServer(m_dns_server)) {
+        std::cout << "No DNS server configured on this machine, name one" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void NameResolver::handleCommand(const std::vector<std::string>& arguments) {
+
+    std::cout << "Naming " << m_targets.size() << " hosts via " << netUtil::bits_to_address(m_dns_server) << ":" << m_dns_port;
+    if (m_methods & (1 << static_cast<int>(Method::NetBios))) std::cout << ", then NetBIOS";
+    if (m_methods & (1 << static_cast<int>(Method::Mdns))) std::cout << ", then mDNS";
+    std::cout << "..." << std::endl;
+    resolve();
+}
+
+// First DNS server from the adapter configuration, as nslookup would use
+bool NameResolver::defaultDnsServer(uint32_t& server) {
+    ULONG buffer_size = sizeof(FIXED_INFO);
+    std::vector<uint8_t> buffer(buffer_size);
+    DWORD result = GetNetworkParams(reinterpret_cast<FIXED_INFO*>(buffer.data()), &buffer_size);
+    if (result == ERROR_BUFFER_OVERFLOW) {
+        buffer.resize(buffer_size);
+        result = GetNetworkParams(reinterpret_cast<FIXED_INFO*>(buffer.data()), &buffer_size);
+    }
+    if (result != NO_ERROR) return false;
+    const FIXED_INFO* network_params = reinterpret_cast<const FIXED_INFO*>(buffer.data());
+    return netUtil::ipToBinary(network_params->DnsServerList.IpAddress.String, server) && server != 0;
+}
+
+// True when the cache settles host for this run: a live name, or a live negative entry from a run that
+// tried at least the methods this one would
+bool NameResolver::lookupCache(uint32_t host, std::chrono::steady_clock::time_point now) {
+    auto cached = m_cache.find(host);
+    if (cached == m_cache.end()) return false;
+    if (cached->second.expires <= now) {
+        m_cache.erase(cached);
+        return false;
+    }
+    if (!cached->second.name.empty()) {
+        Host_Names[netUtil::bits_to_address(host)] = cached->second.name;
+        return true;
+    }
+    return (cached->second.methods_tried & m_methods) == m_methods;
+}
+
+// Every query goes out of one UDP socket and is matched back by its transaction ID, which carries the
+// slot it occupies in the in-flight window. A host starts with a PTR query to the DNS server and moves on
+// to NetBIOS node status and a unicast mDNS PTR (if asked for) only when the one before it comes back
+// empty. Timeouts are uniform, so deadlines queue in send order and only the front is ever checked.
+// Silence is the normal answer from hosts without NetBIOS or mDNS (and from servers that ignore a name),
+// so only a DNS query answered on its retry counts as loss to the window, and REFUSED as a throttle.
+void NameResolver::resolve() {
+    using Clock = std::chrono::steady_clock;
+    const int POLL_INTERVAL_MS = 10;
+    const int MAX_DATAGRAM_SIZE = 1500;
+    const int SLOT_BITS = 9;
+    const size_t MAX_WINDOW = size_t{1} << SLOT_BITS;
+    const uint16_t SLOT_MASK = static_cast<uint16_t>(MAX_WINDOW - 1);
+    const double INITIAL_WINDOW = 32;
+    const double MIN_WINDOW = 4;
+    const uint32_t MAX_POSITIVE_TTL_S = 86400;
+    const uint32_t MAX_NEGATIVE_TTL_S = 3600;
+    const uint32_t DEFAULT_NEGATIVE_TTL_S = 300;    // when a negative answer carries no SOA, or NetBIOS and mDNS stay silent
+    const uint32_t NETBIOS_TTL_S = 600;             // node status has no useful TTL of its own
+    const auto timeout = std::chrono::milliseconds(DEFAULT_TIMEOUT_MS);
+
+    Host_Names.clear();
+    if (m_dns_server != m_cache_server || m_dns_port != m_cache_port) {     // another server may name hosts differently
+        m_cache.clear();
+        m_cache_server = m_dns_server;
+        m_cache_port = m_dns_port;
+    }
+    SOCKET udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket == INVALID_SOCKET) {
+        std::cout << "Failed to create UDP socket" << std::endl;
+        return;
+    }
+    u_long non_blocking_mode = 1;
+    ioctlsocket(udp_socket, FIONBIO, &non_blocking_mode);
+
+    struct Work {
+        size_t target;
+        Method method;
+    };
+    struct Deadline {
+        uint16_t slot;
+        uint16_t id;
+        Clock::time_point at;
+    };
+
+    const auto start_time = Clock::now();
+    size_t cached_count = 0;
+    memoryUtil::RingQueue<Work> pending;
+    pending.reserve(m_targets.size());
+    for (size_t target = 0; target < m_targets.size(); target++) {
+        if (lookupCache(m_targets[target], start_time)) cached_count++;
+        else pending.push_back({target, Method::Dns});
+    }
+
+    std::vector<Query> slots(MAX_WINDOW);
+    std::vector<uint16_t> free_slots;
+    free_slots.reserve(MAX_WINDOW);
+    for (size_t slot = MAX_WINDOW; slot-- > 0;) free_slots.push_back(static_cast<uint16_t>(slot));
+    std::vector<size_t> slot_targets(MAX_WINDOW);
+    uint16_t generation = static_cast<uint16_t>(start_time.time_since_epoch().count());    // IDs differ run to run
+    memoryUtil::RingQueue<Deadline> deadlines;
+    deadlines.reserve(MAX_WINDOW * MAX_ATTEMPTS);
+    std::vector<uint32_t> negative_ttls(m_targets.size(), 0);
+    std::vector<bool> inconclusive(m_targets.size(), false);   // the DNS server failed us, so nothing is known
+    congestionUtil::AimdWindow window(INITIAL_WINDOW, MIN_WINDOW, static_cast<double>(MAX_WINDOW));
+    size_t in_flight = 0;
+    size_t query_count = 0;
+
+    auto send = [&](const Query& query) {
+        uint8_t message[dnsUtil::MAX_QUERY_SIZE];
+        sockaddr_in destination = {};
+        destination.sin_family = AF_INET;
+        size_t length;
+        switch (query.method) {
+            case Method::Dns:
+                length = dnsUtil::buildPtrQuery(query.id, query.host, true, message);
+                destination.sin_addr.s_addr = htonl(m_dns_server);
+                destination.sin_port = htons(m_dns_port);
+                break;
+            case Method::NetBios:
+                length = dnsUtil::buildNodeStatusQuery(query.id, message);
+                destination.sin_addr.s_addr = htonl(query.host);
+                destination.sin_port = htons(dnsUtil::NBNS_PORT);
+                break;
+            default:
+                length = dnsUtil::buildPtrQuery(query.id, query.host, false, message);
+                destination.sin_addr.s_addr = htonl(query.host);
+                destination.sin_port = htons(dnsUtil::MDNS_PORT);
+                break;
+        }
+        // a full send buffer loses the datagram like the network would, and the retry covers it
+        sendto(udp_socket, reinterpret_cast<const char*>(message), static_cast<int>(length), 0,
+               reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+        query_count++;
+    };
+    auto release = [&](uint16_t slot) {
+        slots[slot].active = false;
+        free_slots.push_back(slot);
+        in_flight--;
+    };
+    auto named = [&](size_t target, Method method, const char* name, uint32_t ttl) {
+        const uint32_t host = m_targets[target];
+        Host_Names[netUtil::bits_to_address(host)] = name;
+        if (ttl > 0) m_cache[host] = {name, method, m_methods, Clock::now() + std::chrono::seconds(std::min(ttl, MAX_POSITIVE_TTL_S))};
+    };
+    // nothing from this method: queue the next one, or record that the host has no name to give
+    auto advance = [&](size_t target, Method method) {
+        for (int next = static_cast<int>(method) + 1; next < static_cast<int>(METHOD_COUNT); next++) {
+            if (m_methods & (1 << next)) {
+                pending.push_back({target, static_cast<Method>(next)});
+                return;
+            }
+        }
+        if (inconclusive[target]) return;
+        const uint32_t ttl = negative_ttls[target] > 0 ? std::min(negative_ttls[target], MAX_NEGATIVE_TTL_S) : DEFAULT_NEGATIVE_TTL_S;
+        m_cache[m_targets[target]] = {"", method, m_methods, Clock::now() + std::chrono::seconds(ttl)};
+    };
+
+    uint8_t receive_buffer[MAX_DATAGRAM_SIZE];
+    WSAPOLLFD poll_descriptor = {};
+    poll_descriptor.fd = udp_socket;
+    poll_descriptor.events = POLLRDNORM;
+    while (!pending.empty() || in_flight > 0) {
+
+        const auto now = Clock::now();
+        while (!deadlines.empty() && deadlines.front().at <= now) {
+            const Deadline deadline = deadlines.front();
+            deadlines.pop_front();
+            Query& query = slots[deadline.slot];
+            if (!query.active || query.id != deadline.id) continue;     // answered, slot maybe reused
+            if (++query.attempt < MAX_ATTEMPTS) {
+                send(query);
+                deadlines.push_back({deadline.slot, query.id, now + timeout});
+                continue;
+            }
+            const size_t target = slot_targets[deadline.slot];
+            const Method method = query.method;
+            release(deadline.slot);
+            if (method == Method::Dns) inconclusive[target] = true;
+            advance(target, method);
+        }
+
+        while (in_flight < window.size() && !pending.empty()) {
+            const Work work = pending.front();
+            pending.pop_front();
+            const uint16_t slot = free_slots.back();
+            free_slots.pop_back();
+            generation++;
+            const uint16_t id = static_cast<uint16_t>((generation << SLOT_BITS) | slot);
+            slots[slot] = {m_targets[work.target], work.method, 0, id, true};
+            slot_targets[slot] = work.target;
+            send(slots[slot]);
+            deadlines.push_back({slot, id, Clock::now() + timeout});
+            in_flight++;
+        }
+
+        poll_descriptor.revents = 0;
+        WSAPoll(&poll_descriptor, 1, POLL_INTERVAL_MS);
+        while (true) {
+            sockaddr_in sender_address = {};
+            socklen_t sender_length = sizeof(sender_address);
+            const int bytes_received = recvfrom(udp_socket, reinterpret_cast<char*>(receive_buffer), MAX_DATAGRAM_SIZE, 0,
+                                                reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+            if (bytes_received == SOCKET_ERROR && WSAGetLastError() == WSAECONNRESET) continue;   // ICMP unreachable, the timeout handles it
+            if (bytes_received < static_cast<int>(dnsUtil::HEADER_SIZE)) {
+                if (bytes_received < 0) break;
+                continue;
+            }
+
+            const uint16_t id = dnsUtil::readBE16(receive_buffer);
+            const uint16_t slot = id & SLOT_MASK;
+            const Query& query = slots[slot];
+            if (!query.active || query.id != id) continue;      // late answer to a settled query
+            const uint32_t sender = ntohl(sender_address.sin_addr.s_addr);
+            const uint16_t sender_port = ntohs(sender_address.sin_port);
+            const bool expected_sender = (query.method == Method::Dns)
+                ? (sender == m_dns_server && sender_port == m_dns_port)
+                : (sender == query.host && sender_port == (query.method == Method::NetBios ? dnsUtil::NBNS_PORT : dnsUtil::MDNS_PORT));
+            if (!expected_sender) continue;
+
+            const size_t target = slot_targets[slot];
+            const Method method = query.method;
+            const size_t length = static_cast<size_t>(bytes_received);
+            if (method == Method::NetBios) {
+                char name[dnsUtil::MAX_NAME_LENGTH + 1];
+                size_t name_length;
+                const bool answered = dnsUtil::parseNodeStatusResponse(receive_buffer, length, name, sizeof(name), name_length);
+                if (!answered && !dnsUtil::isResponse(receive_buffer, length)) continue;
+                release(slot);
+                window.record(congestionUtil::Signal::Response);
+                if (answered) named(target, method, name, NETBIOS_TTL_S);
+                else advance(target, method);
+                continue;
+            }
+
+            dnsUtil::PtrAnswer answer;
+            if (!dnsUtil::parsePtrResponse(receive_buffer, length, query.host, answer)) continue;
+            const bool retried = query.attempt > 0;
+            release(slot);
+            if (method == Method::Dns && answer.rcode == dnsUtil::RCODE_REFUSED) window.record(congestionUtil::Signal::RateLimit);
+            else if (method == Method::Dns && retried) window.record(congestionUtil::Signal::Timeout);
+            else window.record(congestionUtil::Signal::Response);     // one signal per reply
+            if (answer.named) {
+                named(target, method, answer.name, answer.ttl);
+                continue;
+            }
+            if (method == Method::Dns) {
+                if (answer.rcode == dnsUtil::RCODE_NO_ERROR || answer.rcode == dnsUtil::RCODE_NAME_ERROR) negative_ttls[target] = answer.ttl;
+                else inconclusive[target] = true;   // SERVFAIL, REFUSED: says nothing about the host
+            }
+            advance(target, method);
+        }
+    }
+    closesocket(udp_socket);
+
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count();
+    report(cached_count, query_count, window.peak(), elapsed_ms);
+}
+
+void NameResolver::report(size_t cached_count, size_t query_count, size_t window_peak, long long elapsed_ms) {
+    for (const auto& [address, name] : Host_Names) {
+        std::cout << "  " << address << "  " << name << std::endl;
+    }
+    std::cout << "Named " << Host_Names.size() << " of " << m_targets.size() << " hosts in " << elapsed_ms << " ms ("
+              << cached_count << " settled from cache, " << query_count << " queries, window peaked at " << window_peak << ")." << std::endl;
+}
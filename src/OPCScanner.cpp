@@ -0,0 +1,1094 @@
+#include "OPCScanner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+#include "InputHandler.hpp"
+#include "netUtil.hpp"
+#include "TCPScanner.hpp"
+
+OPCExplorer::OPCExplorer() : _slot(0), m_max_nodes_per_browse(DEFAULT_MAX_NODES_PER_REQUEST),
+                             m_max_nodes_per_read(DEFAULT_MAX_NODES_PER_REQUEST),
+                             m_max_monitored_items_per_call(DEFAULT_MAX_NODES_PER_REQUEST), m_round_trips(0), m_watch(false),
+                             m_sampling_ms(DEFAULT_SAMPLING_MS), m_publishing_ms(DEFAULT_PUBLISHING_MS),
+                             m_queue_size(DEFAULT_QUEUE_SIZE) {}
+
+OPCExplorer::~OPCExplorer() {
+    clearNodes();
+}
+
+bool OPCExplorer::validateInput(const std::vector<std::string>& arguments) {
+    m_watch = !arguments.empty() && arguments[0] == "watch";
+    const size_t first = m_watch ? 1 : 0;
+    const size_t MAX_WATCH_OPTIONS = 3;     // sampling ms, publishing ms, queue size
+    if (arguments.size() < first + 3 || arguments.size() > first + 3 + (m_watch ? MAX_WATCH_OPTIONS : 0)) {
+        return false;
+    }
+
+    m_sampling_ms = DEFAULT_SAMPLING_MS;
+    m_publishing_ms = DEFAULT_PUBLISHING_MS;
+    m_queue_size = DEFAULT_QUEUE_SIZE;
+    const size_t MAX_OPTION_DIGITS = 7;
+    for (size_t i = first + 3; i < arguments.size(); i++) {
+        if (!netUtil::isNumeric(arguments[i]) || arguments[i].length() > MAX_OPTION_DIGITS || std::stoul(arguments[i]) == 0) {
+            std::cout << "Invalid watch option " << arguments[i] << std::endl;
+            return false;
+        }
+    }
+    if (arguments.size() > first + 3) m_sampling_ms = std::stod(arguments[first + 3]);
+    if (arguments.size() > first + 4) m_publishing_ms = std::stod(arguments[first + 4]);
+    if (arguments.size() > first + 5) m_queue_size = static_cast<uint32_t>(std::stoul(arguments[first + 5]));
+
+    _ip = arguments[first];
+    const std::string URL_SCHEME = "opc.tcp://";
+    if (_ip.rfind(URL_SCHEME, 0) == 0) {    // full endpoint url given, use as-is
+        m_endpoint_url = _ip;
+    }
+    else if (netUtil::isValidIPv4(_ip)) {
+        m_endpoint_url = URL_SCHEME + _ip + ":" + std::to_string(DEFAULT_PORT);
+    }
+    else {
+        std::cout << "Invalid IP Address or endpoint url" << std::endl;
+        return false;
+    }
+
+    // slot is the namespace index the tag path lives in (e.g. 2 for Kepware / FactoryTalk Linx string tags)
+    const int MAX_NAMESPACE_INDEX = 65535;
+    const std::string& slot = arguments[first + 1];
+    if (!netUtil::isNumeric(slot) || slot.length() > 5 || std::stoi(slot) > MAX_NAMESPACE_INDEX) {
+        std::cout << "Invalid slot (namespace index)" << std::endl;
+        return false;
+    }
+    _slot = std::stoi(slot);
+    _path = arguments[first + 2];
+    return true;
+}
+
+void OPCExplorer::handleCommand(const std::vector<std::string>& arguments) {
+
+    UA_Client* client = connectClient(m_endpoint_url);
+    if (!client) return;
+
+    auto start_time = std::chrono::steady_clock::now();
+    m_round_trips = 0;
+    readServerInfo(client);
+
+    const std::string cache_path = m_application_uri.empty() ? "" : cachePath();
+    if (!cache_path.empty() && loadCache(cache_path)) {
+        std::cout << "Loaded " << Nodes.size() << " nodes from " << cache_path << std::endl;
+        refreshTree(client);
+    }
+    else {
+        UA_NodeId start_node = startNode();
+        browseTree(client, start_node);
+        UA_NodeId_clear(&start_node);
+    }
+    if (!cache_path.empty() && !saveCache(cache_path)) {
+        std::cout << "Failed to write cache " << cache_path << std::endl;
+    }
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+    if (!m_watch) {
+        printTree();
+    }
+    std::cout << "Browsed " << Nodes.size() << " nodes in " << m_round_trips << " round trips ("
+              << elapsed_ms << " ms)" << std::endl;
+    if (m_watch) {
+        watchTags(client);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+
+UA_Client* OPCExplorer::connectClient(const std::string& endpoint_url) {
+    UA_ClientConfig config;
+    memset(&config, 0, sizeof(config));
+    config.logging = UA_Log_Stdout_new(UA_LOGLEVEL_WARNING);    // library info chatter would drown our output
+    UA_ClientConfig_setDefault(&config);
+    UA_Client* client = UA_Client_newWithConfig(&config);
+    if (!client) {
+        std::cout << "Failed to create OPC UA client" << std::endl;
+        return nullptr;
+    }
+
+    std::cout << "Connecting to " << endpoint_url << std::endl;
+    UA_StatusCode status = UA_Client_connect(client, endpoint_url.c_str());
+    if (status != UA_STATUSCODE_GOOD) {
+        std::cout << "Failed to connect: " << UA_StatusCode_name(status) << std::endl;
+        UA_Client_delete(client);
+        return nullptr;
+    }
+    return client;
+}
+
+// "/" means the Objects folder, a number is a numeric id, anything else is a string id
+UA_NodeId OPCExplorer::startNode() {
+    if (_path == "/") {
+        return UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    }
+    if (netUtil::isNumeric(_path)) {
+        return UA_NODEID_NUMERIC(static_cast<UA_UInt16>(_slot), static_cast<UA_UInt32>(std::stoul(_path)));
+    }
+    UA_NodeId node_id;
+    UA_NodeId start = UA_NODEID_STRING(static_cast<UA_UInt16>(_slot), const_cast<char*>(_path.c_str()));
+    UA_NodeId_copy(&start, &node_id);   // own the string so the caller can clear it
+    return node_id;
+}
+
+// Size our batches to whatever the server says it accepts per request, and learn the
+// ApplicationUri (first entry of Server.ServerArray) that names this server's cache
+void OPCExplorer::readServerInfo(UA_Client* client) {
+    m_max_nodes_per_browse = DEFAULT_MAX_NODES_PER_REQUEST;
+    m_max_nodes_per_read = DEFAULT_MAX_NODES_PER_REQUEST;
+    m_max_monitored_items_per_call = DEFAULT_MAX_NODES_PER_REQUEST;
+    m_application_uri.clear();
+
+    const size_t LIMIT_COUNT = 3;
+    const size_t SERVER_ARRAY = LIMIT_COUNT;    // read after the limits
+    UA_ReadValueId limits[LIMIT_COUNT + 1];
+    for (UA_ReadValueId& limit : limits) {
+        UA_ReadValueId_init(&limit);
+        limit.attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    limits[0].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERBROWSE);
+    limits[1].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD);
+    limits[2].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXMONITOREDITEMSPERCALL);
+    limits[SERVER_ARRAY].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERARRAY);
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = limits;
+    request.nodesToReadSize = LIMIT_COUNT + 1;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+
+    UA_ReadResponse response = UA_Client_Service_read(client, request);
+    m_round_trips++;
+    uint32_t* targets[LIMIT_COUNT] = {&m_max_nodes_per_browse, &m_max_nodes_per_read, &m_max_monitored_items_per_call};
+    for (size_t i = 0; i < response.resultsSize && i < LIMIT_COUNT; i++) {
+        const UA_DataValue& result = response.results[i];
+        if (!result.hasValue || !UA_Variant_hasScalarType(&result.value, &UA_TYPES[UA_TYPES_UINT32])) continue;
+        const uint32_t limit = *static_cast<UA_UInt32*>(result.value.data);
+        if (limit > 0) *targets[i] = limit;  // zero means "no limit", keep our own batch size
+    }
+    if (response.resultsSize > SERVER_ARRAY && response.results[SERVER_ARRAY].hasValue
+        && response.results[SERVER_ARRAY].value.type == &UA_TYPES[UA_TYPES_STRING] && response.results[SERVER_ARRAY].value.arrayLength > 0) {
+        const UA_String& uri = static_cast<UA_String*>(response.results[SERVER_ARRAY].value.data)[0];
+        m_application_uri.assign(reinterpret_cast<const char*>(uri.data), uri.length);
+    }
+    UA_ReadResponse_clear(&response);
+}
+
+// Breadth-first walk: every node on a level goes out in as few Browse requests as the server allows,
+// so a deep tree costs a handful of round trips per level instead of one per node
+void OPCExplorer::browseTree(UA_Client* client, const UA_NodeId& start_node) {
+
+    clearNodes();
+    BrowsedNode root;
+    UA_NodeId_copy(&start_node, &root.node_id);
+    root.browse_name = _path;
+    root.node_class = UA_NODECLASS_UNSPECIFIED;
+    root.parent = NO_PARENT;
+    root.depth = 0;
+    root.reference_hash = 0;
+    Nodes.push_back(root);
+
+    std::unordered_set<std::string> visited = {nodeIdToString(start_node)};    // references can form cycles
+    browseLevels(client, {0}, visited);
+}
+
+// Bring a cached tree up to date. Every node the first walk expanded (all of them, variables included since
+// they can carry properties) is browsed again in one flat batched pass instead of level by level, and its references are hashed (target, browse name, class) against the
+// hash stored when it was first walked. Only the nodes whose hash moved are browsed a second time: their
+// children are diffed by node id, children that are gone are dropped with their subtrees, children that
+// stayed keep their cached subtree (checked on their own in the same pass), and only new children are
+// walked. ModelChangeEvents only reach a live subscription, so changes made while we were away have to
+// be found this way.
+void OPCExplorer::refreshTree(UA_Client* client) {
+
+    const UA_UInt32 NAME_AND_CLASS = UA_BROWSERESULTMASK_BROWSENAME | UA_BROWSERESULTMASK_NODECLASS;
+    std::vector<size_t> expanded(Nodes.size());
+    std::iota(expanded.begin(), expanded.end(), size_t{0});
+    std::vector<uint64_t> current_hashes(Nodes.size(), 0);
+    auto hash_references = [&current_hashes](size_t node, const UA_ReferenceDescription* references, size_t reference_count) {
+        for (size_t i = 0; i < reference_count; i++) {
+            current_hashes[node] += referenceHash(references[i]);
+        }
+    };
+    for (size_t offset = 0; offset < expanded.size(); offset += m_max_nodes_per_browse) {
+        const size_t count = std::min<size_t>(m_max_nodes_per_browse, expanded.size() - offset);
+        browseBatch(client, expanded, offset, count, NAME_AND_CLASS, hash_references);
+    }
+
+    std::vector<size_t> changed;
+    for (size_t index : expanded) {
+        if (current_hashes[index] != Nodes[index].reference_hash) changed.push_back(index);
+    }
+
+    // what the changed nodes list now, by child node id
+    struct ListedChild {
+        UA_NodeId node_id;          // owned until it becomes a new node or is cleared below
+        std::string browse_name;
+        UA_NodeClass node_class;
+    };
+    std::unordered_map<size_t, std::unordered_map<std::string, ListedChild>> listed;
+    auto list_children = [this, &listed](size_t node, const UA_ReferenceDescription* references, size_t reference_count) {
+        std::unordered_map<std::string, ListedChild>& children = listed[node];
+        for (size_t i = 0; i < reference_count; i++) {
+            const UA_ReferenceDescription& reference = references[i];
+            if (reference.nodeId.serverIndex != 0) continue;
+            auto [child, inserted] = children.try_emplace(nodeIdToString(reference.nodeId.nodeId));
+            if (!inserted) continue;    // listed again under another reference type
+            UA_NodeId_copy(&reference.nodeId.nodeId, &child->second.node_id);
+            child->second.browse_name.assign(reinterpret_cast<const char*>(reference.browseName.name.data), reference.browseName.name.length);
+            child->second.node_class = reference.nodeClass;
+        }
+    };
+    for (size_t offset = 0; offset < changed.size(); offset += m_max_nodes_per_browse) {
+        const size_t count = std::min<size_t>(m_max_nodes_per_browse, changed.size() - offset);
+        browseBatch(client, changed, offset, count, NAME_AND_CLASS, list_children);
+    }
+
+    // Nodes are kept in browse order, so a parent is always settled before its children
+    std::vector<bool> removed(Nodes.size(), false);
+    std::vector<size_t> new_index(Nodes.size(), NO_PARENT);
+    std::vector<BrowsedNode> kept;
+    std::vector<size_t> kept_changed;
+    for (size_t index = 0; index < Nodes.size(); index++) {
+        BrowsedNode& node = Nodes[index];
+        if (node.parent != NO_PARENT && !removed[node.parent]) {
+            auto children = listed.find(node.parent);
+            if (children != listed.end()) {     // parent changed: keep the child only if it is still listed
+                auto child = children->second.find(nodeIdToString(node.node_id));
+                if (child != children->second.end()) {
+                    node.browse_name = child->second.browse_name;   // a rename keeps the node id
+                    node.node_class = child->second.node_class;
+                }
+                else {
+                    removed[index] = true;
+                }
+            }
+        }
+        if ((node.parent != NO_PARENT && removed[node.parent]) || removed[index]) {
+            removed[index] = true;
+            UA_NodeId_clear(&node.node_id);
+            continue;
+        }
+        if (listed.count(index)) {
+            node.reference_hash = current_hashes[index];
+            kept_changed.push_back(index);
+        }
+        if (node.parent != NO_PARENT) node.parent = new_index[node.parent];
+        new_index[index] = kept.size();
+        kept.push_back(std::move(node));
+    }
+    Nodes.swap(kept);
+
+    std::unordered_set<std::string> visited;
+    for (const BrowsedNode& node : Nodes) {
+        visited.insert(nodeIdToString(node.node_id));
+    }
+    std::vector<size_t> added;
+    for (size_t old_index : kept_changed) {
+        const size_t parent = new_index[old_index];
+        for (auto& [key, child] : listed[old_index]) {
+            if (!visited.insert(key).second) {      // still there, or reached first through another node
+                UA_NodeId_clear(&child.node_id);
+                continue;
+            }
+            BrowsedNode node;
+            node.node_id = child.node_id;           // ownership moves to Nodes
+            node.browse_name = std::move(child.browse_name);
+            node.node_class = child.node_class;
+            node.parent = parent;
+            node.depth = Nodes[parent].depth + 1;
+            node.reference_hash = 0;
+            Nodes.push_back(std::move(node));
+            added.push_back(Nodes.size() - 1);
+        }
+    }
+    for (auto& [old_index, children] : listed) {    // children of changed nodes that were removed themselves
+        if (new_index[old_index] != NO_PARENT) continue;
+        for (auto& [key, child] : children) UA_NodeId_clear(&child.node_id);
+    }
+
+    std::vector<size_t> variables;
+    for (size_t index = 0; index < Nodes.size(); index++) {
+        if (Nodes[index].node_class == UA_NODECLASS_VARIABLE) variables.push_back(index);
+    }
+    readValues(client, variables);  // values are live data, never cached
+    std::cout << changed.size() << " changed nodes, walking " << added.size() << " new children" << std::endl;
+    browseLevels(client, added, visited);
+}
+
+// Breadth-first from the given nodes, reading the values of each new level as it is found
+void OPCExplorer::browseLevels(UA_Client* client, std::vector<size_t> level, std::unordered_set<std::string>& visited) {
+
+    std::vector<size_t> next_level;
+    auto add_references = [this, &visited, &next_level](size_t node, const UA_ReferenceDescription* references,
+                                                        size_t reference_count) {
+        addReferences(references, reference_count, node, visited, next_level);
+    };
+    while (!level.empty()) {
+        next_level.clear();
+        for (size_t offset = 0; offset < level.size(); offset += m_max_nodes_per_browse) {
+            const size_t count = std::min<size_t>(m_max_nodes_per_browse, level.size() - offset);
+            browseBatch(client, level, offset, count, UA_BROWSERESULTMASK_BROWSENAME | UA_BROWSERESULTMASK_NODECLASS,
+                        add_references);
+        }
+        readValues(client, next_level);
+        level.swap(next_level);
+    }
+}
+
+void OPCExplorer::browseBatch(UA_Client* client, const std::vector<size_t>& nodes, size_t offset, size_t count,
+                              UA_UInt32 result_mask, const ReferenceHandler& on_references) {
+
+    std::vector<UA_BrowseDescription> descriptions(count);
+    for (size_t i = 0; i < count; i++) {
+        UA_BrowseDescription& description = descriptions[i];
+        UA_BrowseDescription_init(&description);
+        description.nodeId = Nodes[nodes[offset + i]].node_id;     // shallow, Nodes keeps ownership
+        description.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+        description.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        description.includeSubtypes = true;
+        description.resultMask = result_mask;
+    }
+
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.requestedMaxReferencesPerNode = 0;  // let the server page with continuation points
+    request.nodesToBrowse = descriptions.data();
+    request.nodesToBrowseSize = count;
+
+    UA_BrowseResponse response = UA_Client_Service_browse(client, request);
+    m_round_trips++;
+    if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        std::cout << "Browse failed: " << UA_StatusCode_name(response.responseHeader.serviceResult) << std::endl;
+        UA_BrowseResponse_clear(&response);
+        return;
+    }
+
+    std::vector<UA_ByteString> continuation_points;
+    std::vector<size_t> continuation_parents;
+    for (size_t i = 0; i < response.resultsSize; i++) {
+        const UA_BrowseResult& result = response.results[i];
+        on_references(nodes[offset + i], result.references, result.referencesSize);
+        if (result.continuationPoint.length > 0) {
+            continuation_points.emplace_back();
+            UA_ByteString_copy(&result.continuationPoint, &continuation_points.back());
+            continuation_parents.push_back(nodes[offset + i]);
+        }
+    }
+    UA_BrowseResponse_clear(&response);
+
+    while (!continuation_points.empty()) {  // page through every truncated node in one BrowseNext per round
+        UA_BrowseNextRequest next_request;
+        UA_BrowseNextRequest_init(&next_request);
+        next_request.releaseContinuationPoints = false;
+        next_request.continuationPoints = continuation_points.data();
+        next_request.continuationPointsSize = continuation_points.size();
+
+        UA_BrowseNextResponse next_response = UA_Client_Service_browseNext(client, next_request);
+        m_round_trips++;
+
+        std::vector<UA_ByteString> remaining_points;
+        std::vector<size_t> remaining_parents;
+        for (size_t i = 0; i < next_response.resultsSize && i < continuation_parents.size(); i++) {
+            const UA_BrowseResult& result = next_response.results[i];
+            on_references(continuation_parents[i], result.references, result.referencesSize);
+            if (result.continuationPoint.length > 0) {
+                remaining_points.emplace_back();
+                UA_ByteString_copy(&result.continuationPoint, &remaining_points.back());
+                remaining_parents.push_back(continuation_parents[i]);
+            }
+        }
+        UA_BrowseNextResponse_clear(&next_response);
+
+        for (UA_ByteString& continuation_point : continuation_points) {
+            UA_ByteString_clear(&continuation_point);
+        }
+        continuation_points.swap(remaining_points);
+        continuation_parents.swap(remaining_parents);
+    }
+}
+
+void OPCExplorer::addReferences(const UA_ReferenceDescription* references, size_t reference_count, size_t parent,
+                                std::unordered_set<std::string>& visited, std::vector<size_t>& next_level) {
+    for (size_t i = 0; i < reference_count; i++) {
+        const UA_ReferenceDescription& reference = references[i];
+        Nodes[parent].reference_hash += referenceHash(reference);
+        if (reference.nodeId.serverIndex != 0) continue;   // lives on another server
+        if (!visited.insert(nodeIdToString(reference.nodeId.nodeId)).second) continue;
+
+        BrowsedNode node;
+        UA_NodeId_copy(&reference.nodeId.nodeId, &node.node_id);
+        node.browse_name.assign(reinterpret_cast<const char*>(reference.browseName.name.data), reference.browseName.name.length);
+        node.node_class = reference.nodeClass;
+        node.parent = parent;
+        node.depth = Nodes[parent].depth + 1;
+        node.reference_hash = 0;
+        Nodes.push_back(node);
+        next_level.push_back(Nodes.size() - 1);
+    }
+}
+
+// One reference's contribution to its parent's reference_hash. The parent sums these, so the order the
+// server lists references in (and how it pages them) does not matter.
+uint64_t OPCExplorer::referenceHash(const UA_ReferenceDescription& reference) {
+    const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = FNV_OFFSET ^ UA_NodeId_hash(&reference.nodeId.nodeId);
+    hash = (hash ^ reference.nodeId.serverIndex) * FNV_PRIME;
+    for (size_t i = 0; i < reference.browseName.name.length; i++) {
+        hash = (hash ^ reference.browseName.name.data[i]) * FNV_PRIME;
+    }
+    hash = (hash ^ static_cast<uint64_t>(reference.nodeClass)) * FNV_PRIME;
+    hash ^= hash >> 33;         // finalizer spreads the bits before they are summed
+    hash *= 0xFF51AFD7ED558CCDULL;
+    return hash ^ (hash >> 33);
+}
+
+// Read the Value attribute of every variable on a level in as few Read requests as allowed
+void OPCExplorer::readValues(UA_Client* client, const std::vector<size_t>& node_indices) {
+
+    std::vector<size_t> variables;
+    for (size_t index : node_indices) {
+        if (Nodes[index].node_class == UA_NODECLASS_VARIABLE) variables.push_back(index);
+    }
+
+    std::vector<UA_ReadValueId> reads;
+    for (size_t offset = 0; offset < variables.size(); offset += m_max_nodes_per_read) {
+        const size_t count = std::min<size_t>(m_max_nodes_per_read, variables.size() - offset);
+        reads.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            UA_ReadValueId_init(&reads[i]);
+            reads[i].nodeId = Nodes[variables[offset + i]].node_id;    // shallow
+            reads[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        }
+
+        UA_ReadRequest request;
+        UA_ReadRequest_init(&request);
+        request.nodesToRead = reads.data();
+        request.nodesToReadSize = count;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+
+        UA_ReadResponse response = UA_Client_Service_read(client, request);
+        m_round_trips++;
+        for (size_t i = 0; i < response.resultsSize && i < count; i++) {
+            const UA_DataValue& result = response.results[i];
+            BrowsedNode& node = Nodes[variables[offset + i]];
+            if (!result.hasValue) {
+                node.value = UA_StatusCode_name(result.status);
+                continue;
+            }
+            UA_String text = UA_STRING_NULL;
+            UA_print(&result.value, &UA_TYPES[UA_TYPES_VARIANT], &text);
+            node.value.assign(reinterpret_cast<const char*>(text.data), text.length);
+            UA_String_clear(&text);
+        }
+        UA_ReadResponse_clear(&response);
+    }
+}
+
+void OPCExplorer::printTree() {
+    std::vector<std::vector<size_t>> children(Nodes.size());
+    for (size_t index = 1; index < Nodes.size(); index++) {
+        children[Nodes[index].parent].push_back(index);
+    }
+
+    std::vector<size_t> stack = {0};    // depth-first so children print under their parent
+    while (!stack.empty()) {
+        const size_t index = stack.back();
+        stack.pop_back();
+        const BrowsedNode& node = Nodes[index];
+        std::cout << std::string(node.depth * 2, ' ') << node.browse_name
+                  << " [" << nodeClassName(node.node_class) << "] " << nodeIdToString(node.node_id);
+        if (!node.value.empty()) {
+            std::cout << " = " << node.value;
+        }
+        std::cout << std::endl;
+        stack.insert(stack.end(), children[index].rbegin(), children[index].rend());
+    }
+}
+
+// One file per server and start point, e.g. cache/opc/urn-kepware-server_2_Channel1_1f3a....bin
+std::string OPCExplorer::cachePath() {
+    const std::string key = m_application_uri + "_" + std::to_string(_slot) + "_" + _path;
+    std::string file_name = key;
+    for (char& c : file_name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-') c = '-';
+    }
+    std::stringstream path;     // hash keeps keys that sanitize to the same name apart
+    path << CACHE_DIRECTORY << "/" << file_name << "_" << std::hex << std::hash<std::string>{}(key) << ".bin";
+    return path.str();
+}
+
+// Layout: magic, node count, then per node in browse order:
+// encoded NodeId, browse name, node class, parent index, depth, reference hash (low then high half).
+// Integers are little-endian u32, byte fields are u32 length + bytes.
+bool OPCExplorer::saveCache(const std::string& path) {
+
+    std::string data = CACHE_MAGIC;
+    appendCacheU32(data, static_cast<uint32_t>(Nodes.size()));
+    for (const BrowsedNode& node : Nodes) {
+        UA_ByteString encoded = UA_BYTESTRING_NULL;
+        if (UA_encodeBinary(&node.node_id, &UA_TYPES[UA_TYPES_NODEID], &encoded) != UA_STATUSCODE_GOOD) return false;
+        appendCacheBytes(data, encoded.data, encoded.length);
+        UA_ByteString_clear(&encoded);
+        appendCacheBytes(data, node.browse_name.data(), node.browse_name.size());
+        appendCacheU32(data, static_cast<uint32_t>(node.node_class));
+        appendCacheU32(data, node.parent == NO_PARENT ? UINT32_MAX : static_cast<uint32_t>(node.parent));
+        appendCacheU32(data, static_cast<uint32_t>(node.depth));
+        appendCacheU32(data, static_cast<uint32_t>(node.reference_hash));
+        appendCacheU32(data, static_cast<uint32_t>(node.reference_hash >> 32));
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(CACHE_DIRECTORY, error);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return file.good();
+}
+
+bool OPCExplorer::loadCache(const std::string& path) {
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+
+    const size_t MAGIC_LENGTH = strlen(CACHE_MAGIC);
+    if (data.compare(0, MAGIC_LENGTH, CACHE_MAGIC) != 0) return false;
+    size_t position = MAGIC_LENGTH;
+    uint32_t node_count = 0;
+    if (!readCacheU32(data, position, node_count) || node_count == 0) return false;
+
+    clearNodes();
+    std::string encoded;
+    for (uint32_t index = 0; index < node_count; index++) {
+        BrowsedNode node;
+        uint32_t node_class, parent, depth, hash_low, hash_high;
+        if (!readCacheBytes(data, position, encoded) || !readCacheBytes(data, position, node.browse_name)
+            || !readCacheU32(data, position, node_class) || !readCacheU32(data, position, parent)
+            || !readCacheU32(data, position, depth) || !readCacheU32(data, position, hash_low)
+            || !readCacheU32(data, position, hash_high)) {
+            clearNodes();
+            return false;
+        }
+        const bool root = (index == 0);
+        if (root != (parent == UINT32_MAX) || (!root && parent >= index)) {     // parents precede children
+            clearNodes();
+            return false;
+        }
+
+        UA_ByteString view;
+        view.length = encoded.size();
+        view.data = reinterpret_cast<UA_Byte*>(&encoded[0]);
+        UA_NodeId_init(&node.node_id);
+        if (UA_decodeBinary(&view, &node.node_id, &UA_TYPES[UA_TYPES_NODEID], nullptr) != UA_STATUSCODE_GOOD) {
+            clearNodes();
+            return false;
+        }
+        node.node_class = static_cast<UA_NodeClass>(node_class);
+        node.parent = root ? NO_PARENT : parent;
+        node.depth = static_cast<int>(depth);
+        node.reference_hash = (static_cast<uint64_t>(hash_high) << 32) | hash_low;
+        Nodes.push_back(node);
+    }
+    return true;
+}
+
+void OPCExplorer::appendCacheU32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+void OPCExplorer::appendCacheBytes(std::string& out, const void* bytes, size_t length) {
+    appendCacheU32(out, static_cast<uint32_t>(length));
+    out.append(static_cast<const char*>(bytes), length);
+}
+
+bool OPCExplorer::readCacheU32(const std::string& data, size_t& position, uint32_t& value) {
+    if (position + 4 > data.size()) return false;
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[position++])) << shift;
+    }
+    return true;
+}
+
+bool OPCExplorer::readCacheBytes(const std::string& data, size_t& position, std::string& bytes) {
+    uint32_t length = 0;
+    if (!readCacheU32(data, position, length) || position + length > data.size()) return false;
+    bytes.assign(data, position, length);
+    position += length;
+    return true;
+}
+
+// Subscribe to every variable under the tag path and log changes until the user enters a command.
+// The server samples and queues; we only hear about changes, once per publishing interval.
+void OPCExplorer::watchTags(UA_Client* client) {
+
+    m_watched_tags.clear();
+    for (size_t index = 0; index < Nodes.size(); index++) {
+        if (Nodes[index].node_class != UA_NODECLASS_VARIABLE) continue;
+        m_watched_tags.emplace_back();
+        m_watched_tags.back().node = index;
+        m_watched_tags.back().head = 0;
+        m_watched_tags.back().count = 0;
+        m_watched_tags.back().dropped = 0;
+    }
+    if (m_watched_tags.empty()) {
+        std::cout << "No variables to watch under " << _path << std::endl;
+        return;
+    }
+
+    UA_CreateSubscriptionRequest subscription_request = UA_CreateSubscriptionRequest_default();
+    subscription_request.requestedPublishingInterval = m_publishing_ms;
+    UA_CreateSubscriptionResponse subscription = UA_Client_Subscriptions_create(client, subscription_request,
+                                                                                nullptr, nullptr, nullptr);
+    if (subscription.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        std::cout << "Failed to create subscription: " << UA_StatusCode_name(subscription.responseHeader.serviceResult) << std::endl;
+        UA_CreateSubscriptionResponse_clear(&subscription);
+        return;
+    }
+    const UA_UInt32 subscription_id = subscription.subscriptionId;
+    std::cout << "Subscription " << subscription_id << " publishing every " << subscription.revisedPublishingInterval
+              << " ms" << std::endl;
+    UA_CreateSubscriptionResponse_clear(&subscription);
+
+    const size_t monitored = createMonitoredItems(client, subscription_id);
+    std::cout << "Watching " << monitored << " of " << m_watched_tags.size()
+              << " tags. Enter any command to stop." << std::endl;
+
+    const int RUN_INTERVAL_MS = 50;
+    const auto FLUSH_INTERVAL = std::chrono::milliseconds(1000);
+    const size_t FLUSH_BUFFER_RESERVE = 64 * 1024;
+    m_flush_buffer.reserve(FLUSH_BUFFER_RESERVE);
+    InputHandler& inputHandler = InputHandler::getInstance();
+    auto next_flush = std::chrono::steady_clock::now() + FLUSH_INTERVAL;
+    while (!inputHandler.hasCommand()) {
+        UA_StatusCode status = UA_Client_run_iterate(client, RUN_INTERVAL_MS);     // notifications land in onDataChange
+        if (status != UA_STATUSCODE_GOOD) {
+            std::cout << "Connection lost: " << UA_StatusCode_name(status) << std::endl;
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= next_flush) {
+            flushSamples();
+            next_flush += FLUSH_INTERVAL;
+        }
+    }
+    if (inputHandler.hasCommand()) {
+        inputHandler.getCommand();  // the stop request, not meant for the shell
+    }
+
+    flushSamples();
+    UA_Client_Subscriptions_deleteSingle(client, subscription_id);
+    m_watched_tags.clear();
+}
+
+// One CreateMonitoredItems call per batch the server accepts, rather than one per tag
+size_t OPCExplorer::createMonitoredItems(UA_Client* client, UA_UInt32 subscription_id) {
+
+    size_t monitored = 0;
+    std::vector<UA_MonitoredItemCreateRequest> items;
+    std::vector<void*> contexts;
+    std::vector<UA_Client_DataChangeNotificationCallback> callbacks;
+    std::vector<UA_Client_DeleteMonitoredItemCallback> delete_callbacks;
+    for (size_t offset = 0; offset < m_watched_tags.size(); offset += m_max_monitored_items_per_call) {
+        const size_t count = std::min<size_t>(m_max_monitored_items_per_call, m_watched_tags.size() - offset);
+        items.resize(count);
+        contexts.resize(count);
+        callbacks.assign(count, &OPCExplorer::onDataChange);
+        delete_callbacks.assign(count, nullptr);
+        for (size_t i = 0; i < count; i++) {
+            WatchedTag& tag = m_watched_tags[offset + i];
+            items[i] = UA_MonitoredItemCreateRequest_default(Nodes[tag.node].node_id);     // shallow
+            items[i].requestedParameters.samplingInterval = m_sampling_ms;
+            items[i].requestedParameters.queueSize = m_queue_size;
+            items[i].requestedParameters.discardOldest = true;
+            contexts[i] = &tag;
+        }
+
+        UA_CreateMonitoredItemsRequest request;
+        UA_CreateMonitoredItemsRequest_init(&request);
+        request.subscriptionId = subscription_id;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        request.itemsToCreate = items.data();
+        request.itemsToCreateSize = count;
+
+        UA_CreateMonitoredItemsResponse response = UA_Client_MonitoredItems_createDataChanges(
+            client, request, contexts.data(), callbacks.data(), delete_callbacks.data());
+        m_round_trips++;
+        for (size_t i = 0; i < response.resultsSize; i++) {
+            if (response.results[i].statusCode == UA_STATUSCODE_GOOD) {
+                monitored++;
+                continue;
+            }
+            std::cout << "Cannot monitor " << Nodes[m_watched_tags[offset + i].node].browse_name << ": "
+                      << UA_StatusCode_name(response.results[i].statusCode) << std::endl;
+        }
+        UA_CreateMonitoredItemsResponse_clear(&response);
+    }
+    return monitored;
+}
+
+void OPCExplorer::onDataChange(UA_Client* client, UA_UInt32 subscription_id, void* subscription_context,
+                               UA_UInt32 monitor_id, void* monitor_context, UA_DataValue* value) {
+    storeSample(*static_cast<WatchedTag*>(monitor_context), value);
+}
+
+// Copy the value into the tag's ring. Numbers and booleans become a double, strings are truncated
+// into the sample, anything else is logged by type name.
+void OPCExplorer::storeSample(WatchedTag& tag, const UA_DataValue* value) {
+
+    if (tag.count == SAMPLE_RING_CAPACITY) {    // full, overwrite the oldest
+        tag.head = (tag.head + 1) % SAMPLE_RING_CAPACITY;
+        tag.count--;
+        tag.dropped++;
+    }
+    TagSample& sample = tag.samples[(tag.head + tag.count) % SAMPLE_RING_CAPACITY];
+    tag.count++;
+
+    sample.status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    sample.timestamp = value->hasSourceTimestamp ? value->sourceTimestamp
+                     : value->hasServerTimestamp ? value->serverTimestamp : UA_DateTime_now();
+    sample.is_text = true;
+    sample.number = 0;
+    sample.text[0] = '\0';
+    if (!value->hasValue || !value->value.type || !UA_Variant_isScalar(&value->value)) {
+        return;
+    }
+
+    const void* data = value->value.data;
+    switch (value->value.type->typeKind) {
+        case UA_DATATYPEKIND_BOOLEAN:   sample.number = *static_cast<const UA_Boolean*>(data);  break;
+        case UA_DATATYPEKIND_SBYTE:     sample.number = *static_cast<const UA_SByte*>(data);    break;
+        case UA_DATATYPEKIND_BYTE:      sample.number = *static_cast<const UA_Byte*>(data);     break;
+        case UA_DATATYPEKIND_INT16:     sample.number = *static_cast<const UA_Int16*>(data);    break;
+        case UA_DATATYPEKIND_UINT16:    sample.number = *static_cast<const UA_UInt16*>(data);   break;
+        case UA_DATATYPEKIND_INT32:     sample.number = *static_cast<const UA_Int32*>(data);    break;
+        case UA_DATATYPEKIND_UINT32:    sample.number = *static_cast<const UA_UInt32*>(data);   break;
+        case UA_DATATYPEKIND_INT64:     sample.number = static_cast<double>(*static_cast<const UA_Int64*>(data));  break;
+        case UA_DATATYPEKIND_UINT64:    sample.number = static_cast<double>(*static_cast<const UA_UInt64*>(data)); break;
+        case UA_DATATYPEKIND_FLOAT:     sample.number = *static_cast<const UA_Float*>(data);    break;
+        case UA_DATATYPEKIND_DOUBLE:    sample.number = *static_cast<const UA_Double*>(data);   break;
+        case UA_DATATYPEKIND_STRING:
+        case UA_DATATYPEKIND_LOCALIZEDTEXT: {
+            const UA_String& text = (value->value.type->typeKind == UA_DATATYPEKIND_STRING)
+                ? *static_cast<const UA_String*>(data) : static_cast<const UA_LocalizedText*>(data)->text;
+            const size_t length = std::min<size_t>(text.length, SAMPLE_TEXT_CAPACITY - 1);
+            if (length > 0) memcpy(sample.text, text.data, length);
+            sample.text[length] = '\0';
+            return;
+        }
+        default:
+            strncpy(sample.text, value->value.type->typeName, SAMPLE_TEXT_CAPACITY - 1);
+            sample.text[SAMPLE_TEXT_CAPACITY - 1] = '\0';
+            return;
+    }
+    sample.is_text = false;
+}
+
+// Drain every ring into one buffer and hand it to the log in a single write
+void OPCExplorer::flushSamples() {
+
+    m_flush_buffer.clear();
+    char line_prefix[32];
+    char number[32];
+    for (WatchedTag& tag : m_watched_tags) {
+        const std::string& name = Nodes[tag.node].browse_name;
+        if (tag.dropped > 0) {
+            m_flush_buffer += name + ": " + std::to_string(tag.dropped) + " changes dropped, ring full\n";
+            tag.dropped = 0;
+        }
+        for (; tag.count > 0; tag.count--) {
+            const TagSample& sample = tag.samples[tag.head];
+            tag.head = (tag.head + 1) % SAMPLE_RING_CAPACITY;
+
+            const UA_DateTimeStruct time = UA_DateTime_toStruct(sample.timestamp);
+            snprintf(line_prefix, sizeof(line_prefix), "%02u:%02u:%02u.%03u  ",
+                     time.hour, time.min, time.sec, time.milliSec);
+            m_flush_buffer += line_prefix;
+            m_flush_buffer += name;
+            m_flush_buffer += " = ";
+            if (sample.is_text) {
+                m_flush_buffer += sample.text;
+            }
+            else {
+                snprintf(number, sizeof(number), "%.10g", sample.number);
+                m_flush_buffer += number;
+            }
+            if (sample.status != UA_STATUSCODE_GOOD) {
+                m_flush_buffer += " (";
+                m_flush_buffer += UA_StatusCode_name(sample.status);
+                m_flush_buffer += ")";
+            }
+            m_flush_buffer += '\n';
+        }
+        tag.head = 0;
+    }
+    if (m_flush_buffer.empty()) return;
+    std::cout.write(m_flush_buffer.data(), static_cast<std::streamsize>(m_flush_buffer.size()));
+    std::cout.flush();
+}
+
+void OPCExplorer::clearNodes() {
+    for (BrowsedNode& node : Nodes) {
+        UA_NodeId_clear(&node.node_id);
+    }
+    Nodes.clear();
+}
+
+std::string OPCExplorer::nodeIdToString(const UA_NodeId& node_id) {
+    UA_String text = UA_STRING_NULL;
+    UA_NodeId_print(&node_id, &text);
+    std::string result(reinterpret_cast<const char*>(text.data), text.length);
+    UA_String_clear(&text);
+    return result;
+}
+
+const char* OPCExplorer::nodeClassName(UA_NodeClass node_class) {
+    switch (node_class) {
+        case UA_NODECLASS_OBJECT:           return "Object";
+        case UA_NODECLASS_VARIABLE:         return "Variable";
+        case UA_NODECLASS_METHOD:           return "Method";
+        case UA_NODECLASS_OBJECTTYPE:       return "ObjectType";
+        case UA_NODECLASS_VARIABLETYPE:     return "VariableType";
+        case UA_NODECLASS_REFERENCETYPE:    return "ReferenceType";
+        case UA_NODECLASS_DATATYPE:         return "DataType";
+        case UA_NODECLASS_VIEW:             return "View";
+        default:                            return "Node";
+    }
+}
+
+
+OPCDiscoverer::OPCDiscoverer() : m_first_host(0), m_last_host(0) {}
+
+bool OPCDiscoverer::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.size() != 1) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void OPCDiscoverer::handleCommand(const std::vector<std::string>& arguments) {
+
+    std::vector<uint32_t> hosts;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        hosts.push_back(static_cast<uint32_t>(host));
+    }
+
+    std::cout << "Sweeping " << hosts.size() << " hosts for port " << OPC_UA_PORT << "..." << std::endl;
+    std::vector<uint32_t> open_hosts = TCPScanner::getInstance().sweepPort(hosts, OPC_UA_PORT);
+    std::cout << open_hosts.size() << " hosts listening, requesting endpoints..." << std::endl;
+
+    auto start_time = std::chrono::steady_clock::now();
+    discover(open_hosts);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    std::cout << "Discovery complete. " << Servers.size() << " OPC UA servers answered out of "
+              << open_hosts.size() << " open hosts in " << elapsed_ms << " ms." << std::endl;
+}
+
+// Every client shares one EventLoop, so all SecureChannels, GetEndpoints and FindServers requests
+// progress together from this thread instead of one blocking connect per server
+void OPCDiscoverer::discover(const std::vector<uint32_t>& hosts) {
+
+    Servers.clear();
+    if (hosts.empty()) return;
+
+    const UA_UInt32 REQUEST_TIMEOUT_MS = 5000;
+    const auto DISCOVERY_TIMEOUT = std::chrono::milliseconds(REQUEST_TIMEOUT_MS + 1000);
+    const auto CLOSE_TIMEOUT = std::chrono::milliseconds(2000);
+    const UA_UInt32 EVENT_LOOP_INTERVAL_MS = 10;
+
+    UA_Logger event_loop_logger = UA_Log_Stdout_withLevel(UA_LOGLEVEL_WARNING);
+    UA_EventLoop* event_loop = UA_EventLoop_new_POSIX(&event_loop_logger);
+    UA_ConnectionManager* tcp_manager = UA_ConnectionManager_new_POSIX_TCP(UA_STRING_STATIC("tcp connection manager"));
+    event_loop->registerEventSource(event_loop, reinterpret_cast<UA_EventSource*>(tcp_manager));
+    event_loop->start(event_loop);
+
+    std::vector<std::unique_ptr<DiscoveryTarget>> targets;     // stable addresses, callbacks hold raw pointers
+    for (uint32_t host : hosts) {
+        auto target = std::make_unique<DiscoveryTarget>();
+        target->address = netUtil::bits_to_address(host);
+        target->endpoint_url = "opc.tcp://" + target->address + ":" + std::to_string(OPC_UA_PORT);
+        target->requests_sent = false;
+        target->pending_responses = 0;
+        target->finished = false;
+
+        UA_ClientConfig config;
+        memset(&config, 0, sizeof(config));
+        config.logging = UA_Log_Stdout_new(UA_LOGLEVEL_WARNING);
+        config.eventLoop = event_loop;
+        config.externalEventLoop = true;    // shared, we free it ourselves after every client is gone
+        UA_ClientConfig_setDefault(&config);
+        config.timeout = REQUEST_TIMEOUT_MS;
+        config.clientContext = target.get();
+        config.stateCallback = onStateChange;
+
+        target->client = UA_Client_newWithConfig(&config);
+        if (!target->client) continue;
+        UA_StatusCode status = UA_Client_connectSecureChannelAsync(target->client, target->endpoint_url.c_str());
+        if (status != UA_STATUSCODE_GOOD) {
+            target->record.error = UA_StatusCode_name(status);
+            target->finished = true;
+        }
+        targets.push_back(std::move(target));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + DISCOVERY_TIMEOUT;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const bool all_finished = std::all_of(targets.begin(), targets.end(),
+                                              [](const auto& target) { return target->finished; });
+        if (all_finished) break;
+        event_loop->run(event_loop, EVENT_LOOP_INTERVAL_MS);
+    }
+
+    for (const auto& target : targets) {    // close every channel, then let the loop flush the goodbyes
+        UA_Client_disconnectSecureChannelAsync(target->client);
+    }
+    deadline = std::chrono::steady_clock::now() + CLOSE_TIMEOUT;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const bool all_closed = std::all_of(targets.begin(), targets.end(), [](const auto& target) {
+            UA_SecureChannelState channel_state;
+            UA_Client_getState(target->client, &channel_state, nullptr, nullptr);
+            return channel_state == UA_SECURECHANNELSTATE_CLOSED;
+        });
+        if (all_closed) break;
+        event_loop->run(event_loop, EVENT_LOOP_INTERVAL_MS);
+    }
+
+    for (const auto& target : targets) {
+        if (!target->record.endpoints.empty() || !target->record.discovery_urls.empty()) {
+            Servers[target->address] = target->record;
+        }
+        UA_Client_delete(target->client);
+    }
+
+    event_loop->stop(event_loop);
+    while (event_loop->state != UA_EVENTLOOPSTATE_STOPPED && event_loop->state != UA_EVENTLOOPSTATE_FRESH) {
+        event_loop->run(event_loop, EVENT_LOOP_INTERVAL_MS);
+    }
+    event_loop->free(event_loop);
+}
+
+void OPCDiscoverer::onStateChange(UA_Client* client, UA_SecureChannelState channel_state,
+                                  UA_SessionState session_state, UA_StatusCode connect_status) {
+    DiscoveryTarget* target = static_cast<DiscoveryTarget*>(UA_Client_getContext(client));
+    if (!target || target->finished) return;
+
+    if (connect_status != UA_STATUSCODE_GOOD) {     // client gave up on this server
+        target->record.error = UA_StatusCode_name(connect_status);
+        target->finished = true;
+        return;
+    }
+    if (channel_state != UA_SECURECHANNELSTATE_OPEN || target->requests_sent) return;
+    target->requests_sent = true;
+
+    // Discovery services only need a SecureChannel, no Session, so both go out the moment it opens
+    UA_GetEndpointsRequest endpoints_request;
+    UA_GetEndpointsRequest_init(&endpoints_request);
+    endpoints_request.endpointUrl = UA_STRING(const_cast<char*>(target->endpoint_url.c_str()));
+    if (__UA_Client_AsyncService(client, &endpoints_request, &UA_TYPES[UA_TYPES_GETENDPOINTSREQUEST], onEndpoints,
+                                 &UA_TYPES[UA_TYPES_GETENDPOINTSRESPONSE], target, nullptr) == UA_STATUSCODE_GOOD) {
+        target->pending_responses++;
+    }
+
+    UA_FindServersRequest servers_request;
+    UA_FindServersRequest_init(&servers_request);
+    servers_request.endpointUrl = UA_STRING(const_cast<char*>(target->endpoint_url.c_str()));
+    if (__UA_Client_AsyncService(client, &servers_request, &UA_TYPES[UA_TYPES_FINDSERVERSREQUEST], onServers,
+                                 &UA_TYPES[UA_TYPES_FINDSERVERSRESPONSE], target, nullptr) == UA_STATUSCODE_GOOD) {
+        target->pending_responses++;
+    }
+
+    if (target->pending_responses == 0) target->finished = true;
+}
+
+void OPCDiscoverer::onEndpoints(UA_Client* client, void* userdata, UA_UInt32 request_id, void* response) {
+    DiscoveryTarget* target = static_cast<DiscoveryTarget*>(userdata);
+    const UA_GetEndpointsResponse* endpoints_response = static_cast<const UA_GetEndpointsResponse*>(response);
+
+    if (endpoints_response->responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
+        const std::string POLICY_PREFIX = "http://opcfoundation.org/UA/SecurityPolicy#";
+        const char* SECURITY_MODES[] = {"Invalid", "None", "Sign", "SignAndEncrypt"};
+        for (size_t i = 0; i < endpoints_response->endpointsSize; i++) {
+            const UA_EndpointDescription& endpoint = endpoints_response->endpoints[i];
+            EndpointRecord endpoint_record;
+            endpoint_record.url = toString(endpoint.endpointUrl);
+            endpoint_record.security_policy = toString(endpoint.securityPolicyUri);
+            if (endpoint_record.security_policy.rfind(POLICY_PREFIX, 0) == 0) {
+                endpoint_record.security_policy.erase(0, POLICY_PREFIX.length());
+            }
+            endpoint_record.security_mode = (endpoint.securityMode <= UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
+                                            ? SECURITY_MODES[endpoint.securityMode] : "Invalid";
+            target->record.endpoints.push_back(endpoint_record);
+
+            if (target->record.application_name.empty()) {
+                target->record.application_name = toString(endpoint.server.applicationName.text);
+                target->record.application_uri = toString(endpoint.server.applicationUri);
+            }
+        }
+    }
+    else {
+        target->record.error = UA_StatusCode_name(endpoints_response->responseHeader.serviceResult);
+    }
+    finishResponse(target);
+}
+
+void OPCDiscoverer::onServers(UA_Client* client, void* userdata, UA_UInt32 request_id, void* response) {
+    DiscoveryTarget* target = static_cast<DiscoveryTarget*>(userdata);
+    const UA_FindServersResponse* servers_response = static_cast<const UA_FindServersResponse*>(response);
+
+    if (servers_response->responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
+        for (size_t i = 0; i < servers_response->serversSize; i++) {
+            const UA_ApplicationDescription& server = servers_response->servers[i];
+            if (target->record.application_name.empty()) {
+                target->record.application_name = toString(server.applicationName.text);
+                target->record.application_uri = toString(server.applicationUri);
+            }
+            for (size_t j = 0; j < server.discoveryUrlsSize; j++) {
+                target->record.discovery_urls.push_back(toString(server.discoveryUrls[j]));
+            }
+        }
+    }
+    finishResponse(target);
+}
+
+void OPCDiscoverer::finishResponse(DiscoveryTarget* target) {
+    if (--target->pending_responses <= 0) {
+        target->finished = true;
+    }
+}
+
+void OPCDiscoverer::report() {
+    for (const auto& [address, server] : Servers) {
+        std::cout << address << "  " << server.application_name << "  (" << server.application_uri << ")" << std::endl;
+        for (const EndpointRecord& endpoint : server.endpoints) {
+            std::cout << "    " << endpoint.url << "  " << endpoint.security_policy
+                      << " [" << endpoint.security_mode << "]" << std::endl;
+        }
+        for (const std::string& discovery_url : server.discovery_urls) {
+            std::cout << "    discovery: " << discovery_url << std::endl;
+        }
+    }
+}
+
+std::string OPCDiscoverer::toString(const UA_String& text) {
+    return std::string(reinterpret_cast<const char*>(text.data), text.length);
+}
@@ -0,0 +1,271 @@
+#include "OuiDatabase.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    // Index file layout, native (little-endian) byte order:
+    //   IndexHeader, uint64_t keys[entry_count], uint32_t name_offsets[entry_count], char names[names_size]
+    struct IndexHeader {
+        char magic[4];
+        uint32_t entry_count;
+        uint32_t names_size;
+        uint32_t reserved;
+    };
+    const char INDEX_MAGIC[4] = {'O', 'U', 'I', '1'};
+
+    const int MAC_BITS = 48;
+    const int MA_L_BITS = 24;
+    const int MA_M_BITS = 28;
+    const int MA_S_BITS = 36;
+    const uint32_t SPLIT_BLOCK = 0x80000000;   // name offset flag: look for a longer assignment first
+    const int BUCKET_BITS = 12;                 // leading MAC bits that pick a bucket, shared by every prefix length
+    const int KEY_BUCKET_SHIFT = MAC_BITS + 8 - BUCKET_BITS;
+
+    uint64_t prefixKey(uint64_t mac, int prefix_bits) {
+        const uint64_t prefix = (mac >> (MAC_BITS - prefix_bits)) << (MAC_BITS - prefix_bits);
+        return (prefix << 8) | static_cast<uint64_t>(prefix_bits);
+    }
+
+    // One CSV record, honouring quoted fields with embedded commas and doubled quotes
+    void splitCsvLine(const std::string& line, std::vector<std::string>& fields) {
+        fields.clear();
+        std::string field;
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); i++) {
+            const char c = line[i];
+            if (quoted) {
+                if (c != '"') field += c;
+                else if (i + 1 < line.size() && line[i + 1] == '"') field += line[++i];
+                else quoted = false;
+            }
+            else if (c == '"') quoted = true;
+            else if (c == ',') { fields.push_back(field); field.clear(); }
+            else field += c;
+        }
+        fields.push_back(field);
+    }
+
+    std::string trim(const std::string& text) {
+        const size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return "";
+        return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+    }
+}
+
+OuiDatabase& OuiDatabase::shared() {
+    static OuiDatabase database(DEFAULT_PATH);
+    return database;
+}
+
+OuiDatabase::OuiDatabase(const std::string& path)
+    : m_path(path), m_loaded(false), m_keys(nullptr), m_name_offsets(nullptr), m_names(nullptr), m_entry_count(0) {}
+
+OuiDatabase::~OuiDatabase() {
+    for (const Mapping& mapping : m_mappings) {
+        UnmapViewOfFile(mapping.view);
+        CloseHandle(mapping.section);
+        CloseHandle(mapping.file);
+    }
+}
+
+// Not locked: scans look vendors up from the command thread, never from their workers
+const char* OuiDatabase::vendor(uint64_t mac) {
+    if (!m_loaded) reload();
+    if (m_entry_count == 0) return nullptr;
+    const uint32_t* large_block = find(mac, MA_L_BITS);
+    if (!large_block) return nullptr;
+    if (*large_block & SPLIT_BLOCK) {
+        for (int prefix_bits : {MA_S_BITS, MA_M_BITS}) {
+            const uint32_t* assignment = find(mac, prefix_bits);
+            if (assignment) return name(*assignment);
+        }
+    }
+    return name(*large_block);
+}
+
+size_t OuiDatabase::size() {
+    if (!m_loaded) reload();
+    return m_entry_count;
+}
+
+const uint32_t* OuiDatabase::find(uint64_t mac, int prefix_bits) const {
+    const uint64_t key = prefixKey(mac, prefix_bits);
+    const size_t bucket = static_cast<size_t>(key >> KEY_BUCKET_SHIFT);
+    const uint64_t* last = m_keys + m_bucket_starts[bucket + 1];
+    const uint64_t* match = std::lower_bound(m_keys + m_bucket_starts[bucket], last, key);
+    if (match == last || *match != key) return nullptr;
+    return m_name_offsets + (match - m_keys);
+}
+
+const char* OuiDatabase::name(uint32_t name_offset) const {
+    const char* text = m_names + (name_offset & ~SPLIT_BLOCK);
+    return *text ? text : nullptr;      // blocks only known from their sub-assignments have no name
+}
+
+bool OuiDatabase::reload() {
+    m_loaded = true;
+    // share delete lets a rebuild rename this index aside while it is still mapped
+    HANDLE file = CreateFileA(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(sizeof(IndexHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const char* view = section ? static_cast<const char*>(MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!view) {
+        if (section) CloseHandle(section);
+        CloseHandle(file);
+        return false;
+    }
+
+    // Check the whole layout once here, so lookups can trust every key and offset
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(view);
+    const uint64_t size = static_cast<uint64_t>(file_size.QuadPart);
+    const uint64_t names_start = sizeof(IndexHeader) + uint64_t{header->entry_count} * (sizeof(uint64_t) + sizeof(uint32_t));
+    bool valid = std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0
+                 && header->names_size > 0 && names_start + header->names_size == size
+                 && view[size - 1] == '\0';
+    const uint64_t* keys = reinterpret_cast<const uint64_t*>(view + sizeof(IndexHeader));
+    const uint32_t* name_offsets = reinterpret_cast<const uint32_t*>(keys + (valid ? header->entry_count : 0));
+    for (uint32_t i = 0; valid && i < header->entry_count; i++) {
+        valid = (name_offsets[i] & ~SPLIT_BLOCK) < header->names_size && (i == 0 || keys[i - 1] < keys[i]);
+    }
+    m_mappings.push_back({file, section, view});
+    if (!valid) {
+        m_entry_count = 0;
+        return false;
+    }
+    // first key of every bucket, so a lookup only searches the handful of keys sharing its leading bits
+    m_bucket_starts.assign((size_t{1} << BUCKET_BITS) + 1, 0);
+    for (uint32_t i = 0; i < header->entry_count; i++) m_bucket_starts[(keys[i] >> KEY_BUCKET_SHIFT) + 1]++;
+    for (size_t bucket = 1; bucket < m_bucket_starts.size(); bucket++) m_bucket_starts[bucket] += m_bucket_starts[bucket - 1];
+    m_keys = keys;
+    m_name_offsets = name_offsets;
+    m_names = view + names_start;
+    m_entry_count = header->entry_count;
+    return true;
+}
+
+bool OuiDatabase::build(const std::vector<std::string>& csv_paths, const std::string& output_path, size_t& entry_count, std::string& error) {
+    const int HEX_DIGIT_BITS = 4;
+
+    struct Assignment {
+        uint64_t key;
+        std::string name;
+    };
+    std::vector<Assignment> assignments;
+    std::vector<std::string> fields;    // reused for every line
+    std::string line;
+    for (const std::string& path : csv_paths) {
+        std::ifstream csv(path);
+        if (!csv) {
+            error = "cannot open " + path;
+            return false;
+        }
+        // "Registry,Assignment,Organization Name,Organization Address"
+        while (std::getline(csv, line)) {
+            splitCsvLine(line, fields);
+            if (fields.size() < 3 || fields[0] == "CID") continue;     // company IDs are not MAC prefixes
+            const std::string hex = trim(fields[1]);
+            const int prefix_bits = static_cast<int>(hex.size()) * HEX_DIGIT_BITS;
+            if (prefix_bits != MA_L_BITS && prefix_bits != MA_M_BITS && prefix_bits != MA_S_BITS) continue;  // header row
+            if (!std::all_of(hex.begin(), hex.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); })) continue;
+            const uint64_t prefix = std::stoull(hex, nullptr, 16) << (MAC_BITS - prefix_bits);
+            assignments.push_back({prefixKey(prefix, prefix_bits), trim(fields[2])});
+        }
+    }
+    if (assignments.empty()) {
+        error = "no MA-L, MA-M or MA-S assignments found";
+        return false;
+    }
+
+    // Every MA-M and MA-S assignment needs its MA-L block present and flagged, so a lookup that lands on the
+    // block knows to try the longer prefixes first
+    std::vector<uint64_t> split_blocks;
+    for (const Assignment& assignment : assignments) {
+        const int prefix_bits = static_cast<int>(assignment.key & 0xFF);
+        if (prefix_bits != MA_L_BITS) split_blocks.push_back(prefixKey(assignment.key >> 8, MA_L_BITS));
+    }
+    std::sort(split_blocks.begin(), split_blocks.end());
+    split_blocks.erase(std::unique(split_blocks.begin(), split_blocks.end()), split_blocks.end());
+    for (uint64_t block : split_blocks) assignments.push_back({block, ""});
+    // by key, named before unnamed and otherwise in file order, so the first of each key is the one kept
+    std::stable_sort(assignments.begin(), assignments.end(), [](const Assignment& a, const Assignment& b) {
+        return a.key != b.key ? a.key < b.key : (!a.name.empty() && b.name.empty());
+    });
+
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> name_offsets;
+    std::string names(1, '\0');                     // offset 0 is the empty name
+    std::unordered_map<std::string, uint32_t> name_index;   // one copy of each organization
+    for (size_t i = 0; i < assignments.size(); i++) {
+        if (i > 0 && assignments[i].key == assignments[i - 1].key) continue;
+
+        uint32_t offset = 0;
+        const std::string& organization = assignments[i].name;
+        if (!organization.empty()) {
+            auto existing = name_index.find(organization);
+            if (existing != name_index.end()) offset = existing->second;
+            else {
+                offset = static_cast<uint32_t>(names.size());
+                name_index.emplace(organization, offset);
+                names.append(organization).push_back('\0');
+            }
+        }
+        if (std::binary_search(split_blocks.begin(), split_blocks.end(), assignments[i].key)) offset |= SPLIT_BLOCK;
+        keys.push_back(assignments[i].key);
+        name_offsets.push_back(offset);
+    }
+
+    // written beside the target and renamed into place once complete
+    const std::string temporary_path = output_path + ".new";
+    std::ofstream index(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!index) {
+        error = "cannot write " + temporary_path;
+        return false;
+    }
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.entry_count = static_cast<uint32_t>(keys.size());
+    header.names_size = static_cast<uint32_t>(names.size());
+    index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    index.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(uint64_t));
+    index.write(reinterpret_cast<const char*>(name_offsets.data()), name_offsets.size() * sizeof(uint32_t));
+    index.write(names.data(), names.size());
+    index.close();
+    if (!index) {
+        error = "failed writing " + temporary_path;
+        return false;
+    }
+    // The old index may be mapped, here or by another instance, and Windows will not replace a mapped file
+    // but does let it be renamed. It is retired under a numbered name first; retired files nothing maps any
+    // more are deleted by a later build.
+    const int MAX_RETIRED_INDEXES = 16;
+    std::string retired_path;
+    for (int generation = 1; generation <= MAX_RETIRED_INDEXES; generation++) {
+        const std::string candidate = output_path + ".old" + std::to_string(generation);
+        const bool free_name = DeleteFileA(candidate.c_str()) || GetLastError() == ERROR_FILE_NOT_FOUND;
+        if (free_name && retired_path.empty()) retired_path = candidate;
+    }
+    const bool replacing = GetFileAttributesA(output_path.c_str()) != INVALID_FILE_ATTRIBUTES;
+    if (replacing && retired_path.empty()) {
+        error = "cannot replace " + output_path + ", " + std::to_string(MAX_RETIRED_INDEXES) + " older copies are still mapped";
+        return false;
+    }
+    if (replacing && !MoveFileExA(output_path.c_str(), retired_path.c_str(), 0)) {
+        error = "cannot move " + output_path + " aside (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    if (!MoveFileExA(temporary_path.c_str(), output_path.c_str(), 0)) {
+        error = "cannot replace " + output_path + " (error " + std::to_string(GetLastError()) + ")";
+        if (replacing) MoveFileExA(retired_path.c_str(), output_path.c_str(), 0);    // put the old index back
+        return false;
+    }
+    entry_count = keys.size();
+    return true;
+}
@@ -0,0 +1,179 @@
+#include "PassiveListener.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <winsock2.h>
+#include <windows.h>
+#include <mstcpip.h>
+#include "captureUtil.hpp"
+#include "netUtil.hpp"
+
+#pragma comment(lib, "ws2_32.lib")
+
+PassiveListener::PassiveListener() : m_live(false), m_local_address(0), m_live_seconds(DEFAULT_LIVE_SECONDS) {}
+
+bool PassiveListener::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 3) {
+        return false;
+    }
+
+    m_live = (arguments[0] == "live");
+    if (!m_live) {
+        if (arguments.size() != 1) return false;
+        m_capture_path = arguments[0];
+        return true;
+    }
+
+    if (arguments.size() < 2 || !netUtil::ipToBinary(arguments[1], m_local_address)) {
+        std::cout << "Invalid local IP Address, use the address of the interface to listen on" << std::endl;
+        return false;
+    }
+    m_live_seconds = DEFAULT_LIVE_SECONDS;
+    if (arguments.size() == 3) {
+        const size_t MAX_SECONDS_DIGITS = 4;
+        if (!netUtil::isNumeric(arguments[2]) || arguments[2].length() > MAX_SECONDS_DIGITS || std::stoi(arguments[2]) == 0) {
+            std::cout << "Invalid seconds, use 1-9999" << std::endl;
+            return false;
+        }
+        m_live_seconds = std::stoi(arguments[2]);
+    }
+    return true;
+}
+
+void PassiveListener::handleCommand(const std::vector<std::string>& arguments) {
+
+    Discovered.clear();
+    uint64_t frame_count = 0;
+    uint64_t byte_count = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    if (m_live) {
+        std::cout << "Listening on " << netUtil::bits_to_address(m_local_address) << " for " << m_live_seconds << " seconds..." << std::endl;
+        if (!captureLive(m_local_address, m_live_seconds, frame_count, byte_count)) return;
+    }
+    else {
+        std::cout << "Replaying " << m_capture_path << "..." << std::endl;
+        if (!replayFile(m_capture_path, frame_count, byte_count)) return;
+    }
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    const double BITS_PER_BYTE = 8.0;
+    const double MEGABYTE = 1024.0 * 1024.0;
+    std::cout << "Listen complete. " << frame_count << " frames (" << std::fixed << std::setprecision(1) << byte_count / MEGABYTE
+              << " MB) in " << elapsed_us / 1000 << " ms";
+    if (!m_live && elapsed_us > 0) {    // replay speed; a live capture runs for as long as it was told to
+        std::cout << ", " << std::setprecision(2) << byte_count * BITS_PER_BYTE / (elapsed_us * 1000.0) << " Gbit/s";
+    }
+    std::cout << std::defaultfloat << ". " << Discovered.hosts().size() << " hosts, " << Discovered.links().size()
+              << " neighbor links." << std::endl;
+}
+
+// Map the whole file read-only and dissect frames where they lie: the reader hands out pointers into
+// the mapping and the page cache does the I/O, so nothing is read into buffers or copied per frame
+bool PassiveListener::replayFile(const std::string& path, uint64_t& frame_count, uint64_t& byte_count) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Cannot open " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        std::cout << "Empty or unreadable capture file" << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const uint8_t* view = mapping ? static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!view) {
+        std::cout << "Cannot map " << path << " into memory" << std::endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    captureUtil::CaptureReader reader;
+    std::string error;
+    bool opened = reader.open(view, static_cast<size_t>(file_size.QuadPart), error);
+    if (!opened) {
+        std::cout << "Cannot read " << path << ": " << error << std::endl;
+    }
+    else {
+        captureUtil::Frame frame;
+        while (reader.next(frame)) {
+            passiveUtil::dissectFrame(frame, Discovered);
+            frame_count++;
+            byte_count += frame.length;
+        }
+        if (reader.truncated()) {
+            std::cout << "Capture ends in a truncated record, stopped after " << frame_count << " frames" << std::endl;
+        }
+    }
+
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return opened;
+}
+
+// SIO_RCVALL puts a raw IP socket into promiscuous receive: every IPv4 packet through the interface,
+// without its Ethernet header, so ARP, LLDP and CDP never show up and hosts have no MAC from here
+bool PassiveListener::captureLive(uint32_t local_address, int seconds, uint64_t& frame_count, uint64_t& byte_count) {
+    const int MAX_IP_PACKET = 65535;
+    const int POLL_INTERVAL_MS = 100;
+
+    SOCKET raw_socket = socket(AF_INET, SOCK_RAW, IPPROTO_IP);
+    if (raw_socket == INVALID_SOCKET) {
+        std::cout << "Failed to create raw socket, live capture needs administrator rights" << std::endl;
+        return false;
+    }
+    sockaddr_in interface_address = {};
+    interface_address.sin_family = AF_INET;
+    interface_address.sin_addr.s_addr = htonl(local_address);
+    DWORD receive_all = RCVALL_ON;
+    DWORD bytes_returned = 0;
+    if (bind(raw_socket, reinterpret_cast<sockaddr*>(&interface_address), sizeof(interface_address)) == SOCKET_ERROR
+        || WSAIoctl(raw_socket, SIO_RCVALL, &receive_all, sizeof(receive_all), nullptr, 0, &bytes_returned, nullptr, nullptr) == SOCKET_ERROR) {
+        std::cout << "Cannot capture on " << netUtil::bits_to_address(local_address) << " (error " << WSAGetLastError() << ")" << std::endl;
+        closesocket(raw_socket);
+        return false;
+    }
+    u_long non_blocking_mode = 1;
+    ioctlsocket(raw_socket, FIONBIO, &non_blocking_mode);
+
+    std::vector<uint8_t> packet(MAX_IP_PACKET);     // one buffer, reused for every packet
+    WSAPOLLFD poll_descriptor;
+    poll_descriptor.fd = raw_socket;
+    poll_descriptor.events = POLLRDNORM;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        poll_descriptor.revents = 0;
+        if (WSAPoll(&poll_descriptor, 1, POLL_INTERVAL_MS) <= 0) continue;
+        while (true) {      // drain everything queued before polling again
+            const int received = recv(raw_socket, reinterpret_cast<char*>(packet.data()), MAX_IP_PACKET, 0);
+            if (received <= 0) break;
+            passiveUtil::dissectFrame({packet.data(), static_cast<uint32_t>(received), captureUtil::LINKTYPE_IPV4}, Discovered);
+            frame_count++;
+            byte_count += received;
+        }
+    }
+
+    receive_all = RCVALL_OFF;
+    WSAIoctl(raw_socket, SIO_RCVALL, &receive_all, sizeof(receive_all), nullptr, 0, &bytes_returned, nullptr, nullptr);
+    closesocket(raw_socket);
+    return true;
+}
+
+void PassiveListener::report() const {
+    for (const passiveUtil::HostRecord& host : Discovered.hosts()) {
+        std::cout << "  " << std::left << std::setw(16) << (host.ip ? netUtil::bits_to_address(host.ip) : "-")
+                  << std::setw(19) << (host.mac ? netUtil::mac_to_string(host.mac) : "-")
+                  << std::setw(12) << passiveUtil::sourceNames(host.sources)
+                  << host.name << (host.detail.empty() ? "" : "  (" + host.detail + ")") << std::endl;
+    }
+    for (const passiveUtil::NeighborLink& link : Discovered.links()) {
+        std::cout << "  neighbor " << (link.system_name.empty() ? netUtil::mac_to_string(link.mac) : link.system_name)
+                  << " port " << (link.port_id.empty() ? "?" : link.port_id)
+                  << " via " << passiveUtil::sourceNames(link.source) << std::endl;
+    }
+    std::cout << std::right;
+}
@@ -2,25 +2,31 @@
 #include <iostream>
 #include <algorithm>
 #include <bitset>
-#include <sstream>
-#include <thread>
-#include <mutex>
 #include <chrono>
-#include <atomic>
+#include <map>
+#include <sstream>
 #include <winsock2.h>
 #include <iphlpapi.h>
 #include <icmpapi.h>
 #include <netUtil.hpp>
+#include "congestionUtil.hpp"
+#include "IcmpEngine.hpp"
+#include "OuiDatabase.hpp"
 
 #pragma comment(lib, "iphlpapi.lib")
 #pragma comment(lib, "ws2_32.lib")
 
-PingScanner::PingScanner(){}
+PingScanner::PingScanner() : m_ipv6(false), m_ipv6_network{0, 0}, m_ipv6_prefix(0) {}
 
 
 bool PingScanner::validateInput(const std::vector<std::string>& arguments){
 
     m_cidr_parts.clear();
+    m_ipv6 = false;
+    if (arguments.size() == 1 && netUtil::isIPv6Target(arguments[0])) {
+        m_ipv6 = netUtil::parseCIDR6(arguments[0], m_ipv6_network, m_ipv6_prefix);
+        return m_ipv6;
+    }
     switch(arguments.size()){
         case 0:
             return false;
@@ -47,6 +53,16 @@ bool PingScanner::validateInput(const std::vector<std::string>& arguments){
 
 void PingScanner::handleCommand(const std::vector<std::string>& arguments) {
 
+    if (m_ipv6) {
+        if (m_ipv6_prefix < netUtil::IPV6_BITS) {
+            discover6(m_ipv6_network, m_ipv6_prefix);
+            return;
+        }
+        std::cout << "Pinging host: " << netUtil::binaryToIPv6(m_ipv6_network) << std::endl;
+        std::cout << (pingHost6(m_ipv6_network) ? "Responded!" : "No response.") << std::endl;
+        return;
+    }
+
     uint32_t ip; //binary address built of extracted octets
     if (!netUtil::octets_to_bits(m_cidr_parts, ip)) { std::cout << "Invalid Address" << std::endl; return;}
 
@@ -58,12 +74,15 @@ void PingScanner::handleCommand(const std::vector<std::string>& arguments) {
         std::cout << "Pinging host: " << host_address << std::endl;
         HANDLE icmp_handle = IcmpCreateFile();
         if (icmp_handle == INVALID_HANDLE_VALUE) { std::cout << "Failed to create ICMP handle" << std::endl; return;}
-        if(pingHost(host_address, icmp_handle)){
+        int timeouts = 0;
+        bool rate_limited = false;
+        if(pingHost(ip, icmp_handle, timeouts, rate_limited)){
             std::cout << "Responded!" << std::endl;
         }
         else{
             std::cout << "No response." << std::endl;
         }
+        IcmpCloseHandle(icmp_handle);
     }
     else{
         scan(ip, mask);
@@ -81,89 +100,469 @@ void PingScanner::scan(uint32_t ip, uint32_t mask){
     std::cout << "Broadcast:    " << std::bitset<32>(broadcast_address)  << std::endl;
     Network_Address = netUtil::bits_to_address(network_address);
     Broadcast_Address = netUtil::bits_to_address(broadcast_address);
-    Host_Addresses.clear();  // Clear previous scan results
-    for (uint32_t bit_address = network_address + 1; bit_address < broadcast_address; bit_address++){
-        std::string string_address = netUtil::bits_to_address(bit_address);
-        Host_Addresses.push_back(string_address);
+    const size_t host_count = (broadcast_address > network_address) ? broadcast_address - network_address - 1 : 0;
+
+    std::cout << "Unique addresses: " << host_count << std::endl;
+
+    const uint32_t first_host = network_address + 1;
+    Host_Statuses.clear(); //reset previous results, one record per address up front
+    Host_Statuses.reserve(host_count);
+    for (size_t index = 0; index < host_count; index++) {
+        Host_Statuses.push_back({first_host + static_cast<uint32_t>(index), false, 0});
     }
 
-    std::cout << "Unique addresses: " << Host_Addresses.size() << std::endl;
+    //hosts that drop echo still have to answer ARP, so a subnet we are attached to is swept that way
+    neighborUtil::OnLinkInterface on_link;
+    if (host_count > 0 && neighborUtil::findOnLinkInterface(network_address, mask, on_link)) {
+        std::cout << "Scanning " << Network_Address << " via ARP from " << netUtil::bits_to_address(on_link.address) << "..." << std::endl;
+        if (arpSweep(first_host, host_count, on_link)) return;
+        std::cout << "ARP sweep failed, falling back to ping" << std::endl;
+    }
     std::cout << "Scanning " << Network_Address << " via Ping..." << std::endl;
 
-    Host_Statuses.clear(); //reset status keys
-
-    std::atomic<int> index_of_next_address_to_ping = 0; //atomic, so that threads dont try to access same index
-    std::vector<std::thread> threads;
-    std::mutex output_mutex; //dont try to all talk at once
-
-    //workstealing thread pool to ping all the IPs
-    const auto MAX_THREADS = 100;               //max concurrent pinging threads
-    const auto MS_BETWEEN_THREAD_SPAWNS = 10;   //small delay between thread spawns to protect old PLCs
-    for (int i = 0; i < MAX_THREADS; i++) {     //spawn all of our threads!
-        //uses emplace_back to avoid attempting thread copy operation
-        threads.emplace_back([&]() -> void {  //used lambda because this is an over-engineered solution
-            HANDLE icmp_handle = IcmpCreateFile();  // create ICMP handle once for each thread
-            //ICMP is stateful connection, handle=special file that stores connection state
-            if (icmp_handle == INVALID_HANDLE_VALUE) {std::cout << "Failed to create ICMP handle" << std::endl;return;}
-            while (true) {  //keep scanning addresses until we have gotten them all and main program closes them all.
-                int my_index = index_of_next_address_to_ping.fetch_add(1); //ATOMIC fetch and increment (implicit mutex usage with minimized critical code section)
-                if (my_index >= Host_Addresses.size()) break;   //no more work
-                std::string address = Host_Addresses[my_index];
-                bool pingable = pingHost(address, icmp_handle);
-                {   //CRITICAL SECTION that can block other threads from accessing this while we write status
-                    std::lock_guard<std::mutex> lock(output_mutex);
-                    if (pingable) {
-                        std::cout << address << std::endl;
-                    }
-                    Host_Statuses[address] = pingable;
-                }
+    //one thread keeps every echo in flight through IcmpSendEcho2, the AIMD window decides how many
+    const int PING_TIMEOUT_MS = 2000;
+    const int MAX_PING_ATTEMPTS = 2;
+    const DWORD COLLECT_WAIT_MS = 50;
+    const double INITIAL_WINDOW = 10;           //slow start from here protects old PLCs from a ping storm
+    const double MIN_WINDOW = 1;
+    const double MAX_WINDOW = 1024;
+    const size_t CAPACITY = static_cast<size_t>(MAX_WINDOW);
+    m_scan_arena.reset();
+    IcmpEchoEngine engine(m_scan_arena, CAPACITY);
+    if (!engine.open()) { std::cout << "Failed to create ICMP handle" << std::endl; return; }
+    congestionUtil::AimdWindow window(INITIAL_WINDOW, MIN_WINDOW, MAX_WINDOW);
+
+    uint8_t* attempts = m_scan_arena.allocateArray<uint8_t>(host_count);
+    uint32_t* retry_hosts = m_scan_arena.allocateArray<uint32_t>(CAPACITY);    //failed once, sent again ahead of fresh hosts
+    size_t retry_count = 0;                                                     //never more than the echoes in flight
+    std::vector<EchoCompletion> completions;
+    completions.reserve(CAPACITY);
+    size_t next_host = 0;
+    size_t alive_count = 0;
+
+    const size_t allocations_before = memoryUtil::heapAllocations();
+    while (next_host < host_count || retry_count > 0 || engine.inFlight() > 0) {
+        while (engine.inFlight() < window.size()) {     //top the window up in one batch
+            uint32_t host;
+            if (retry_count > 0) { host = retry_hosts[--retry_count]; }
+            else if (next_host < host_count) { host = first_host + static_cast<uint32_t>(next_host++); }
+            else break;
+            engine.start(host, PING_TIMEOUT_MS);
+        }
+
+        completions.clear();
+        engine.collect(COLLECT_WAIT_MS, completions);
+        for (const EchoCompletion& completion : completions) {
+            const size_t index = completion.host - first_host;
+            const bool pingable = completion.status == IP_SUCCESS;
+            if (completion.status == IP_REQ_TIMED_OUT) window.record(congestionUtil::Signal::Timeout);
+            else if (completion.status == IP_SOURCE_QUENCH || completion.status == IP_NO_RESOURCES) window.record(congestionUtil::Signal::RateLimit);
+            else window.record(congestionUtil::Signal::Response);
+
+            if (!pingable && ++attempts[index] < MAX_PING_ATTEMPTS) {
+                retry_hosts[retry_count++] = completion.host;
+                continue;
+            }
+            if (pingable) {
+                std::cout << netUtil::bits_to_address(completion.host) << std::endl;
+                Host_Statuses[index].alive = true;
+                alive_count++;
             }
-            IcmpCloseHandle(icmp_handle);
-            //END OF LAMBDA
-        });
-        // Delay how quickly we spin up threads to avoid faulting old PLC processors with ping storm
-        std::this_thread::sleep_for(std::chrono::milliseconds(MS_BETWEEN_THREAD_SPAWNS));
+        }
+    }
+    if (memoryUtil::COUNTING_ALLOCATIONS) {
+        std::cout << "Heap allocations in the echo loop: " << memoryUtil::heapAllocations() - allocations_before << std::endl;
     }
 
-    for (auto& thread : threads) {    // Wait for all threads to terminate
-        thread.join();
+    std::cout << "Scan complete. Found " << alive_count << " alive hosts out of " << host_count << " scanned"
+              << " (window peaked at " << window.peak() << ")." << std::endl;
+
+
+}
+
+// The kernel sends the who-has frames: one empty UDP datagram per host makes it resolve every address at
+// once, and the replies land in the neighbor cache, which is polled until the wait runs out or every host
+// has answered. Hosts already confirmed in the cache are not probed again. Stale entries are flushed first,
+// since a datagram to one goes out on the cached MAC and its probe only follows seconds later. Only
+// confirmed entries count as alive; one cached before the sweep that never answered is listed apart.
+bool PingScanner::arpSweep(uint32_t first_host, size_t host_count, const neighborUtil::OnLinkInterface& on_link) {
+    const int ARP_WAIT_MS = 1500;           //replies come back in milliseconds, this also covers the kernel's retry of a miss after 1s
+    const int TABLE_POLL_MS = 50;
+    const u_short DISCARD_PORT = 9;         //anything that does get the datagram drops it
+    const uint8_t CACHED = 1, CONFIRMED = 2;     //0 is never seen, the arena hands out zeroed arrays
+
+    SOCKET prime_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (prime_socket == INVALID_SOCKET) return false;
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(on_link.address);
+    u_long non_blocking_mode = 1;
+    if (bind(prime_socket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == SOCKET_ERROR
+        || ioctlsocket(prime_socket, FIONBIO, &non_blocking_mode) == SOCKET_ERROR) {
+        closesocket(prime_socket);
+        return false;
     }
 
-    int alive_count = 0;
-    for (const auto& [address, is_alive] : Host_Statuses) {
-        if (is_alive) alive_count++;
+    m_scan_arena.reset();
+    uint8_t* seen = m_scan_arena.allocateArray<uint8_t>(host_count);
+    uint64_t* macs = m_scan_arena.allocateArray<uint64_t>(host_count);
+    const uint32_t last_host = first_host + static_cast<uint32_t>(host_count - 1);
+    const bool local_in_range = on_link.address >= first_host && on_link.address <= last_host;
+    const size_t expected = host_count - (local_in_range ? 1 : 0);     //our own address is never in the cache
+    size_t confirmed_count = 0;
+    std::vector<neighborUtil::Neighbor> neighbors;
+    neighbors.reserve(host_count);
+    auto readCache = [&]() {
+        neighbors.clear();
+        if (!neighborUtil::readNeighbors(on_link.index, first_host, last_host, neighbors)) return false;
+        for (const neighborUtil::Neighbor& neighbor : neighbors) {
+            const size_t index = neighbor.address - first_host;
+            const uint8_t state = neighbor.confirmed ? CONFIRMED : CACHED;
+            if (state <= seen[index]) continue;
+            if (state == CONFIRMED) confirmed_count++;
+            seen[index] = state;
+            macs[index] = neighbor.mac;
+        }
+        return true;
+    };
+
+    const auto start_time = std::chrono::steady_clock::now();
+    if (!readCache()) { closesocket(prime_socket); return false; }
+    size_t unflushed_count = 0;
+    for (size_t index = 0; index < host_count; index++) {     //the MAC stays in macs for the no-reply list
+        if (seen[index] != CACHED) continue;
+        if (!neighborUtil::flushNeighbor(on_link.index, first_host + static_cast<uint32_t>(index))) unflushed_count++;
+    }
+    sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(DISCARD_PORT);
+    char empty_payload = 0;
+    for (size_t index = 0; index < host_count; index++) {     //one burst, the kernel queues every who-has
+        const uint32_t host = first_host + static_cast<uint32_t>(index);
+        if (seen[index] == CONFIRMED || host == on_link.address) continue;
+        target.sin_addr.s_addr = htonl(host);
+        sendto(prime_socket, &empty_payload, 0, 0, reinterpret_cast<sockaddr*>(&target), sizeof(target));
+    }
+    while (confirmed_count < expected && std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(ARP_WAIT_MS)) {
+        Sleep(TABLE_POLL_MS);
+        readCache();
+    }
+    closesocket(prime_socket);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    auto printNeighbor = [](uint32_t address, uint64_t mac) {
+        std::cout << netUtil::bits_to_address(address) << "  " << netUtil::mac_to_string(mac);
+        const char* vendor = OuiDatabase::shared().vendor(mac);
+        if (vendor) std::cout << "  " << vendor;
+        std::cout << std::endl;
+    };
+    size_t alive_count = 0;
+    size_t stale_count = 0;
+    for (size_t index = 0; index < host_count; index++) {
+        HostStatus& status = Host_Statuses[index];
+        if (status.address == on_link.address) {
+            std::cout << netUtil::bits_to_address(status.address) << "  this host" << std::endl;
+            status.alive = true;
+            alive_count++;
+            continue;
+        }
+        if (seen[index] == CACHED) stale_count++;
+        if (seen[index] != CONFIRMED) continue;
+        status.alive = true;
+        status.mac = macs[index];
+        alive_count++;
+        printNeighbor(status.address, status.mac);
+    }
+    if (stale_count > 0) {     //in the cache from earlier traffic but silent now: powered off, moved, or dropping ARP
+        std::cout << "Stale cache entries, no reply to this sweep:" << std::endl;
+        for (size_t index = 0; index < host_count; index++) {
+            if (seen[index] != CACHED) continue;
+            std::cout << "  ";
+            printNeighbor(first_host + static_cast<uint32_t>(index), macs[index]);
+        }
     }
+    std::cout << "Scan complete. Found " << alive_count << " hosts out of " << host_count << " scanned in " << elapsed_ms << " ms";
+    if (stale_count > 0) std::cout << " (" << stale_count << " stale entries not counted)";
+    std::cout << "." << std::endl;
+    if (unflushed_count > 0) {
+        std::cout << unflushed_count << " stale entries could not be flushed (needs administrator rights), "
+                  << "hosts idle for a while may be listed as stale" << std::endl;
+    }
+    return true;
+}
 
-    std::cout << "Scan complete. Found " << alive_count << " alive hosts out of " << Host_Addresses.size() << " scanned." << std::endl;
+// A /64 cannot be swept address by address, so discovery asks the link instead. An echo request to
+// all-nodes (ff02::1) goes out from our link-local address and again from our address in the prefix, so
+// hosts answer from theirs. Each responder's interface ID under the target prefix, plus any cache entry
+// in it not confirmed lately (flushed first, as in arpSweep), is then primed with an empty datagram: the
+// kernel sends the Neighbor Solicitation and the answers land in the neighbor cache, polled as in
+// arpSweep. Hosts that echoed or confirmed count; stale entries that stay silent are listed apart. The
+// work grows with the number of responders, never with the size of the prefix.
+void PingScanner::discover6(const netUtil::IPv6Address& network, int prefix_length) {
+    const int ECHO_ROUNDS = 2;                  //multicast is unacknowledged, a repeat covers a lost frame
+    const int ECHO_ROUND_GAP_MS = 250;
+    const int ECHO_LISTEN_MS = 1000;
+    const int NEIGHBOR_WAIT_MS = 600;
+    const int TABLE_POLL_MS = 50;
+    const int MAX_DATAGRAM_SIZE = 1500;
+    const u_short DISCARD_PORT = 9;
+    const uint8_t ICMPV6_ECHO_REQUEST = 128;
+    const uint8_t ICMPV6_ECHO_REPLY = 129;
+    const size_t ICMPV6_HEADER_SIZE = 8;
+    const char ECHO_PAYLOAD[] = "ping";
+    const netUtil::IPv6Address ALL_NODES = {0xFF02000000000000, 1};
+
+    IPv6_Hosts.clear();
+    const std::string prefix_text = netUtil::binaryToIPv6(network) + "/" + std::to_string(prefix_length);
+    neighborUtil::OnLinkInterface6 on_link;
+    if (!neighborUtil::findOnLinkInterface6(network, prefix_length, on_link)) {
+        std::cout << "No local interface is on " << prefix_text << ", IPv6 discovery only reaches attached links" << std::endl;
+        return;
+    }
+    std::cout << "Discovering " << prefix_text << " via multicast echo from " << netUtil::binaryToIPv6(on_link.link_local) << "..." << std::endl;
+    const auto start_time = std::chrono::steady_clock::now();
+
+    //raw ICMPv6 sockets see the message without its IPv6 header, and the stack fills in the checksum
+    SOCKET echo_sockets[2];
+    WSAPOLLFD poll_descriptors[2] = {};
+    size_t socket_count = 0;
+    const netUtil::IPv6Address sources[2] = {on_link.link_local, on_link.address};
+    for (size_t source = 0; source < (on_link.has_address ? 2u : 1u); source++) {
+        SOCKET echo_socket = socket(AF_INET6, SOCK_RAW, IPPROTO_ICMPV6);
+        if (echo_socket == INVALID_SOCKET) continue;
+        sockaddr_in6 local = {};
+        local.sin6_family = AF_INET6;
+        local.sin6_addr = netUtil::bits_to_in6(sources[source]);
+        local.sin6_scope_id = (source == 0) ? on_link.index : 0;
+        DWORD interface_index = on_link.index;
+        u_long non_blocking_mode = 1;
+        if (bind(echo_socket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == SOCKET_ERROR
+            || setsockopt(echo_socket, IPPROTO_IPV6, IPV6_MULTICAST_IF, reinterpret_cast<const char*>(&interface_index), sizeof(interface_index)) == SOCKET_ERROR
+            || ioctlsocket(echo_socket, FIONBIO, &non_blocking_mode) == SOCKET_ERROR) {
+            closesocket(echo_socket);
+            continue;
+        }
+        echo_sockets[socket_count] = echo_socket;
+        poll_descriptors[socket_count].fd = echo_socket;
+        poll_descriptors[socket_count].events = POLLRDNORM;
+        socket_count++;
+    }
+    if (socket_count == 0) {
+        std::cout << "Failed to create ICMPv6 socket (raw sockets need administrator rights), reading the neighbor cache only" << std::endl;
+    }
 
+    const uint16_t identifier = static_cast<uint16_t>(start_time.time_since_epoch().count());
+    uint8_t echo_request[ICMPV6_HEADER_SIZE + sizeof(ECHO_PAYLOAD)] = {ICMPV6_ECHO_REQUEST, 0, 0, 0,
+                                                                       static_cast<uint8_t>(identifier >> 8), static_cast<uint8_t>(identifier)};
+    std::copy(ECHO_PAYLOAD, ECHO_PAYLOAD + sizeof(ECHO_PAYLOAD), echo_request + ICMPV6_HEADER_SIZE);
+    sockaddr_in6 all_nodes = {};
+    all_nodes.sin6_family = AF_INET6;
+    all_nodes.sin6_addr = netUtil::bits_to_in6(ALL_NODES);
+    all_nodes.sin6_scope_id = on_link.index;
+
+    std::vector<netUtil::IPv6Address> responders;
+    uint8_t receive_buffer[MAX_DATAGRAM_SIZE];
+    int rounds_sent = 0;
+    while (socket_count > 0 && std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(ECHO_LISTEN_MS)) {
+        if (rounds_sent < ECHO_ROUNDS && std::chrono::steady_clock::now() - start_time >= std::chrono::milliseconds(rounds_sent * ECHO_ROUND_GAP_MS)) {
+            echo_request[7] = static_cast<uint8_t>(++rounds_sent);     //sequence number
+            for (size_t i = 0; i < socket_count; i++) {
+                sendto(echo_sockets[i], reinterpret_cast<const char*>(echo_request), sizeof(echo_request), 0,
+                       reinterpret_cast<sockaddr*>(&all_nodes), sizeof(all_nodes));
+            }
+        }
+        for (size_t i = 0; i < socket_count; i++) poll_descriptors[i].revents = 0;
+        WSAPoll(poll_descriptors, static_cast<ULONG>(socket_count), TABLE_POLL_MS);
+        for (size_t i = 0; i < socket_count; i++) {
+            while (true) {
+                sockaddr_in6 sender = {};
+                socklen_t sender_length = sizeof(sender);
+                const int bytes_received = recvfrom(echo_sockets[i], reinterpret_cast<char*>(receive_buffer), MAX_DATAGRAM_SIZE, 0,
+                                                    reinterpret_cast<sockaddr*>(&sender), &sender_length);
+                if (bytes_received < 0) break;
+                const bool our_echo = bytes_received >= static_cast<int>(ICMPV6_HEADER_SIZE) && receive_buffer[0] == ICMPV6_ECHO_REPLY
+                                      && ((receive_buffer[4] << 8) | receive_buffer[5]) == identifier;
+                const netUtil::IPv6Address responder = netUtil::in6_to_bits(sender.sin6_addr);
+                const bool ourselves = responder == on_link.link_local || (on_link.has_address && responder == on_link.address);   //multicast loops back
+                if (our_echo && !ourselves) responders.push_back(responder);
+            }
+        }
+    }
+    for (size_t i = 0; i < socket_count; i++) closesocket(echo_sockets[i]);
+    std::sort(responders.begin(), responders.end());
+    responders.erase(std::unique(responders.begin(), responders.end()), responders.end());
+
+    //hosts that answered from their link-local address most likely use the same interface ID in the prefix
+    std::vector<netUtil::IPv6Address> candidates;
+    for (const netUtil::IPv6Address& responder : responders) {
+        const netUtil::IPv6Address candidate = netUtil::in_prefix6(responder, network, prefix_length) ? responder
+                                               : netUtil::IPv6Address{network.high, responder.low};
+        const bool ours = candidate == on_link.link_local || (on_link.has_address && candidate == on_link.address);
+        if (!ours && netUtil::in_prefix6(candidate, network, prefix_length)) candidates.push_back(candidate);
+    }
+
+    const uint8_t CACHED = 1, CONFIRMED = 2;
+    struct Found {
+        uint64_t mac;
+        uint8_t state;      //0 when only the echo reply has been seen
+        bool echoed;
+    };
+    std::map<netUtil::IPv6Address, Found> found;
+    for (const netUtil::IPv6Address& responder : responders) {
+        if (netUtil::in_prefix6(responder, network, prefix_length)) found[responder] = {0, 0, true};
+    }
+    std::vector<neighborUtil::Neighbor6> neighbors;
+    auto readCache = [&]() {
+        neighbors.clear();
+        if (!neighborUtil::readNeighbors6(on_link.index, network, prefix_length, neighbors)) return;
+        for (const neighborUtil::Neighbor6& neighbor : neighbors) {
+            Found& host = found[neighbor.address];
+            const uint8_t state = neighbor.confirmed ? CONFIRMED : CACHED;
+            if (state <= host.state) continue;
+            host.state = state;
+            host.mac = neighbor.mac;
+        }
+    };
+    readCache();
+    size_t unflushed_count = 0;
+    for (const auto& [address, host] : found) {     //stale entries get the same chance to reconfirm
+        if (host.state != CACHED) continue;
+        if (!neighborUtil::flushNeighbor6(on_link.index, address)) unflushed_count++;
+        candidates.push_back(address);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    //the kernel solicits each candidate before it can send the datagram, anything that gets it drops it
+    const size_t candidate_count = candidates.size();
+    SOCKET prime_socket = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    if (prime_socket != INVALID_SOCKET) {
+        u_long non_blocking_mode = 1;
+        ioctlsocket(prime_socket, FIONBIO, &non_blocking_mode);
+        char empty_payload = 0;
+        for (const netUtil::IPv6Address& candidate : candidates) {
+            sockaddr_storage target;
+            const int target_length = netUtil::toSocketAddress(candidate, DISCARD_PORT, target,
+                                                               netUtil::isLinkLocal6(candidate) ? on_link.index : 0);
+            sendto(prime_socket, &empty_payload, 0, 0, reinterpret_cast<sockaddr*>(&target), target_length);
+        }
+        const auto solicit_time = std::chrono::steady_clock::now();
+        auto allConfirmed = [&]() {
+            return std::all_of(candidates.begin(), candidates.end(), [&](const netUtil::IPv6Address& candidate) {
+                auto host = found.find(candidate);
+                return host != found.end() && host->second.state == CONFIRMED;
+            });
+        };
+        while (!allConfirmed() && std::chrono::steady_clock::now() - solicit_time < std::chrono::milliseconds(NEIGHBOR_WAIT_MS)) {
+            Sleep(TABLE_POLL_MS);
+            readCache();
+        }
+        closesocket(prime_socket);
+    }
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
 
+    if (on_link.has_address && netUtil::in_prefix6(on_link.address, network, prefix_length)) {
+        std::cout << netUtil::binaryToIPv6(on_link.address) << "  this host" << std::endl;
+        IPv6_Hosts.push_back({on_link.address, 0, on_link.index});
+    }
+    auto printNeighbor = [](const netUtil::IPv6Address& address, uint64_t mac) {
+        std::cout << netUtil::binaryToIPv6(address);
+        if (mac != 0) {
+            std::cout << "  " << netUtil::mac_to_string(mac);
+            const char* vendor = OuiDatabase::shared().vendor(mac);
+            if (vendor) std::cout << "  " << vendor;
+        }
+        std::cout << std::endl;
+    };
+    auto isStale = [&](const Found& host) { return !host.echoed && host.state != CONFIRMED; };
+    size_t stale_count = 0;
+    for (const auto& [address, host] : found) {
+        if (on_link.has_address && address == on_link.address) continue;
+        if (isStale(host)) {
+            stale_count++;
+            continue;
+        }
+        IPv6_Hosts.push_back({address, host.mac, on_link.index});
+        printNeighbor(address, host.mac);
+    }
+    if (stale_count > 0) {     //in the cache from earlier traffic but silent now
+        std::cout << "Stale cache entries, no reply to this discovery:" << std::endl;
+        for (const auto& [address, host] : found) {
+            if (!isStale(host)) continue;
+            std::cout << "  ";
+            printNeighbor(address, host.mac);
+        }
+    }
+    std::sort(IPv6_Hosts.begin(), IPv6_Hosts.end(), [](const Host6Status& a, const Host6Status& b) { return a.address < b.address; });
+    std::cout << "Discovery complete. Found " << IPv6_Hosts.size() << " hosts on " << prefix_text << " in " << elapsed_ms << " ms ("
+              << responders.size() << " addresses answered the multicast echo, " << candidate_count << " solicited";
+    if (stale_count > 0) std::cout << ", " << stale_count << " stale entries not counted";
+    std::cout << ")." << std::endl;
+    if (unflushed_count > 0) {
+        std::cout << unflushed_count << " stale entries could not be flushed (needs administrator rights), "
+                  << "hosts idle for a while may be listed as stale" << std::endl;
+    }
 }
 
-bool PingScanner::pingHost(const std::string& address, HANDLE icmp_handle)
-{
+std::vector<netUtil::IPv6Host> PingScanner::ipv6Hosts() const {
+    std::vector<netUtil::IPv6Host> hosts;
+    hosts.reserve(IPv6_Hosts.size());
+    for (const Host6Status& status : IPv6_Hosts) {
+        hosts.push_back({status.address, netUtil::isLinkLocal6(status.address) ? status.interface_index : 0});
+    }
+    return hosts;
+}
+
+bool PingScanner::pingHost6(const netUtil::IPv6Address& host) {
     const int PING_TIMEOUT_MS = 2000;
     const int MAX_PING_ATTEMPTS = 2;
-    auto ping_attempts = 0;
-
-    while (ping_attempts < MAX_PING_ATTEMPTS){
-        ping_attempts++;
-
-        // Convert string IP to network address
-        unsigned long dest_addr = inet_addr(address.c_str());
-        if (dest_addr == INADDR_NONE) {
+    const char send_data[] = "ping";
+    //reply, echoed payload, room for an ICMP error and the IO_STATUS_BLOCK Icmp6SendEcho2 keeps at the end
+    alignas(ICMPV6_ECHO_REPLY) char reply_buffer[sizeof(ICMPV6_ECHO_REPLY) + sizeof(send_data) + 8 + sizeof(IO_STATUS_BLOCK)];
+
+    sockaddr_in6 source = {};       //unspecified, the stack picks the source address
+    source.sin6_family = AF_INET6;
+    sockaddr_in6 destination = {};
+    destination.sin6_family = AF_INET6;
+    destination.sin6_addr = netUtil::bits_to_in6(host);
+    if (netUtil::isLinkLocal6(host)) {     //needs a zone, taken from the interface discover6 would use
+        neighborUtil::OnLinkInterface6 on_link;
+        if (!neighborUtil::findOnLinkInterface6(host, netUtil::IPV6_BITS, on_link)) {
+            std::cout << "No local interface has a link-local address, cannot reach " << netUtil::binaryToIPv6(host) << std::endl;
             return false;
         }
+        source.sin6_addr = netUtil::bits_to_in6(on_link.link_local);
+        source.sin6_scope_id = on_link.index;
+        destination.sin6_scope_id = on_link.index;
+    }
 
-        // prepare memory for windows to send ping and receive response
-        const char send_data[] = "ping";
-        const DWORD reply_size = sizeof(ICMP_ECHO_REPLY) + sizeof(send_data);
-        LPVOID reply_buffer = (VOID*) malloc(reply_size);
-        if (reply_buffer == nullptr) {
-            return false;
-        }
+    HANDLE icmp_handle = Icmp6CreateFile();
+    if (icmp_handle == INVALID_HANDLE_VALUE) { std::cout << "Failed to create ICMPv6 handle" << std::endl; return false; }
 
-        // std::cout << "pinging " << address << ", attempt " << ping_attempts << "\r" << std::flush;
+    bool responded = false;
+    for (int ping_attempts = 0; ping_attempts < MAX_PING_ATTEMPTS && !responded; ping_attempts++) {
+        const DWORD reply_count = Icmp6SendEcho2(icmp_handle, nullptr, nullptr, nullptr, &source, &destination,
+                                                 (LPVOID)send_data, sizeof(send_data), nullptr,
+                                                 reply_buffer, sizeof(reply_buffer), PING_TIMEOUT_MS);    //blocks, no event or APC given
+        responded = reply_count > 0 && reinterpret_cast<PICMPV6_ECHO_REPLY>(reply_buffer)->Status == IP_SUCCESS;
+    }
+    IcmpCloseHandle(icmp_handle);
+    return responded;
+}
+
+// timeouts counts attempts that got nothing back; rate_limited is set when Windows reports source
+// quench or ran out of resources to send, both of which mean the scan should slow down
+bool PingScanner::pingHost(uint32_t host, HANDLE icmp_handle, int& timeouts, bool& rate_limited)
+{
+    const int PING_TIMEOUT_MS = 2000;
+    const int MAX_PING_ATTEMPTS = 2;
+    const char send_data[] = "ping";
+    // reply, echoed payload and room for an ICMP error, reused by every attempt
+    alignas(ICMP_ECHO_REPLY) char reply_buffer[sizeof(ICMP_ECHO_REPLY) + sizeof(send_data) + 8];
+    const IPAddr dest_addr = htonl(host);
 
+    for (int ping_attempts = 0; ping_attempts < MAX_PING_ATTEMPTS; ping_attempts++) {
         // send ICMP echo request
         DWORD reply_count = IcmpSendEcho( //THIS IS A BLOCKING FUNCTION!
             icmp_handle,
@@ -172,22 +571,23 @@ bool PingScanner::pingHost(const std::string& address, HANDLE icmp_handle)
             sizeof(send_data),
             nullptr,
             reply_buffer,
-            reply_size,
+            sizeof(reply_buffer),
             PING_TIMEOUT_MS //blocks for at most this long
         );
 
-        bool host_alive = false;
         if (reply_count > 0) { //check struct returned for success enum
             PICMP_ECHO_REPLY echo_reply = (PICMP_ECHO_REPLY)reply_buffer;
             if (echo_reply->Status == IP_SUCCESS) {
-
-                host_alive = true;
+                return true; //we got a ping, break out of loop
+            }
+            if (echo_reply->Status == IP_SOURCE_QUENCH) {
+                rate_limited = true;
             }
         }
-        free(reply_buffer); //we manually allocated, clean it up!
-
-        if (host_alive) {
-            return true; //we got a ping, break out of loop
+        else {
+            const DWORD error = GetLastError();
+            if (error == IP_REQ_TIMED_OUT) timeouts++;
+            else if (error == IP_NO_RESOURCES) rate_limited = true;
         }
     }
     return false;
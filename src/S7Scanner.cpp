@@ -0,0 +1,288 @@
+#include "S7Scanner.hpp"
+#include <iostream>
+#include "netUtil.hpp"
+#include "TCPScanner.hpp"
+
+S7Scanner::S7Scanner() : m_first_host(0), m_last_host(0), m_concurrency(DEFAULT_CONCURRENCY), m_timeout_ms(DEFAULT_TIMEOUT_MS) {}
+
+bool S7Scanner::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 3) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+
+    const size_t MAX_OPTION_DIGITS = 5;
+    const size_t MAX_CONCURRENCY = 4096;
+    m_concurrency = DEFAULT_CONCURRENCY;
+    if (arguments.size() > 1) {
+        if (!netUtil::isNumeric(arguments[1]) || arguments[1].length() > MAX_OPTION_DIGITS
+            || std::stoul(arguments[1]) == 0 || std::stoul(arguments[1]) > MAX_CONCURRENCY) {
+            std::cout << "Invalid concurrency (1-" << MAX_CONCURRENCY << ")" << std::endl;
+            return false;
+        }
+        m_concurrency = std::stoul(arguments[1]);
+    }
+    m_timeout_ms = DEFAULT_TIMEOUT_MS;
+    if (arguments.size() > 2) {
+        if (!netUtil::isNumeric(arguments[2]) || arguments[2].length() > MAX_OPTION_DIGITS || std::stoi(arguments[2]) == 0) {
+            std::cout << "Invalid timeout (ms)" << std::endl;
+            return false;
+        }
+        m_timeout_ms = std::stoi(arguments[2]);
+    }
+    return true;
+}
+
+void S7Scanner::handleCommand(const std::vector<std::string>& arguments) {
+
+    std::vector<uint32_t> hosts;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        hosts.push_back(static_cast<uint32_t>(host));
+    }
+
+    std::cout << "Identifying S7 CPUs on " << hosts.size() << " hosts..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    probe(hosts);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    std::cout << "S7 identification complete. " << Devices.size() << " of " << hosts.size()
+              << " hosts identified in " << elapsed_ms << " ms." << std::endl;
+}
+
+// Many hosts progress side by side, each through its own chain of stages: COTP connect, setup
+// communication, SZL 0x0011, SZL 0x001C. A host only ever has one request outstanding.
+void S7Scanner::probe(const std::vector<uint32_t>& hosts) {
+
+    Devices.clear();
+    const auto CONNECT_TIMEOUT = std::chrono::milliseconds(500);
+    const auto REPLY_TIMEOUT = std::chrono::milliseconds(m_timeout_ms);
+    const size_t TSAP_COUNT = sizeof(s7Util::REMOTE_TSAPS) / sizeof(s7Util::REMOTE_TSAPS[0]);
+    const int POLL_INTERVAL_MS = 10;
+
+    std::vector<HostProbe> active;
+    std::vector<WSAPOLLFD> poll_descriptors;
+    size_t next_host = 0;
+
+    while (next_host < hosts.size() || !active.empty()) {
+
+        while (next_host < hosts.size() && active.size() < m_concurrency) {     // refill the window
+            HostProbe probe;
+            probe.host = hosts[next_host++];
+            probe.tsap_attempt = 0;
+            probe.identified = false;
+            if (!startProbe(probe)) continue;
+            active.push_back(std::move(probe));
+        }
+
+        poll_descriptors.resize(active.size());
+        for (size_t i = 0; i < active.size(); i++) {
+            const bool sending = active[i].send_offset < active[i].send_buffer.size();
+            poll_descriptors[i].fd = active[i].tcp_socket;
+            poll_descriptors[i].events = (active[i].stage == Stage::Connecting) ? POLLWRNORM
+                                                                                 : (POLLRDNORM | (sending ? POLLWRNORM : 0));
+            poll_descriptors[i].revents = 0;
+        }
+        WSAPoll(poll_descriptors.data(), static_cast<ULONG>(poll_descriptors.size()), POLL_INTERVAL_MS);
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = active.size(); i-- > 0;) {      // walk backwards so swap-removal never skips an entry
+            HostProbe& probe = active[i];
+            const short events = poll_descriptors[i].revents;
+            bool finished = false;
+            if (probe.stage == Stage::Connecting) {
+                if (events & (POLLERR | POLLHUP)) {
+                    finished = true;
+                }
+                else if (events & POLLWRNORM) {     // before the timeout: a handshake that finished in this pass counts
+                    finished = !TCPScanner::connectSucceeded(probe.tcp_socket);
+                    if (!finished) {
+                        sendRequest(probe, Stage::CotpConnect, s7Util::buildConnectRequest(s7Util::REMOTE_TSAPS[probe.tsap_attempt]));
+                        finished = !sendPending(probe);
+                    }
+                }
+                else {
+                    finished = now - probe.last_activity >= CONNECT_TIMEOUT;
+                }
+            }
+            else if (!sendPending(probe) || ((events & (POLLRDNORM | POLLHUP | POLLERR)) && !receiveReplies(probe))) {
+                finished = true;    // closed, refused, or every stage done
+            }
+            else if (now - probe.last_activity >= REPLY_TIMEOUT) {
+                finished = true;
+            }
+            if (!finished) continue;
+
+            closesocket(probe.tcp_socket);
+            if (probe.stage == Stage::CotpConnect && probe.tsap_attempt + 1 < TSAP_COUNT) {     // TSAP refused, try the next
+                probe.tsap_attempt++;
+                if (startProbe(probe)) continue;
+            }
+            if (probe.identified) {
+                Devices[netUtil::bits_to_address(probe.host)] = probe.identity;
+            }
+            if (i != active.size() - 1) active[i] = std::move(active.back());
+            active.pop_back();
+        }
+    }
+}
+
+bool S7Scanner::startProbe(HostProbe& probe) {
+    probe.tcp_socket = TCPScanner::startConnect(probe.host, s7Util::S7_PORT);
+    probe.stage = Stage::Connecting;
+    probe.last_activity = std::chrono::steady_clock::now();
+    probe.send_buffer.clear();
+    probe.send_offset = 0;
+    probe.receive_buffer.clear();
+    return probe.tcp_socket != INVALID_SOCKET;
+}
+
+void S7Scanner::sendRequest(HostProbe& probe, Stage stage, const std::string& request) {
+    probe.stage = stage;
+    probe.send_buffer = request;
+    probe.send_offset = 0;
+    probe.last_activity = std::chrono::steady_clock::now();
+}
+
+// Write as much of the current request as the socket takes, false if the connection failed
+bool S7Scanner::sendPending(HostProbe& probe) {
+    while (probe.send_offset < probe.send_buffer.size()) {
+        const int sent = send(probe.tcp_socket, probe.send_buffer.data() + probe.send_offset,
+                              static_cast<int>(probe.send_buffer.size() - probe.send_offset), 0);
+        if (sent == SOCKET_ERROR) {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+        probe.send_offset += sent;
+    }
+    return true;
+}
+
+// Drain the socket and advance through the stages, false when the probe is over
+bool S7Scanner::receiveReplies(HostProbe& probe) {
+    const int RECEIVE_CHUNK = 1024;
+    char chunk[RECEIVE_CHUNK];
+    bool open = true;
+    while (true) {
+        const int received = recv(probe.tcp_socket, chunk, RECEIVE_CHUNK, 0);
+        if (received > 0) {
+            probe.receive_buffer.append(chunk, received);
+            continue;
+        }
+        open = (received == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK);
+        break;
+    }
+
+    std::string frame;
+    while (s7Util::popTPKT(probe.receive_buffer, frame)) {
+        if (!handleFrame(probe, frame)) return false;
+    }
+    return open && sendPending(probe);
+}
+
+bool S7Scanner::handleFrame(HostProbe& probe, const std::string& frame) {
+    const uint16_t SETUP_REFERENCE = 1;
+    const uint16_t MODULE_ID_REFERENCE = 2;
+    const uint16_t COMPONENT_ID_REFERENCE = 3;
+    std::vector<s7Util::SZLRecord> records;
+
+    switch (probe.stage) {
+        case Stage::CotpConnect:
+            if (!s7Util::isConnectConfirm(frame)) return false;
+            probe.identity.remote_tsap = s7Util::REMOTE_TSAPS[probe.tsap_attempt];
+            sendRequest(probe, Stage::SetupCommunication, s7Util::buildSetupCommunication(SETUP_REFERENCE));
+            return true;
+        case Stage::SetupCommunication:
+            if (!s7Util::isSetupAcknowledged(frame)) return false;   // ISO-on-TCP but not S7, e.g. IEC 61850 MMS
+            sendRequest(probe, Stage::ReadModuleId,
+                        s7Util::buildReadSZL(MODULE_ID_REFERENCE, s7Util::SZL_MODULE_IDENTIFICATION, 0));
+            return true;
+        case Stage::ReadModuleId:
+            if (s7Util::parseSZLResponse(frame, s7Util::SZL_MODULE_IDENTIFICATION, records)) {
+                storeModuleIdentification(probe.identity, records);
+                probe.identified = true;
+            }
+            sendRequest(probe, Stage::ReadComponentId,
+                        s7Util::buildReadSZL(COMPONENT_ID_REFERENCE, s7Util::SZL_COMPONENT_IDENTIFICATION, 0));
+            return true;
+        case Stage::ReadComponentId:
+            if (s7Util::parseSZLResponse(frame, s7Util::SZL_COMPONENT_IDENTIFICATION, records)) {
+                storeComponentIdentification(probe.identity, records);
+                probe.identified = true;
+            }
+            return false;   // nothing more to ask
+        default:
+            return false;
+    }
+}
+
+// SZL 0x0011 records: order number (20 chars), module type, then two version words
+void S7Scanner::storeModuleIdentification(S7Identity& identity, const std::vector<s7Util::SZLRecord>& records) {
+    const uint16_t INDEX_MODULE = 0x0001;
+    const uint16_t INDEX_BASIC_HARDWARE = 0x0006;
+    const uint16_t INDEX_BASIC_FIRMWARE = 0x0007;
+    const size_t ORDER_NUMBER_LENGTH = 20;
+    const size_t VERSION_OFFSET = 23;   // low byte of Ausbg, then both bytes of Ausbe: major.minor.patch
+
+    for (const s7Util::SZLRecord& record : records) {
+        if (record.data.size() < ORDER_NUMBER_LENGTH) continue;
+        const std::string text = s7Util::trimText(record.data.substr(0, ORDER_NUMBER_LENGTH));
+        if (record.index == INDEX_MODULE) {
+            identity.order_number = text;
+            identity.family = familyFromOrderNumber(text);
+        }
+        else if (record.index == INDEX_BASIC_HARDWARE) {
+            identity.hardware = text;
+        }
+        else if (record.index == INDEX_BASIC_FIRMWARE && record.data.size() >= VERSION_OFFSET + 3) {
+            identity.firmware = "V" + std::to_string(static_cast<uint8_t>(record.data[VERSION_OFFSET])) + "."
+                              + std::to_string(static_cast<uint8_t>(record.data[VERSION_OFFSET + 1])) + "."
+                              + std::to_string(static_cast<uint8_t>(record.data[VERSION_OFFSET + 2]));
+        }
+    }
+}
+
+// SZL 0x001C records: one 32-byte text field each, space or NUL padded (serial number is 24 chars + 8 reserved)
+void S7Scanner::storeComponentIdentification(S7Identity& identity, const std::vector<s7Util::SZLRecord>& records) {
+    const size_t TEXT_LENGTH = 32;
+    for (const s7Util::SZLRecord& record : records) {
+        const std::string text = s7Util::trimText(record.data.substr(0, TEXT_LENGTH));
+        switch (record.index) {
+            case 0x0001: identity.system_name = text;   break;
+            case 0x0002: identity.module_name = text;   break;
+            case 0x0005: identity.serial_number = text; break;
+            case 0x0007: identity.module_type = text;   break;
+            default: break;
+        }
+    }
+}
+
+// 6ES7 3xx = S7-300, 4xx = S7-400, 2xx = S7-1200, 5xx = S7-1500 / ET 200SP CPU
+std::string S7Scanner::familyFromOrderNumber(const std::string& order_number) {
+    std::string compact;
+    for (char c : order_number) {
+        if (c != ' ') compact += c;
+    }
+    const std::string SIEMENS_PREFIX = "6ES7";
+    if (compact.rfind(SIEMENS_PREFIX, 0) != 0 || compact.size() <= SIEMENS_PREFIX.size()) return "S7";
+    switch (compact[SIEMENS_PREFIX.size()]) {
+        case '2': return "S7-1200";
+        case '3': return "S7-300";
+        case '4': return "S7-400";
+        case '5': return "S7-1500";
+        default:  return "S7";
+    }
+}
+
+void S7Scanner::report() {
+    for (const auto& [address, identity] : Devices) {
+        std::cout << address << "  " << identity.family << "  " << identity.order_number
+                  << "  firmware " << (identity.firmware.empty() ? "?" : identity.firmware) << std::endl;
+        if (!identity.module_type.empty() || !identity.system_name.empty()) {
+            std::cout << "  " << identity.module_type << "  name \"" << identity.system_name << "\""
+                      << "  serial " << identity.serial_number << std::endl;
+        }
+    }
+}
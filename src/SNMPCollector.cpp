@@ -0,0 +1,254 @@
+#include "SNMPCollector.hpp"
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "netUtil.hpp"
+#include "OuiDatabase.hpp"
+
+// Tables walked on every device. All walks for one device run side by side, so a switch answers
+// five pipelined GETBULK streams instead of five walks back to back.
+const std::vector<SNMPCollector::WalkTable> SNMPCollector::WALK_TABLES = {
+    {Table::InterfaceNames, snmpUtil::parseOID("1.3.6.1.2.1.2.2.1.2")},            // IF-MIB ifDescr
+    {Table::BridgePortInterfaces, snmpUtil::parseOID("1.3.6.1.2.1.17.1.4.1.2")},   // BRIDGE-MIB dot1dBasePortIfIndex
+    {Table::ForwardingPorts, snmpUtil::parseOID("1.3.6.1.2.1.17.4.3.1.2")},        // BRIDGE-MIB dot1dTpFdbPort
+    {Table::NeighborPortIds, snmpUtil::parseOID("1.0.8802.1.1.2.1.4.1.1.7")},      // LLDP-MIB lldpRemPortId
+    {Table::NeighborNames, snmpUtil::parseOID("1.0.8802.1.1.2.1.4.1.1.9")}         // LLDP-MIB lldpRemSysName
+};
+
+SNMPCollector::SNMPCollector() : m_first_host(0), m_last_host(0) {}
+
+bool SNMPCollector::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 2) {
+        return false;
+    }
+    if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+    if (static_cast<uint64_t>(m_last_host) - m_first_host + 1 > MAX_HOSTS) {
+        std::cout << "Target too wide, SNMP walks at most " << MAX_HOSTS << " hosts at a time" << std::endl;
+        return false;
+    }
+    m_community = (arguments.size() == 2) ? arguments[1] : "public";
+    return true;
+}
+
+void SNMPCollector::handleCommand(const std::vector<std::string>& arguments) {
+
+    std::vector<uint32_t> hosts;
+    for (uint64_t host = m_first_host; host <= m_last_host; host++) {
+        hosts.push_back(static_cast<uint32_t>(host));
+    }
+
+    std::cout << "Walking " << hosts.size() << " hosts over SNMPv2c..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    collect(hosts);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    report();
+    std::cout << "SNMP walk complete. " << Device_Tables.size() << " of " << hosts.size()
+              << " hosts answered in " << elapsed_ms << " ms." << std::endl;
+}
+
+// Walk every table on every host over one UDP socket, keeping up to MAX_IN_FLIGHT requests outstanding
+void SNMPCollector::collect(const std::vector<uint32_t>& hosts) {
+
+    Device_Tables.clear();
+    SOCKET udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket == INVALID_SOCKET) {
+        std::cout << "Failed to create UDP socket" << std::endl;
+        return;
+    }
+    u_long non_blocking_mode = 1;
+    ioctlsocket(udp_socket, FIONBIO, &non_blocking_mode);
+    BOOL report_port_unreachable = FALSE;   // otherwise one closed host makes recvfrom fail with WSAECONNRESET
+    DWORD bytes_returned = 0;
+    WSAIoctl(udp_socket, SIO_UDP_CONNRESET, &report_port_unreachable, sizeof(report_port_unreachable),
+             nullptr, 0, &bytes_returned, nullptr, nullptr);
+
+    const size_t MAX_IN_FLIGHT = 256;       // requests outstanding across all devices
+    const int MAX_REPETITIONS = 25;         // rows per GETBULK, keeps replies well under the MTU for most tables
+    const int MAX_RETRIES = 2;
+    const auto REQUEST_TIMEOUT = std::chrono::milliseconds(1500);
+    const int POLL_INTERVAL_MS = 10;
+    const int MAX_DATAGRAM_SIZE = 65535;
+
+    std::vector<Walk> walks;
+    std::deque<size_t> ready_walks;     // walks waiting for their next request to go out
+    for (size_t device = 0; device < hosts.size(); device++) {
+        for (size_t table = 0; table < WALK_TABLES.size(); table++) {
+            walks.push_back({device, table, WALK_TABLES[table].base_oid, 0, 0, {}});
+            ready_walks.push_back(walks.size() - 1);
+        }
+    }
+
+    std::unordered_map<int32_t, size_t> walk_by_request;   // request-id -> walk, doubles as the in-flight set
+    std::unordered_map<size_t, DeviceTables> tables_by_device;
+    int32_t next_request_id = 1;
+    size_t active_walks = walks.size();
+    std::string receive_buffer(MAX_DATAGRAM_SIZE, '\0');
+    std::string packet;
+    snmpUtil::Response response;
+
+    while (active_walks > 0) {
+
+        while (!ready_walks.empty() && walk_by_request.size() < MAX_IN_FLIGHT) {    // fill the window
+            size_t walk_index = ready_walks.front();
+            ready_walks.pop_front();
+            Walk& walk = walks[walk_index];
+
+            sockaddr_in target_address = {};
+            target_address.sin_family = AF_INET;
+            target_address.sin_port = htons(snmpUtil::SNMP_PORT);
+            target_address.sin_addr.s_addr = htonl(hosts[walk.device]);
+
+            const int32_t request_id = next_request_id++;
+            const std::string request = snmpUtil::buildGetBulk(m_community, request_id, MAX_REPETITIONS, {walk.next_oid});
+            sendto(udp_socket, request.data(), static_cast<int>(request.size()), 0,
+                   reinterpret_cast<sockaddr*>(&target_address), sizeof(target_address));
+            walk.sent_at = std::chrono::steady_clock::now();
+            walk_by_request[request_id] = walk_index;
+        }
+
+        WSAPOLLFD poll_descriptor = {};
+        poll_descriptor.fd = udp_socket;
+        poll_descriptor.events = POLLRDNORM;
+        WSAPoll(&poll_descriptor, 1, POLL_INTERVAL_MS);
+
+        while (true) {  // drain every datagram that has arrived
+            sockaddr_in sender_address = {};
+            socklen_t sender_length = sizeof(sender_address);
+            int bytes_received = recvfrom(udp_socket, &receive_buffer[0], MAX_DATAGRAM_SIZE, 0,
+                                          reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+            if (bytes_received <= 0) break;
+
+            packet.assign(receive_buffer.data(), bytes_received);
+            if (!snmpUtil::parseResponse(packet, response)) continue;
+            auto request_lookup = walk_by_request.find(response.request_id);
+            if (request_lookup == walk_by_request.end()) continue;  // late reply to a request we already retried
+            Walk& walk = walks[request_lookup->second];
+            if (ntohl(sender_address.sin_addr.s_addr) != hosts[walk.device]) continue;
+            const size_t walk_index = request_lookup->second;
+            walk_by_request.erase(request_lookup);
+
+            const WalkTable& walk_table = WALK_TABLES[walk.table];
+            bool walk_finished = (response.error_status != 0) || response.varbinds.empty();
+            for (const snmpUtil::VarBind& varbind : response.varbinds) {
+                if (varbind.type == snmpUtil::TAG_END_OF_MIB_VIEW || !snmpUtil::isUnder(varbind.oid, walk_table.base_oid)) {
+                    walk_finished = true;   // walked off the end of this table
+                    break;
+                }
+                if (!(walk.next_oid < varbind.oid) || ++walk.rows > MAX_ROWS_PER_WALK) {
+                    // a buggy agent repeating or going back on an OID would keep the walk alive forever
+                    std::cout << netUtil::bits_to_address(hosts[walk.device]) << " returned OIDs out of order or without end, "
+                              << snmpUtil::oidToString(walk_table.base_oid) << " walk stopped" << std::endl;
+                    walk_finished = true;
+                    break;
+                }
+                storeVarBind(tables_by_device[walk.device], walk_table.table, walk_table.base_oid, varbind);
+                walk.next_oid = varbind.oid;
+            }
+
+            walk.retries = 0;
+            if (walk_finished) {
+                active_walks--;
+            }
+            else {
+                ready_walks.push_back(walk_index);
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto request = walk_by_request.begin(); request != walk_by_request.end();) {   // expire lost requests
+            Walk& walk = walks[request->second];
+            if (now - walk.sent_at < REQUEST_TIMEOUT) {
+                ++request;
+                continue;
+            }
+            if (++walk.retries > MAX_RETRIES) {
+                active_walks--;
+            }
+            else {
+                ready_walks.push_back(request->second);
+            }
+            request = walk_by_request.erase(request);
+        }
+    }
+
+    closesocket(udp_socket);
+
+    for (auto& [device, tables] : tables_by_device) {
+        resolveMacTable(tables);
+        Device_Tables[netUtil::bits_to_address(hosts[device])] = std::move(tables);
+    }
+}
+
+void SNMPCollector::storeVarBind(DeviceTables& tables, Table table, const snmpUtil::OID& base_oid, const snmpUtil::VarBind& varbind) {
+
+    const snmpUtil::OID index(varbind.oid.begin() + base_oid.size(), varbind.oid.end());   // row index after the column OID
+    switch (table) {
+        case Table::InterfaceNames:
+            tables.interfaces[index[0]] = varbind.value;
+            break;
+        case Table::BridgePortInterfaces:
+            tables.bridge_port_interfaces[index[0]] = static_cast<uint32_t>(snmpUtil::decodeInteger(varbind.value));
+            break;
+        case Table::ForwardingPorts: {
+            const size_t MAC_INDEX_LENGTH = 6;  // dot1dTpFdbAddress, one sub-identifier per octet
+            if (index.size() != MAC_INDEX_LENGTH) break;
+            uint64_t mac = 0;
+            for (uint32_t octet : index) {
+                mac = (mac << 8) | (octet & 0xFF);
+            }
+            tables.fdb_bridge_ports[mac] = static_cast<uint32_t>(snmpUtil::decodeInteger(varbind.value));
+            break;
+        }
+        case Table::NeighborPortIds:
+        case Table::NeighborNames: {
+            const size_t LLDP_INDEX_LENGTH = 3;  // timeMark.localPortNum.remIndex
+            if (index.size() != LLDP_INDEX_LENGTH) break;
+            NeighborEntry& neighbor = tables.neighbors[snmpUtil::oidToString(index)];
+            neighbor.local_port = index[1];
+            (table == Table::NeighborNames ? neighbor.system_name : neighbor.port_id) = varbind.value;
+            break;
+        }
+    }
+}
+
+// Translate bridge port numbers into interface names now that all three tables are in
+void SNMPCollector::resolveMacTable(DeviceTables& tables) {
+    tables.mac_table.clear();
+    for (const auto& [mac, bridge_port] : tables.fdb_bridge_ports) {
+        deviceProfile::MacTableEntry entry;
+        entry.mac = mac;
+        entry.port = std::to_string(bridge_port);
+        auto interface_index = tables.bridge_port_interfaces.find(bridge_port);
+        if (interface_index != tables.bridge_port_interfaces.end()) {
+            auto interface_name = tables.interfaces.find(interface_index->second);
+            if (interface_name != tables.interfaces.end()) {
+                entry.port = interface_name->second;
+            }
+        }
+        entry.vendor = OuiDatabase::shared().vendor(mac);
+        tables.mac_table.push_back(entry);
+    }
+}
+
+void SNMPCollector::report() {
+    for (const auto& [address, tables] : Device_Tables) {
+        std::cout << address << ": " << tables.interfaces.size() << " interfaces, "
+                  << tables.mac_table.size() << " MAC entries, "
+                  << tables.neighbors.size() << " LLDP neighbors" << std::endl;
+        for (const auto& [index, neighbor] : tables.neighbors) {
+            std::cout << "  neighbor " << neighbor.system_name << " on local port " << neighbor.local_port
+                      << " (remote " << neighbor.port_id << ")" << std::endl;
+        }
+        for (const deviceProfile::MacTableEntry& entry : tables.mac_table) {
+            std::cout << "  " << netUtil::mac_to_string(entry.mac) << "  " << entry.port;
+            if (entry.vendor) std::cout << "  " << entry.vendor;
+            std::cout << std::endl;
+        }
+    }
+}
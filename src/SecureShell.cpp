@@ -9,18 +9,17 @@
 #include <thread>
 #include <chrono>
 #include <netUtil.hpp>
+#include "OuiDatabase.hpp"
 
 
-const std::vector<std::string> SecureShell::DISCOVERY_COMMANDS = {
-    "terminal length 0",                       // Return full output of all subsequent commands without dialogue
-    "show interface status",                   // Basic interface configurations
-    "show cdp neighbors",                      // Connected Cisco devices
-    "show mac address-table"                   // Gets L2 address traffic
-};
-
 const std::vector<char> SecureShell::PROMPT_ENDINGS = {'>', '#', '$', '%'};
 
-SecureShell::SecureShell() : m_session(nullptr), m_socket(-1), m_connected(false) {
+// Token that tells us where the previous command's output ended. Each vendor profile decides how to
+// get it onto the wire (a comment line the CLI echoes, or an echo command on a real shell)
+const std::string SecureShell::PIPELINE_MARKER = "NETBARD-MARK-";
+const std::string SecureShell::PIPELINE_ARGUMENT = "pipeline";
+
+SecureShell::SecureShell() : m_session(nullptr), m_socket(-1), m_connected(false), m_pipelined(false) {
     libssh2_init(0);    // Initialize libssh2
 }
 
@@ -31,8 +30,14 @@ SecureShell::~SecureShell() {
 
 
 bool SecureShell::validateInput(const std::vector<std::string>& arguments){
-    if (arguments.size() < 3) {
-        std::cout << "Usage: ssh <hostname> <username> <password>" << std::endl;
+    if (arguments.size() < 3 || arguments.size() > 4) {
+        std::cout << "Usage: ssh <hostname> <username> <password> [pipeline]" << std::endl;
+        return false;
+    }
+
+    m_pipelined = (arguments.size() == 4);
+    if (m_pipelined && arguments[3] != PIPELINE_ARGUMENT) {
+        std::cout << "Unknown option: " << arguments[3] << std::endl;
         return false;
     }
 
@@ -147,14 +152,19 @@ void SecureShell::interactShell() {
 
     //FIRST we send all default commands
     libssh2_channel_set_blocking(channel, 0);    // Set non-blocking mode for reading
-    char buffer[4096];  //we will use this buffer a lot in the loop below
+    char buffer[SHELL_BUFFER_SIZE];  //we will use this buffer a lot in the loop below
     std::string output;
     std::string cmd;
-    std::cout << waitShellPrompt(channel, buffer);    // Wait for initial prompt
-    for (const auto& command : DISCOVERY_COMMANDS) {    // Execute each command
-        cmd = command + "\n";
-        libssh2_channel_write(channel, cmd.c_str(), cmd.length());
-        std::cout << waitShellPrompt(channel, buffer);  //await for return value
+    const std::string first_prompt = waitShellPrompt(channel, buffer);    // Wait for initial prompt
+    std::cout << first_prompt;
+    const char* ssh_banner = libssh2_session_banner_get(m_session);
+    switch (deviceProfile::detectVendor(ssh_banner ? ssh_banner : "", first_prompt)) {  // one dispatch per session
+        case deviceProfile::Vendor::Juniper:    runDiscovery<deviceProfile::Juniper>(channel, buffer);      break;
+        case deviceProfile::Vendor::ArubaHP:    runDiscovery<deviceProfile::ArubaHP>(channel, buffer);      break;
+        case deviceProfile::Vendor::Moxa:       runDiscovery<deviceProfile::Moxa>(channel, buffer);         break;
+        case deviceProfile::Vendor::Hirschmann: runDiscovery<deviceProfile::Hirschmann>(channel, buffer);   break;
+        case deviceProfile::Vendor::Linux:      runDiscovery<deviceProfile::Linux>(channel, buffer);        break;
+        case deviceProfile::Vendor::CiscoIOS:   runDiscovery<deviceProfile::CiscoIOS>(channel, buffer);     break;
     }
     //SECOND handle interactive commands
     InputHandler& inputHandler = InputHandler::getInstance();
@@ -171,6 +181,47 @@ void SecureShell::interactShell() {
     libssh2_channel_free(channel);
 }
 
+template<typename Profile>
+void SecureShell::runDiscovery(LIBSSH2_CHANNEL* channel, char* buffer){
+
+    std::cout << "\nDetected " << Profile::NAME << std::endl;
+    std::vector<std::string> commands;
+    for (const deviceProfile::DiscoveryCommand& discovery_command : Profile::DISCOVERY_COMMANDS) {
+        commands.push_back(discovery_command.command);
+    }
+
+    std::vector<std::string> outputs;
+    bool pipelined = m_pipelined;
+    if constexpr (Profile::MARKER_PREFIX == nullptr) {
+        if (pipelined) std::cout << Profile::NAME << " has no harmless marker line, running one command per prompt" << std::endl;
+        pipelined = false;
+    }
+    else if (pipelined) {    // one write for the whole batch, one read pass for all of the output
+        outputs = pipelineCommands(channel, buffer, commands, Profile::MARKER_PREFIX, Profile::MARKER_SPLIT);
+    }
+    if (!pipelined) {
+        std::string cmd;
+        for (const auto& command : commands) {    // Execute each command
+            cmd = command + "\n";
+            libssh2_channel_write(channel, cmd.c_str(), cmd.length());
+            outputs.push_back(waitShellPrompt(channel, buffer));  //await for return value
+        }
+    }
+
+    Mac_Table.clear();
+    for (size_t index = 0; index < outputs.size(); index++) {
+        std::cout << outputs[index];
+        deviceProfile::parseOutput<Profile>(Profile::DISCOVERY_COMMANDS[index].kind, outputs[index], Mac_Table);
+    }
+    OuiDatabase& vendors = OuiDatabase::shared();
+    size_t known_vendors = 0;
+    for (deviceProfile::MacTableEntry& entry : Mac_Table) {
+        entry.vendor = vendors.vendor(entry.mac);
+        if (entry.vendor) known_vendors++;
+    }
+    std::cout << "\nCollected " << Mac_Table.size() << " MAC table entries, " << known_vendors << " from known vendors" << std::endl;
+}
+
 std::string SecureShell::waitShellPrompt(LIBSSH2_CHANNEL* channel, char* buffer){
 
     std::string output;
@@ -180,7 +231,7 @@ std::string SecureShell::waitShellPrompt(LIBSSH2_CHANNEL* channel, char* buffer)
     const int CHECK_INTERVAL_MS = 50;
 
     while (emptyReads < MAX_EMPTY_READS) {    // Read until we haven't received data for a short period
-        bytesRead = libssh2_channel_read(channel, buffer, sizeof(buffer)-1);
+        bytesRead = libssh2_channel_read(channel, buffer, SHELL_BUFFER_SIZE - 1);
 
         if (bytesRead == LIBSSH2_ERROR_EAGAIN) {    // No data available yet
             emptyReads++;
@@ -196,23 +247,125 @@ std::string SecureShell::waitShellPrompt(LIBSSH2_CHANNEL* channel, char* buffer)
         output += buffer;
         emptyReads = 0;  // Reset counter when we get data
 
-        if (output.length() <= 2) continue; // Check if we've received a prompt
+        if (endsWithPrompt(output)) {
+            return output;  // Found prompt, command complete
+        }
+    }
+
+    return output;
+}
 
-        size_t lastNewline = output.find_last_of('\n');
-        if (lastNewline == std::string::npos) continue;
+bool SecureShell::endsWithPrompt(const std::string& output){
+    if (output.length() <= 2) return false; // Check if we've received a prompt
 
-        std::string lastLine = output.substr(lastNewline + 1);
-        if (lastLine.empty()) continue;
+    size_t lastNewline = output.find_last_of('\n');
+    if (lastNewline == std::string::npos) return false;
 
-        char lastChar = lastLine.back();
-        for (char promptChar : PROMPT_ENDINGS) { // Check if last character matches any prompt ending
-            if (lastChar == promptChar) {
-                return output;  // Found prompt, command complete
-            }
+    std::string lastLine = output.substr(lastNewline + 1);
+    lastLine.erase(lastLine.find_last_not_of(' ') + 1);    // JunOS and most shells leave a space after the prompt
+    if (lastLine.empty()) return false;
+
+    char lastChar = lastLine.back();
+    for (char promptChar : PROMPT_ENDINGS) { // Check if last character matches any prompt ending
+        if (lastChar == promptChar) {
+            return true;
         }
     }
+    return false;
+}
 
-    return output;
+std::string SecureShell::pipelineMarker(size_t index){
+    return PIPELINE_MARKER + std::to_string(index) + ".";  // terminator keeps MARK-1 from matching MARK-10
+}
+
+std::vector<std::string> SecureShell::pipelineCommands(LIBSSH2_CHANNEL* channel, char* buffer, const std::vector<std::string>& commands,
+                                                   const std::string& marker_prefix, const std::string& marker_split){
+
+    if (commands.empty()) return {};
+
+    std::string batch;    // every command followed by its numbered marker line
+    for (size_t index = 0; index < commands.size(); index++) {
+        batch += commands[index] + "\n";
+        batch += marker_prefix + PIPELINE_MARKER + marker_split + std::to_string(index) + ".\n";
+    }
+
+    const int MAX_EMPTY_READS = 25;
+    const int CHECK_INTERVAL_MS = 50;
+    int emptyReads = 0;
+
+    size_t bytesWritten = 0;
+    while (bytesWritten < batch.length() && emptyReads < MAX_EMPTY_READS) {    // non-blocking channel may take the batch in pieces
+        long written = libssh2_channel_write(channel, batch.c_str() + bytesWritten, batch.length() - bytesWritten);
+        if (written == LIBSSH2_ERROR_EAGAIN) {
+            emptyReads++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(CHECK_INTERVAL_MS));
+            continue;
+        }
+        if (written < 0) break;
+        bytesWritten += written;
+    }
+
+    // Read until the last marker has been echoed and the shell is sitting at a prompt again
+    const std::string final_marker = pipelineMarker(commands.size() - 1);
+    std::string output;
+    long bytesRead;
+    emptyReads = 0;
+    while (emptyReads < MAX_EMPTY_READS) {
+        bytesRead = libssh2_channel_read(channel, buffer, SHELL_BUFFER_SIZE - 1);
+
+        if (bytesRead == LIBSSH2_ERROR_EAGAIN) {    // No data available yet
+            emptyReads++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(CHECK_INTERVAL_MS));
+            continue;
+        }
+
+        if (bytesRead <= 0) {   // Error or channel closed
+            break;
+        }
+
+        buffer[bytesRead] = '\0';
+        output += buffer;
+        emptyReads = 0;
+
+        size_t final_marker_pos = output.rfind(final_marker);
+        if (final_marker_pos == std::string::npos) continue;
+        if (output.find('\n', final_marker_pos) == std::string::npos) continue;   // marker line not finished yet
+        if (endsWithPrompt(output)) break;
+    }
+
+    return splitPipelineOutput(output, commands.size());
+}
+
+std::vector<std::string> SecureShell::splitPipelineOutput(const std::string& output, size_t command_count){
+
+    std::vector<std::string> segments;
+    size_t segment_start = 0;
+    for (size_t index = 0; index < command_count; index++) {
+        size_t marker_pos = output.find(pipelineMarker(index), segment_start);
+        if (marker_pos == std::string::npos) {  // device stopped answering early, keep whatever did arrive
+            segments.push_back(output.substr(segment_start));
+            segment_start = output.length();
+            continue;
+        }
+
+        // segment ends where the prompt line that echoed the marker begins
+        size_t marker_line_start = output.find_last_of('\n', marker_pos);
+        if (marker_line_start == std::string::npos || marker_line_start < segment_start) {
+            marker_line_start = segment_start;
+        }
+        else {
+            marker_line_start++;
+        }
+        segments.push_back(output.substr(segment_start, marker_line_start - segment_start));
+
+        size_t marker_line_end = output.find('\n', marker_pos);
+        segment_start = (marker_line_end == std::string::npos) ? output.length() : marker_line_end + 1;
+    }
+
+    if (!segments.empty() && segment_start < output.length()) {    // trailing prompt belongs to the last command
+        segments.back() += output.substr(segment_start);
+    }
+    return segments;
 }
 
 void SecureShell::disconnect() {
@@ -1,104 +1,85 @@
 
 #include "TCPScanner.hpp"
 #include "netUtil.hpp"
+#include "bannerUtil.hpp"
+#include "congestionUtil.hpp"
+#include "ConnectEngine.hpp"
+#include "neighborUtil.hpp"
+#include "PingScanner.hpp"
 #include <iostream>
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <algorithm>
 #include <map>
-#include <thread>
 #include <chrono>
+#include <thread>
 
 using namespace std;
 
-std::map<int, std::string> TCPScanner::Ports = {
-    // Web services
-    {80, "HTTP Web Server"},
-    {443, "HTTPS Secure Web Server"},
-    {8080, "HTTP Alternate"},
-    {8443, "HTTPS Alternate"},
-
-    // Industrial protocols
-    {502, "Modbus TCP"},
-    {102, "Siemens S7 / IEC 61850"},
-    {44818, "EtherNet/IP Explicit Messaging"},
-    {2222, "EtherNet/IP I/O Data"},
-    {4840, "OPC UA"},
-    {4843, "OPC UA with TLS"},
-    {47808, "BACnet/IP"},
-    {20000, "DNP3"},
-    {1883, "MQTT"},
-    {8883, "MQTT with TLS"},
-
-    // Network management
-    {161, "SNMP"},
-    {162, "SNMP Trap"},
-    {22, "SSH Secure Shell"},
-    {23, "Telnet"},
-    {21, "FTP Control"},
-    {20, "FTP Data"},
-    {69, "TFTP"},
-
-    // Database & HMI
-    {1433, "Microsoft SQL Server"},
-    {3306, "MySQL Database"},
-    {5432, "PostgreSQL Database"},
-    {5900, "VNC Remote Desktop"},
-    {3389, "Windows RDP"},
-
-    // Other industrial
-    {9600, "OMRON FINS"},
-    {5000, "Siemens S7 (alternate)"},
-    {5001, "Siemens S7 (alternate)"},
-    {1911, "Niagara Fox Protocol"},
-    {1962, "Phoenix Contact PCWorx"},
-    {789, "Red Lion Crimson v3"},
-    {10001, "Ubiquiti Discovery"},
-    {2455, "WAGO CoDeSys"},
-    {34962, "Profinet RT"},
-    {34963, "Profinet RT"},
-    {34964, "Profinet RT"},
-    {2404, "IEC 60870-5-104"},
-
-    // Email
-    {25, "SMTP Mail"},
-    {110, "POP3 Mail"},
-    {143, "IMAP Mail"},
-    {587, "SMTP Submission"},
-    {993, "IMAP Secure"},
-    {995, "POP3 Secure"}
-};
-
-TCPScanner::TCPScanner() {}
+TCPScanner::TCPScanner() : m_grab_banners(false), m_order(portUtil::ScanOrder::PortMajor), m_per_host_cap(DEFAULT_PER_HOST_CAP) {}
 
 bool TCPScanner::validateInput(const std::vector<std::string>& arguments) {
 
-    switch(arguments.size()){
-        case 0:
+    if (arguments.empty() || arguments.size() > 5) {
+        return false;
+    }
+    m_ipv6_hosts.clear();
+    if (netUtil::isIPv6Target(arguments[0])) {
+        if (!netUtil::target6_to_hosts(arguments[0], PingScanner::getInstance().ipv6Hosts(), m_ipv6_hosts)) {
+            cout << "Invalid IPv6 Address or prefix" << endl;
             return false;
-        case 1:
-            if(!netUtil::isValidIPv4(arguments[0])){
-                cout << "Invalid IP Address" << endl;
-                return false;
-            }
-            break;
-        case 2:
-            if(!netUtil::isValidCIDR(arguments[0])){
-                cout << "Invalid CIDR" << endl;
-                return false;
-            }
-            else if (!netUtil::isValidPort(arguments[1])){
-                cout << "Invalid Port" << endl;
+        }
+        if (m_ipv6_hosts.empty()) {
+            cout << "No known hosts in " << arguments[0] << ", discover them first with: ping " << arguments[0] << endl;
+            return false;
+        }
+        if (!neighborUtil::assignZones(m_ipv6_hosts)) {
+            cout << "No local interface has a link-local address, cannot reach " << arguments[0] << endl;
+            return false;
+        }
+    }
+    else if (!netUtil::isValidIPv4(arguments[0]) && !netUtil::isValidCIDR(arguments[0])) {
+        cout << "Invalid IP Address or CIDR" << endl;
+        return false;
+    }
+
+    // Options may come in any order after the target; anything that is not an option is the port spec
+    std::string port_spec;
+    m_grab_banners = false;
+    m_order = portUtil::ScanOrder::PortMajor;
+    m_per_host_cap = DEFAULT_PER_HOST_CAP;
+    const std::string PER_HOST_PREFIX = "perhost=";
+    for (size_t i = 1; i < arguments.size(); i++) {
+        const std::string& argument = arguments[i];
+        if (argument == "banners") {
+            m_grab_banners = true;
+        }
+        else if (portUtil::parseScanOrder(argument, m_order)) {
+            continue;
+        }
+        else if (argument.compare(0, PER_HOST_PREFIX.size(), PER_HOST_PREFIX) == 0) {
+            const std::string cap = argument.substr(PER_HOST_PREFIX.size());
+            const size_t MAX_CAP_DIGITS = 3;
+            if (!netUtil::isNumeric(cap) || cap.length() > MAX_CAP_DIGITS || std::stoi(cap) == 0) {
+                cout << "Invalid perhost, use 1-999" << endl;
                 return false;
             }
-            else{
-                return true;
-            }
-            break;
-        default:
+            m_per_host_cap = std::stoul(cap);
+        }
+        else if (port_spec.empty()) {
+            port_spec = argument;
+        }
+        else {
+            cout << "Unexpected argument: " << argument << endl;
             return false;
+        }
     }
 
+    std::string error;
+    if (!portUtil::parsePortSpec(port_spec.empty() ? "known" : port_spec, m_ports, error)) {
+        cout << "Invalid ports, " << error << endl;
+        return false;
+    }
     return true;
 }
 
@@ -106,74 +87,351 @@ bool TCPScanner::validateInput(const std::vector<std::string>& arguments) {
 void TCPScanner::handleCommand(const std::vector<std::string>& arguments) {
     // Input already validated by validateInput()
     std::string address = arguments[0];
+    std::cout << "Scanning " << m_ports.count() << " ports across " << address << std::endl;
+
+    // IPv6 hosts are swept by their index in m_ipv6_hosts
+    const netUtil::IPv6Host* ipv6_hosts = m_ipv6_hosts.empty() ? nullptr : m_ipv6_hosts.data();
+    std::vector<uint32_t> hosts;
+    if (ipv6_hosts) {
+        for (size_t index = 0; index < m_ipv6_hosts.size(); index++) hosts.push_back(static_cast<uint32_t>(index));
+    }
+    else {
+        uint32_t first_host;
+        uint32_t last_host;
+        netUtil::target_to_host_range(address, first_host, last_host);
+        for (uint64_t host = first_host; host <= last_host; host++) {
+            hosts.push_back(static_cast<uint32_t>(host));
+        }
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::pair<uint32_t, int>> open_ports = sweep(hosts, m_ports, m_order, m_per_host_cap, ipv6_hosts);
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    size_t open_host_count = 0;
+    for (size_t i = 0; i < open_ports.size(); i++) {
+        const auto& [host, port] = open_ports[i];
+        if (i == 0 || open_ports[i - 1].first != host) open_host_count++;
+        const std::string host_address = ipv6_hosts ? netUtil::binaryToIPv6(ipv6_hosts[host].address) : netUtil::bits_to_address(host);
+        std::cout << "  " << host_address << " port " << port << " OPEN - " << serviceName(port) << std::endl;
+    }
+    std::cout << "Scan complete. Found " << open_ports.size() << " open ports on " << open_host_count << " of "
+              << hosts.size() << " hosts in " << elapsed_ms << " ms." << std::endl;
+
+    if (m_grab_banners && !open_ports.empty()) {
+        std::cout << "Reading banners from " << open_ports.size() << " open ports..." << std::endl;
+        grabBanners(open_ports, ipv6_hosts);
+        for (const auto& [host_address, ports] : Banners) {
+            for (const auto& [port, banner] : ports) {
+                std::cout << "  " << host_address << ":" << port << "  "
+                          << (banner.service.empty() ? "unrecognized" : banner.service)
+                          << (banner.product.empty() ? "" : " - " + banner.product)
+                          << "  | " << bannerUtil::displayLine(banner.banner) << std::endl;
+            }
+        }
+    }
+
+}
+
+std::string TCPScanner::serviceName(const int port) {
+    return portUtil::serviceName(static_cast<uint16_t>(port));
+}
+
+std::vector<uint32_t> TCPScanner::sweepPort(const std::vector<uint32_t>& hosts, const int port) {
+    portUtil::PortSet ports;
+    ports.set(port);
+    std::vector<uint32_t> open_hosts;
+    for (const auto& open_port : sweep(hosts, ports)) {
+        open_hosts.push_back(open_port.first);
+    }
+    return open_hosts;
+}
+
+// Overlapped ConnectEx on a completion port when the provider supports it, WSAPoll otherwise
+std::vector<std::pair<uint32_t, int>> TCPScanner::sweep(const std::vector<uint32_t>& hosts, const portUtil::PortSet& ports,
+                                                        portUtil::ScanOrder order, size_t per_host_cap,
+                                                        const netUtil::IPv6Host* ipv6_hosts) {
+    m_sweep_arena.reset();
+    IocpConnectEngine iocp_engine(m_sweep_arena, MAX_SWEEP_WINDOW);
+    iocp_engine.useIPv6Hosts(ipv6_hosts);
+    if (iocp_engine.open()) {
+        return runSweep(iocp_engine, hosts, ports, order, per_host_cap);
+    }
+    PollConnectEngine poll_engine(MAX_SWEEP_WINDOW);
+    poll_engine.useIPv6Hosts(ipv6_hosts);
+    return runSweep(poll_engine, hosts, ports, order, per_host_cap);
+}
+
+// Sliding window of non-blocking connects: keep up to the AIMD window's worth of connects in flight
+// and refill as each one connects, fails or times out. Accepted and refused connects widen the window,
+// an epoch of unusual timeouts or local socket exhaustion halves it. Host/port pairs come from a
+// TargetSequence in the requested order, never materialised, so 65,535 ports x a /16 costs nothing up front.
+// No host ever has more than per_host_cap connects outstanding: a pair whose host is full waits in a
+// short deferred list and the window keeps filling from other hosts, so throughput only drops when
+// every pair left belongs to hosts that are already at their cap. Host-major order walks enough hosts
+// together that their caps add up to the widest window, so the deferred list never fills with one host.
+// Per-host counts sit in the sweep arena, found by binary search over a sorted copy of the hosts, so
+// the loop makes no heap allocation per probe.
+template <typename Engine>
+std::vector<std::pair<uint32_t, int>> TCPScanner::runSweep(Engine& engine, const std::vector<uint32_t>& hosts,
+                                                           const portUtil::PortSet& ports, portUtil::ScanOrder order,
+                                                           size_t per_host_cap) {
 
-    if(netUtil::isValidCIDR(address)){
-        int port = std::stoi(arguments[1]);
-        std::cout << "Scanning for open-port:" << port << " across " << address << std::endl;
+    const double INITIAL_WINDOW = 32;
+    const double MIN_WINDOW = 1;
+    const double MAX_WINDOW = static_cast<double>(MAX_SWEEP_WINDOW);
+    const size_t MAX_DEFERRED = MAX_SWEEP_WINDOW;
+    const auto CONNECT_TIMEOUT = std::chrono::milliseconds(500);
+    const int POLL_INTERVAL_MS = 10;
+    const int MAX_IDLE_LAUNCH_FAILURES = 100;      // ~1 s of connects failing locally with nothing in flight to free resources
+
+    const std::vector<uint16_t> port_list = portUtil::toList(ports);
+    const uint64_t seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    const size_t host_stripe = (MAX_SWEEP_WINDOW + per_host_cap - 1) / per_host_cap;
+    portUtil::TargetSequence sequence(hosts.size(), port_list.size(), order, seed, host_stripe);
+    std::vector<std::pair<uint32_t, int>> open_ports;
+    std::vector<std::pair<uint32_t, int>> deferred;         // next pairs whose host was at its cap
+    deferred.reserve(MAX_DEFERRED + 1);     // + the pair whose launch failed
+    std::vector<ConnectCompletion> completions;
+    completions.reserve(MAX_SWEEP_WINDOW);
+    congestionUtil::AimdWindow window(INITIAL_WINDOW, MIN_WINDOW, MAX_WINDOW);
+    bool sequence_done = false;
+    int idle_launch_failures = 0;
+    uint64_t completed = 0;
+
+    uint32_t* sorted_hosts = m_sweep_arena.allocateArray<uint32_t>(hosts.size());
+    std::copy(hosts.begin(), hosts.end(), sorted_hosts);
+    std::sort(sorted_hosts, sorted_hosts + hosts.size());
+    size_t* host_in_flight = m_sweep_arena.allocateArray<size_t>(hosts.size());
+    auto inFlightFor = [&](uint32_t host) -> size_t& {
+        return host_in_flight[std::lower_bound(sorted_hosts, sorted_hosts + hosts.size(), host) - sorted_hosts];
+    };
+
+    auto launch = [&](uint32_t host, int port) {
+        if (!engine.start(host, port)) {     // out of sockets or buffers locally: slow down, the caller keeps the pair
+            window.record(congestionUtil::Signal::RateLimit);
+            return false;
+        }
+        inFlightFor(host)++;
+        return true;
+    };
+
+    const size_t allocations_before = memoryUtil::heapAllocations();
+    while (!sequence_done || !deferred.empty() || engine.inFlight() > 0) {
+
+        bool launch_failed = false;     // stop launching this pass, a failed pair stays deferred for the next
+        for (size_t i = 0; i < deferred.size() && engine.inFlight() < window.size();) {   // waiting pairs first
+            if (inFlightFor(deferred[i].first) >= per_host_cap) {
+                i++;
+                continue;
+            }
+            if (!launch(deferred[i].first, deferred[i].second)) {
+                launch_failed = true;
+                break;
+            }
+            deferred.erase(deferred.begin() + i);
+        }
+        while (!launch_failed && !sequence_done && engine.inFlight() < window.size() && deferred.size() < MAX_DEFERRED) {   // refill the window
+            uint64_t host_index;
+            uint64_t port_index;
+            if (!sequence.next(host_index, port_index)) {
+                sequence_done = true;
+                break;
+            }
+            const uint32_t host = hosts[host_index];
+            const int port = port_list[port_index];
+            if (inFlightFor(host) >= per_host_cap) {
+                deferred.push_back({host, port});
+                continue;
+            }
+            if (!launch(host, port)) {
+                deferred.push_back({host, port});
+                launch_failed = true;
+            }
+        }
+
+        if (!launch_failed || engine.inFlight() > 0) {
+            idle_launch_failures = 0;
+        }
+        else if (++idle_launch_failures > MAX_IDLE_LAUNCH_FAILURES) {
+            std::cout << "Connects keep failing locally, stopping with " << sequence.total() - completed
+                      << " probes unfinished" << std::endl;
+            break;
+        }
+        else {      // nothing will complete to free sockets, give the stack a moment before retrying
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+            continue;
+        }
+
+        completions.clear();
+        engine.collect(POLL_INTERVAL_MS, CONNECT_TIMEOUT, completions);
+        for (const ConnectCompletion& completion : completions) {
+            if (completion.timed_out) {
+                window.record(congestionUtil::Signal::Timeout);
+            }
+            else {
+                if (completion.error == 0) {
+                    open_ports.push_back({completion.host, completion.port});
+                }
+                window.record((completion.error == WSAENOBUFS) ? congestionUtil::Signal::RateLimit : congestionUtil::Signal::Response);
+            }
+            inFlightFor(completion.host)--;
+            completed++;
+        }
     }
-    else{
-        std::cout << "Scanning ports on " << address << std::endl;
-        std::for_each(Ports.begin(), Ports.end(), [this, &address](const auto& port){
-            synHostPort(address, port.first);
-            std::this_thread::sleep_for(std::chrono::milliseconds(25));
-        });
+    if (memoryUtil::COUNTING_ALLOCATIONS) {     // only the open_ports list should show up here, growing geometrically
+        std::cout << "Heap allocations in the connect loop: " << memoryUtil::heapAllocations() - allocations_before
+                  << " for " << sequence.total() << " probes" << std::endl;
     }
 
+    std::sort(open_ports.begin(), open_ports.end());
+    return open_ports;
 }
 
-// TCP Connect Scan - attempts full TCP connection to test if port is open
-bool TCPScanner::synHostPort(const std::string& host, const int port) {
+SOCKET TCPScanner::startConnect(uint32_t host, const int port) {
+    sockaddr_storage target_address;
+    const int target_length = netUtil::toSocketAddress(host, static_cast<uint16_t>(port), target_address);
+    return startConnect(target_address, target_length);
+}
 
-    SOCKET tcp_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+SOCKET TCPScanner::startConnect(const netUtil::IPv6Host& host, const int port) {
+    sockaddr_storage target_address;
+    const int target_length = netUtil::toSocketAddress(host, static_cast<uint16_t>(port), target_address);
+    return startConnect(target_address, target_length);
+}
+
+SOCKET TCPScanner::startConnect(const sockaddr_storage& target_address, int target_length) {
+    SOCKET tcp_socket = socket(target_address.ss_family, SOCK_STREAM, IPPROTO_TCP);
     if (tcp_socket == INVALID_SOCKET) {
-        return false;
+        return INVALID_SOCKET;
     }
 
-    // Make socket non-blocking so connect() won't freeze our program
     u_long non_blocking_mode = 1;
     ioctlsocket(tcp_socket, FIONBIO, &non_blocking_mode);
+    connect(tcp_socket, (const sockaddr*)&target_address, target_length);    // completes in the background
+    return tcp_socket;
+}
 
-    // Build the target address structure
-    sockaddr_in target_address;
-    target_address.sin_family = AF_INET;                              // IPv4 address type
-    target_address.sin_port = htons(port);                            // Convert port to network byte order
-    inet_pton(AF_INET, host.c_str(), &target_address.sin_addr);      // Convert IP string to binary
-
-    // Start connection attempt
-    // Returns immediately due to non-blocking mode
-    int connect_result = connect(tcp_socket, (sockaddr*)&target_address, sizeof(target_address));
-
-    // Prepare sets of sockets to monitor
-    fd_set sockets_that_connected;     // Will contain sockets that successfully connected
-    fd_set sockets_with_errors;        // Will contain sockets that had errors
-    FD_ZERO(&sockets_that_connected);  // Clear the set
-    FD_ZERO(&sockets_with_errors);     // Clear the set
-    FD_SET(tcp_socket, &sockets_that_connected);  // Add our socket to monitor
-    FD_SET(tcp_socket, &sockets_with_errors);     // Add our socket to monitor
-
-    // Set how long we'll wait for connection
-    timeval max_wait_time;
-    max_wait_time.tv_sec = 0;
-    max_wait_time.tv_usec = 500000;  // 500 milliseconds
-
-    // Wait for connection to succeed or fail
-    int select_result = select(0, nullptr, &sockets_that_connected, &sockets_with_errors, &max_wait_time);
-
-    bool port_is_open = false;
-    if (select_result > 0) {
-        // Check if our socket successfully connected
-        if (FD_ISSET(tcp_socket, &sockets_that_connected)) {
-            port_is_open = true;
-            auto service_lookup = Ports.find(port);
-            std::string service_name = (service_lookup != Ports.end())
-                                      ? service_lookup->second
-                                      : "Unknown Service";
-            std::cout << "  Port " << port << " OPEN - " << service_name << std::endl;
-        }
-    }
+bool TCPScanner::connectSucceeded(SOCKET tcp_socket) {
+    return connectError(tcp_socket) == 0;
+}
 
-    closesocket(tcp_socket);
-    return port_is_open;
+int TCPScanner::connectError(SOCKET tcp_socket) {
+    int socket_error = 0;
+    socklen_t error_length = sizeof(socket_error);
+    getsockopt(tcp_socket, SOL_SOCKET, SO_ERROR, (char*)&socket_error, &error_length);
+    return socket_error;
 }
 
 
+
+// Same sliding window as sweepPort, but each socket stays open after the handshake: the port's probe
+// goes out, then the reply is collected until the peer closes, the buffer fills, the reply has gone
+// quiet or the read timeout passes. Telnet negotiation is refused as it arrives so the prompt follows.
+void TCPScanner::grabBanners(const std::vector<std::pair<uint32_t, int>>& targets, const netUtil::IPv6Host* ipv6_hosts) {
+
+    const size_t MAX_CONCURRENT_BANNERS = 128;
+    const auto CONNECT_TIMEOUT = std::chrono::milliseconds(500);
+    const auto READ_TIMEOUT = std::chrono::milliseconds(2000);
+    const auto QUIET_AFTER_DATA = std::chrono::milliseconds(200);    // multi-segment replies (HTTP headers) settle in this
+    const size_t MAX_BANNER_SIZE = 2048;
+    const int POLL_INTERVAL_MS = 10;
+    const int RECEIVE_CHUNK_SIZE = 1024;
+
+    struct BannerRead {
+        SOCKET tcp_socket;
+        uint32_t host;
+        int port;
+        bool connected;
+        std::chrono::steady_clock::time_point started_at;   // connect start, then read start
+        std::chrono::steady_clock::time_point last_data;
+        std::string banner;
+        std::string telnet_carry;       // negotiation split across two recv chunks
+    };
+
+    Banners.clear();
+    std::vector<BannerRead> pending;
+    std::vector<WSAPOLLFD> poll_descriptors;
+    size_t next_target = 0;
+    char chunk[RECEIVE_CHUNK_SIZE];
+
+    while (next_target < targets.size() || !pending.empty()) {
+
+        while (next_target < targets.size() && pending.size() < MAX_CONCURRENT_BANNERS) {   // refill the window
+            const auto& [host, port] = targets[next_target++];
+            SOCKET tcp_socket = ipv6_hosts ? startConnect(ipv6_hosts[host], port) : startConnect(host, port);
+            if (tcp_socket == INVALID_SOCKET) continue;
+            const auto now = std::chrono::steady_clock::now();
+            pending.push_back({tcp_socket, host, port, false, now, now, "", ""});
+        }
+
+        poll_descriptors.resize(pending.size());
+        for (size_t i = 0; i < pending.size(); i++) {
+            poll_descriptors[i].fd = pending[i].tcp_socket;
+            poll_descriptors[i].events = pending[i].connected ? POLLRDNORM : POLLWRNORM;
+            poll_descriptors[i].revents = 0;
+        }
+        WSAPoll(poll_descriptors.data(), static_cast<ULONG>(poll_descriptors.size()), POLL_INTERVAL_MS);
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = pending.size(); i-- > 0;) {     // walk backwards so swap-removal never skips an entry
+            BannerRead& read = pending[i];
+            const short events = poll_descriptors[i].revents;
+            bool finished = false;
+
+            if (!read.connected) {
+                if (events & (POLLWRNORM | POLLERR | POLLHUP)) {     // before the timeout: a handshake that finished in this pass counts
+                    finished = !connectSucceeded(read.tcp_socket);
+                    if (!finished) {
+                        read.connected = true;
+                        read.started_at = now;
+                        const std::string probe = bannerUtil::probeFor(read.port);
+                        if (!probe.empty()) send(read.tcp_socket, probe.data(), static_cast<int>(probe.size()), 0);
+                    }
+                }
+                else {
+                    finished = now - read.started_at >= CONNECT_TIMEOUT;
+                }
+            }
+            else {
+                if (events & (POLLRDNORM | POLLHUP | POLLERR)) {
+                    while (true) {
+                        int bytes_received = recv(read.tcp_socket, chunk, RECEIVE_CHUNK_SIZE, 0);
+                        if (bytes_received <= 0) {
+                            finished = (bytes_received == 0 || WSAGetLastError() != WSAEWOULDBLOCK);    // closed by peer
+                            break;
+                        }
+                        read.last_data = now;
+                        const std::string data(chunk, bytes_received);
+                        const int TELNET_PORT = 23;
+                        if (read.port == TELNET_PORT) {
+                            std::string refusals;
+                            read.banner += bannerUtil::stripTelnet(data, read.telnet_carry, refusals);
+                            if (!refusals.empty()) send(read.tcp_socket, refusals.data(), static_cast<int>(refusals.size()), 0);
+                        }
+                        else {
+                            read.banner += data;
+                        }
+                    }
+                }
+                finished = finished || read.banner.size() >= MAX_BANNER_SIZE || now - read.started_at >= READ_TIMEOUT
+                           || (!read.banner.empty() && now - read.last_data >= QUIET_AFTER_DATA);
+            }
+            if (!finished) continue;
+
+            if (!read.banner.empty()) {
+                const std::string host_address = ipv6_hosts ? netUtil::binaryToIPv6(ipv6_hosts[read.host].address) : netUtil::bits_to_address(read.host);
+                ServiceBanner& result = Banners[host_address][read.port];
+                result.banner = read.banner.substr(0, MAX_BANNER_SIZE);
+                const int signature = bannerUtil::matcher().match(result.banner);
+                if (signature != bannerUtil::SignatureMatcher::NO_MATCH) {
+                    result.service = bannerUtil::signatures()[signature].service;
+                    result.product = bannerUtil::signatures()[signature].product;
+                }
+            }
+            closesocket(read.tcp_socket);
+            if (i != pending.size() - 1) pending[i] = std::move(pending.back());
+            pending.pop_back();
+        }
+    }
+}
@@ -0,0 +1,264 @@
+#include "UDPScanner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <ws2tcpip.h>
+#include "neighborUtil.hpp"
+#include "netUtil.hpp"
+#include "PingScanner.hpp"
+
+UDPScanner::UDPScanner() : m_first_host(0), m_last_host(0), m_retries(DEFAULT_RETRIES),
+                           m_timeout_ms(DEFAULT_TIMEOUT_MS), m_cookie_seed(0) {}
+
+bool UDPScanner::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty() || arguments.size() > 4) {
+        return false;
+    }
+    m_ipv6_hosts.clear();
+    if (netUtil::isIPv6Target(arguments[0])) {
+        if (!netUtil::target6_to_hosts(arguments[0], PingScanner::getInstance().ipv6Hosts(), m_ipv6_hosts)) {
+            std::cout << "Invalid IPv6 Address or prefix" << std::endl;
+            return false;
+        }
+        if (m_ipv6_hosts.empty()) {
+            std::cout << "No known hosts in " << arguments[0] << ", discover them first with: ping " << arguments[0] << std::endl;
+            return false;
+        }
+        if (!neighborUtil::assignZones(m_ipv6_hosts)) {
+            std::cout << "No local interface has a link-local address, cannot reach " << arguments[0] << std::endl;
+            return false;
+        }
+        m_first_host = 0;
+        m_last_host = static_cast<uint32_t>(m_ipv6_hosts.size() - 1);
+    }
+    else if (!netUtil::target_to_host_range(arguments[0], m_first_host, m_last_host)) {
+        std::cout << "Invalid IP Address or CIDR" << std::endl;
+        return false;
+    }
+
+    m_probes.clear();
+    if (arguments.size() < 2 || arguments[1] == "all") {
+        for (const udpProbes::Probe& probe : udpProbes::registry()) {
+            m_probes.push_back(&probe);
+        }
+    }
+    else {
+        std::stringstream port_list(arguments[1]);
+        std::string port;
+        while (std::getline(port_list, port, ',')) {
+            const udpProbes::Probe* probe = netUtil::isValidPort(port) ? udpProbes::findProbe(static_cast<uint16_t>(std::stoi(port))) : nullptr;
+            if (!probe) {
+                std::cout << "No UDP probe for port " << port << std::endl;
+                return false;
+            }
+            m_probes.push_back(probe);
+        }
+        if (m_probes.empty()) return false;
+    }
+
+    m_retries = DEFAULT_RETRIES;
+    if (arguments.size() >= 3) {
+        const size_t MAX_RETRY_DIGITS = 1;
+        if (!netUtil::isNumeric(arguments[2]) || arguments[2].length() > MAX_RETRY_DIGITS) {
+            std::cout << "Invalid retries, use 0-9" << std::endl;
+            return false;
+        }
+        m_retries = std::stoi(arguments[2]);
+    }
+
+    m_timeout_ms = DEFAULT_TIMEOUT_MS;
+    if (arguments.size() == 4) {
+        const size_t MAX_TIMEOUT_DIGITS = 5;
+        if (!netUtil::isNumeric(arguments[3]) || arguments[3].length() > MAX_TIMEOUT_DIGITS || std::stoi(arguments[3]) == 0) {
+            std::cout << "Invalid timeout (ms)" << std::endl;
+            return false;
+        }
+        m_timeout_ms = std::stoi(arguments[3]);
+    }
+    return true;
+}
+
+void UDPScanner::handleCommand(const std::vector<std::string>& arguments) {
+
+    const uint64_t host_count = static_cast<uint64_t>(m_last_host) - m_first_host + 1;
+    std::cout << "Probing " << m_probes.size() << " UDP services on " << host_count << " hosts..." << std::endl;
+    auto start_time = std::chrono::steady_clock::now();
+    scan();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    size_t open_count = 0;
+    for (const auto& [address, ports] : OpenPorts) {
+        open_count += ports.size();
+    }
+    std::cout << "UDP scan complete. " << open_count << " open services on " << OpenPorts.size() << " of "
+              << host_count << " hosts in " << elapsed_ms << " ms." << std::endl;
+}
+
+// One socket per probe, so a reply is attributed to its probe by the socket it lands on even when
+// the service answers from another port (TFTP). Sends go out host-major with at most MAX_IN_FLIGHT
+// unanswered; a probe whose timeout passes is resent until its retries run out. Timeouts are uniform,
+// so sends are queued in deadline order and only the front of the queue is ever checked.
+void UDPScanner::scan() {
+
+    OpenPorts.clear();
+    ClosedPorts.clear();
+    m_cookie_seed = static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    std::vector<SOCKET> sockets;
+    std::vector<WSAPOLLFD> poll_descriptors;
+    for (size_t slot = 0; slot < m_probes.size(); slot++) {
+        SOCKET udp_socket = socket(m_ipv6_hosts.empty() ? AF_INET : AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+        if (udp_socket == INVALID_SOCKET) {
+            std::cout << "Failed to create UDP socket" << std::endl;
+            for (SOCKET open_socket : sockets) closesocket(open_socket);
+            return;
+        }
+        // SIO_UDP_CONNRESET stays at its default: the WSAECONNRESET it raises is how closed ports show up
+        u_long non_blocking_mode = 1;
+        ioctlsocket(udp_socket, FIONBIO, &non_blocking_mode);
+        sockets.push_back(udp_socket);
+        WSAPOLLFD poll_descriptor = {};
+        poll_descriptor.fd = udp_socket;
+        poll_descriptor.events = POLLRDNORM;
+        poll_descriptors.push_back(poll_descriptor);
+    }
+
+    struct Transmission {
+        uint32_t host;
+        size_t slot;
+        int attempt;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    const int POLL_INTERVAL_MS = 10;
+    const uint64_t host_count = static_cast<uint64_t>(m_last_host) - m_first_host + 1;
+    const uint64_t total = host_count * m_probes.size();
+    const auto timeout = std::chrono::milliseconds(m_timeout_ms);
+    std::vector<PortState> states(total, PortState::Unsent);      // index: host offset * probes + slot
+    std::deque<Transmission> outstanding;
+    size_t in_flight = 0;
+    uint64_t next_index = 0;
+    size_t filtered_count = 0;
+
+    while (next_index < total || in_flight > 0) {
+
+        auto now = std::chrono::steady_clock::now();
+        while (!outstanding.empty() && outstanding.front().deadline <= now) {
+            Transmission transmission = outstanding.front();
+            outstanding.pop_front();
+            const uint64_t index = (static_cast<uint64_t>(transmission.host) - m_first_host) * m_probes.size() + transmission.slot;
+            if (states[index] != PortState::Pending) continue;     // answered, in_flight already released
+            if (transmission.attempt >= m_retries) {
+                states[index] = PortState::Filtered;    // a late reply must not release the slot again
+                in_flight--;
+                filtered_count++;
+                continue;
+            }
+            sendProbe(sockets[transmission.slot], transmission.host, *m_probes[transmission.slot]);
+            transmission.attempt++;
+            transmission.deadline = now + timeout;
+            outstanding.push_back(transmission);
+        }
+
+        while (next_index < total && in_flight < MAX_IN_FLIGHT) {
+            const uint32_t host = static_cast<uint32_t>(m_first_host + next_index / m_probes.size());
+            const size_t slot = static_cast<size_t>(next_index % m_probes.size());
+            sendProbe(sockets[slot], host, *m_probes[slot]);
+            states[next_index] = PortState::Pending;
+            outstanding.push_back({host, slot, 0, std::chrono::steady_clock::now() + timeout});
+            in_flight++;
+            next_index++;
+        }
+
+        WSAPoll(poll_descriptors.data(), static_cast<ULONG>(poll_descriptors.size()), POLL_INTERVAL_MS);
+        for (size_t slot = 0; slot < sockets.size(); slot++) {
+            in_flight -= drainSocket(sockets[slot], slot, states);
+        }
+    }
+
+    for (SOCKET udp_socket : sockets) {
+        closesocket(udp_socket);
+    }
+    report(filtered_count);
+}
+
+void UDPScanner::sendProbe(SOCKET udp_socket, uint32_t host, const udpProbes::Probe& probe) {
+    const std::string payload = probe.build(cookieFor(host));
+    sockaddr_storage target_address;
+    const int target_length = m_ipv6_hosts.empty() ? netUtil::toSocketAddress(host, probe.port, target_address)
+                                                   : netUtil::toSocketAddress(m_ipv6_hosts[host], probe.port, target_address);
+    netUtil::sendDatagram(udp_socket, payload, reinterpret_cast<sockaddr*>(&target_address), target_length);
+}
+
+// Read everything queued on one probe's socket, returns how many pending probes it settled. Replies
+// to probes not yet sent, already settled or given up on are dropped, so in_flight never goes negative.
+// A reply of any kind means open; the validator only decides how it is described.
+size_t UDPScanner::drainSocket(SOCKET udp_socket, size_t slot, std::vector<PortState>& states) {
+
+    const int MAX_DATAGRAM_SIZE = 1500;
+    const udpProbes::Probe& probe = *m_probes[slot];
+    std::string receive_buffer(MAX_DATAGRAM_SIZE, '\0');
+    size_t settled = 0;
+
+    while (true) {
+        sockaddr_storage sender_address = {};
+        socklen_t sender_length = sizeof(sender_address);
+        int bytes_received = recvfrom(udp_socket, &receive_buffer[0], MAX_DATAGRAM_SIZE, 0,
+                                      reinterpret_cast<sockaddr*>(&sender_address), &sender_length);
+        const bool port_unreachable = (bytes_received == SOCKET_ERROR && WSAGetLastError() == WSAECONNRESET);
+        if (bytes_received < 0 && !port_unreachable) break;
+
+        // for WSAECONNRESET, the host that refused
+        uint32_t host = ntohl(reinterpret_cast<const sockaddr_in&>(sender_address).sin_addr.s_addr);
+        if (!m_ipv6_hosts.empty()) {
+            const netUtil::IPv6Address sender = netUtil::in6_to_bits(reinterpret_cast<const sockaddr_in6&>(sender_address).sin6_addr);
+            auto match = std::lower_bound(m_ipv6_hosts.begin(), m_ipv6_hosts.end(), sender,
+                                          [](const netUtil::IPv6Host& host, const netUtil::IPv6Address& address) { return host.address < address; });
+            if (match == m_ipv6_hosts.end() || match->address != sender) continue;
+            host = static_cast<uint32_t>(match - m_ipv6_hosts.begin());
+        }
+        if (host < m_first_host || host > m_last_host) continue;
+        PortState& state = states[(static_cast<uint64_t>(host) - m_first_host) * m_probes.size() + slot];
+        if (state != PortState::Pending) continue;     // retransmit answered twice, or not a probe in flight
+
+        std::string summary;
+        udpProbes::Verdict verdict = udpProbes::Verdict::Unrecognized;
+        if (!port_unreachable) {
+            verdict = probe.validate(receive_buffer.substr(0, bytes_received), cookieFor(host), summary);
+            if (verdict == udpProbes::Verdict::Stale) continue;     // answers an earlier scan, keep waiting for ours
+        }
+        settled++;
+
+        const std::string address = hostText(host);
+        if (port_unreachable) {
+            state = PortState::Closed;
+            ClosedPorts[address].push_back(probe.port);
+            continue;
+        }
+        state = PortState::Open;
+        if (verdict == udpProbes::Verdict::Unrecognized) {
+            summary = "unrecognized reply (" + std::to_string(bytes_received) + " bytes)";
+        }
+        OpenPorts[address].push_back({probe.port, probe.name, summary});
+    }
+    return settled;
+}
+
+std::string UDPScanner::hostText(uint32_t host) const {
+    return m_ipv6_hosts.empty() ? netUtil::bits_to_address(host) : netUtil::binaryToIPv6(m_ipv6_hosts[host].address);
+}
+
+void UDPScanner::report(size_t filtered_count) {
+    for (const auto& [address, ports] : OpenPorts) {
+        for (const OpenPort& port : ports) {
+            std::cout << "  " << address << " " << port.port << "/udp OPEN - " << port.service << ": " << port.summary << std::endl;
+        }
+    }
+    size_t closed_count = 0;
+    for (const auto& [address, ports] : ClosedPorts) {
+        closed_count += ports.size();
+    }
+    std::cout << closed_count << " closed (ICMP port unreachable), " << filtered_count << " open|filtered (no reply)" << std::endl;
+}
@@ -0,0 +1,59 @@
+#include "VendorLookup.hpp"
+#include <iostream>
+#include "netUtil.hpp"
+#include "OuiDatabase.hpp"
+
+VendorLookup::VendorLookup() : m_build(false) {}
+
+bool VendorLookup::validateInput(const std::vector<std::string>& arguments) {
+    if (arguments.empty()) {
+        return false;
+    }
+
+    m_build = (arguments[0] == "build");
+    m_csv_paths.clear();
+    m_macs.clear();
+    if (m_build) {
+        if (arguments.size() < 2) {
+            std::cout << "Name at least one registry CSV, e.g. oui.csv" << std::endl;
+            return false;
+        }
+        m_csv_paths.assign(arguments.begin() + 1, arguments.end());
+        return true;
+    }
+
+    for (const std::string& argument : arguments) {
+        uint64_t mac;
+        if (!netUtil::parseMAC(argument, mac)) {
+            std::cout << "Invalid MAC address " << argument << std::endl;
+            return false;
+        }
+        m_macs.push_back(mac);
+    }
+    return true;
+}
+
+void VendorLookup::handleCommand(const std::vector<std::string>& arguments) {
+
+    OuiDatabase& vendors = OuiDatabase::shared();
+    if (m_build) {
+        size_t entry_count = 0;
+        std::string error;
+        if (!OuiDatabase::build(m_csv_paths, OuiDatabase::DEFAULT_PATH, entry_count, error)) {
+            std::cout << "Build failed: " << error << std::endl;
+            return;
+        }
+        vendors.reload();
+        std::cout << "Wrote " << entry_count << " prefixes to " << OuiDatabase::DEFAULT_PATH << std::endl;
+        return;
+    }
+
+    if (vendors.size() == 0) {
+        std::cout << "No vendor index, build one with: oui build <oui.csv> [mam.csv] [oui36.csv]" << std::endl;
+        return;
+    }
+    for (uint64_t mac : m_macs) {
+        const char* vendor = vendors.vendor(mac);
+        std::cout << netUtil::mac_to_string(mac) << "  " << (vendor ? vendor : "unknown") << std::endl;
+    }
+}